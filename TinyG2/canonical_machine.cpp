@@ -96,6 +96,7 @@
 #include "plan_arc.h"
 #include "planner.h"
 #include "stepper.h"
+#include "kinematics.h"
 #include "encoder.h"
 #include "spindle.h"
 #include "coolant.h"
@@ -215,7 +216,7 @@ void cm_set_motion_state(const cmMotionState motion_state)
 
 /*	These getters and setters will work on any gm model with inputs:
  *		MODEL 		(GCodeState_t *)&cm.gm		// absolute pointer from canonical machine gm model
- *		PLANNER		(GCodeState_t *)&bf->gm		// relative to buffer *bf is currently pointing to
+ *		PLANNER		mp_get_buffer_gm(bf)		// relative to buffer *bf is currently pointing to
  *		RUNTIME		(GCodeState_t *)&mr.gm		// absolute pointer from runtime mm struct
  *		ACTIVE_MODEL cm.am						// active model pointer is maintained by state management
  */
@@ -304,7 +305,7 @@ float cm_get_active_coord_offset(const uint8_t axis)
  *
  *	This function accepts as input:
  *		MODEL 		(GCodeState_t *)&cm.gm		// absolute pointer from canonical machine gm model
- *		PLANNER		(GCodeState_t *)&bf->gm		// relative to buffer *bf is currently pointing to
+ *		PLANNER		mp_get_buffer_gm(bf)		// relative to buffer *bf is currently pointing to
  *		RUNTIME		(GCodeState_t *)&mr.gm		// absolute pointer from runtime mm struct
  *		ACTIVE_MODEL cm.am						// active model pointer is maintained by state management
  */
@@ -319,7 +320,7 @@ float cm_get_work_offset(const GCodeState_t *gcode_state, const uint8_t axis)
  *
  *	This function accepts as input:
  *		MODEL 		(GCodeState_t *)&cm.gm		// absolute pointer from canonical machine gm model
- *		PLANNER		(GCodeState_t *)&bf->gm		// relative to buffer *bf is currently pointing to
+ *		PLANNER		mp_get_buffer_gm(bf)		// relative to buffer *bf is currently pointing to
  *		RUNTIME		(GCodeState_t *)&mr.gm		// absolute pointer from runtime mm struct
  *		ACTIVE_MODEL cm.am						// active model pointer is maintained by state management
  */
@@ -600,6 +601,10 @@ void canonical_machine_reset()
     cm.hold_state = FEEDHOLD_OFF;
     cm.esc_boot_timer = SysTickTimer_getValue();
     cm.gmx.block_delete_switch = true;
+    cm.gmx.feed_rate_override_enable = true;
+    cm.gmx.feed_rate_override_factor = 1.0;
+    cm.gmx.traverse_override_enable = true;
+    cm.gmx.traverse_override_factor = 1.0;
     cm.gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE; // never start in a motion mode
 
     cm.machine_state = MACHINE_READY;
@@ -1168,11 +1173,28 @@ stat_t cm_set_path_control(const uint8_t mode)
 	return (STAT_OK);
 }
 
+/*
+ * cm_set_path_tolerance() - G64 P (affects MODEL only)
+ *
+ *	Sets how far the path may be rounded off at a corner in G64 (see _blend_corner()).
+ *	G64 without a P word sets it to zero, which turns blending off.
+ */
+
+stat_t cm_set_path_tolerance(const float tolerance)
+{
+	if (tolerance < 0) {
+		return (STAT_INPUT_VALUE_RANGE_ERROR);
+	}
+	cm.gmx.path_tolerance = _to_millimeters(tolerance);
+	return (STAT_OK);
+}
+
 /*******************************
  * Machining Functions (4.3.6) *
  *******************************/
 /*
  * cm_arc_feed() - SEE plan_arc.c(pp)
+ * cm_spline_feed() - SEE plan_spline.c(pp)
  */
 
 /*
@@ -1279,13 +1301,21 @@ void cm_message(const char *message)
  *
  *	Override enables are kind of a mess in Gcode. This is an attempt to sort them out.
  *	See http://www.linuxcnc.org/docs/2.4/html/gcode_main.html#sec:M50:-Feed-Override
+ *
+ *	A factor or enable change takes effect right away: mp_feed_rate_override() replans the
+ *	queued moves with it and the runtime picks it up at the next section boundary. The
+ *	factors are held in gmx, and also set from the mfo and mto config values.
+ *
+ *	"Right away" is from when the line is read. {mfo:} and {mto:} sent on a control
+ *	channel are read by _dispatch_control() even while gcode waits on a full planner.
+ *	On a single channel they queue behind the gcode sent before them, like any command.
  */
-/*
 stat_t cm_override_enables(uint8_t flag)			// M48, M49
 {
 	cm.gmx.feed_rate_override_enable = flag;
 	cm.gmx.traverse_override_enable = flag;
-	spindle.override_enable = flag;
+//	spindle.override_enable = flag;
+	mp_feed_rate_override();						// replan the queue for new feed rate
 	return (STAT_OK);
 }
 
@@ -1296,14 +1326,18 @@ stat_t cm_feed_rate_override_enable(uint8_t flag)	// M50
 	} else {
 		cm.gmx.feed_rate_override_enable = true;
 	}
+	mp_feed_rate_override();						// replan the queue for new feed rate
 	return (STAT_OK);
 }
 
 stat_t cm_feed_rate_override_factor(uint8_t flag)	// M50.1
 {
+	if ((cm.gn.parameter < FEED_OVERRIDE_MIN) || (cm.gn.parameter > FEED_OVERRIDE_MAX)) {
+		return (STAT_INPUT_VALUE_RANGE_ERROR);
+	}
 	cm.gmx.feed_rate_override_enable = flag;
 	cm.gmx.feed_rate_override_factor = cm.gn.parameter;
-//	mp_feed_rate_override(flag, cm.gn.parameter);	// replan the queue for new feed rate
+	mp_feed_rate_override();						// replan the queue for new feed rate
 	return (STAT_OK);
 }
 
@@ -1314,17 +1348,20 @@ stat_t cm_traverse_override_enable(uint8_t flag)	// M50.2
 	} else {
 		cm.gmx.traverse_override_enable = true;
 	}
+	mp_feed_rate_override();						// replan the queue for new traverse rate
 	return (STAT_OK);
 }
 
-stat_t cm_traverse_override_factor(uint8_t flag)	// M51
+stat_t cm_traverse_override_factor(uint8_t flag)	// M50.3
 {
+	if ((cm.gn.parameter < TRAVERSE_OVERRIDE_MIN) || (cm.gn.parameter > TRAVERSE_OVERRIDE_MAX)) {
+		return (STAT_INPUT_VALUE_RANGE_ERROR);
+	}
 	cm.gmx.traverse_override_enable = flag;
 	cm.gmx.traverse_override_factor = cm.gn.parameter;
-//	mp_feed_rate_override(flag, cm.gn.parameter);	// replan the queue for new feed rate
+	mp_feed_rate_override();						// replan the queue for new traverse rate
 	return (STAT_OK);
 }
-*/
 
 /************************************************
  * Feedhold and Related Functions (no NIST ref) *
@@ -1743,7 +1780,21 @@ static const char msg_g01[] PROGMEM = "G1  - linear feed";
 static const char msg_g02[] PROGMEM = "G2  - clockwise arc feed";
 static const char msg_g03[] PROGMEM = "G3  - counter clockwise arc feed";
 static const char msg_g80[] PROGMEM = "G80 - cancel motion mode (none active)";
-static const char *const msg_momo[] PROGMEM = { msg_g00, msg_g01, msg_g02, msg_g03, msg_g80 };
+static const char msg_g38[] PROGMEM = "G38.2 - straight probe";
+static const char msg_g81[] PROGMEM = "G81 - drilling";
+static const char msg_g82[] PROGMEM = "G82 - drilling with dwell";
+static const char msg_g83[] PROGMEM = "G83 - peck drilling";
+static const char msg_g84[] PROGMEM = "G84 - right hand tapping";
+static const char msg_g85[] PROGMEM = "G85 - boring, no dwell, feed out";
+static const char msg_g86[] PROGMEM = "G86 - boring, spindle stop, rapid out";
+static const char msg_g87[] PROGMEM = "G87 - back boring";
+static const char msg_g88[] PROGMEM = "G88 - boring, spindle stop, manual out";
+static const char msg_g89[] PROGMEM = "G89 - boring, dwell, feed out";
+static const char msg_g05[] PROGMEM = "G5  - cubic spline feed";
+static const char msg_g5a[] PROGMEM = "G5.1 - quadratic spline feed";
+static const char *const msg_momo[] PROGMEM = { msg_g00, msg_g01, msg_g02, msg_g03, msg_g80, msg_g38,
+												msg_g81, msg_g82, msg_g83, msg_g84, msg_g85, msg_g86,
+												msg_g87, msg_g88, msg_g89, msg_g05, msg_g5a };
 
 static const char msg_g17[] PROGMEM = "G17 - XY plane";
 static const char msg_g18[] PROGMEM = "G18 - XZ plane";
@@ -1988,6 +2039,7 @@ stat_t cm_set_am(nvObj_t *nv)		// axis mode
 		if (nv->value > AXIS_MODE_MAX_ROTARY) { return (STAT_INPUT_VALUE_UNSUPPORTED);}
 	}
 	set_ui8(nv);
+	ik_set_motor_map();						// inhibited axes are compiled into the motor map
 	return(STAT_OK);
 }
 
@@ -2000,6 +2052,15 @@ stat_t cm_set_hi(nvObj_t *nv)
 	return (STAT_OK);
 }
 
+stat_t cm_set_hgrp(nvObj_t *nv)
+{
+	if ((nv->value < 0) || (nv->value >= (1<<HOMING_AXES))) {
+    	return (STAT_INPUT_VALUE_UNSUPPORTED);
+	}
+	set_ui8(nv);
+	return (STAT_OK);
+}
+
 /**** Jerk functions
  * cm_get_axis_jerk() - returns jerk for an axis
  * cm_set_axis_jerk() - sets the jerk for an axis, including recirpcal and cached values
@@ -2048,6 +2109,8 @@ stat_t cm_set_jh(nvObj_t *nv)
  *
  * cm_run_qf() - flush planner queue
  * cm_run_home() - run homing sequence
+ * cm_set_mfo() - set feed rate override factor and enable it (same as M50.1)
+ * cm_set_mto() - set traverse override factor and enable it (same as M50.3)
  */
 
 stat_t cm_run_qf(nvObj_t *nv)
@@ -2062,6 +2125,28 @@ stat_t cm_run_home(nvObj_t *nv)
 	return (STAT_OK);
 }
 
+stat_t cm_set_mfo(nvObj_t *nv)
+{
+	if ((nv->value < FEED_OVERRIDE_MIN) || (nv->value > FEED_OVERRIDE_MAX)) {
+		return (STAT_INPUT_VALUE_RANGE_ERROR);
+	}
+	set_flt(nv);
+	cm.gmx.feed_rate_override_enable = true;
+	mp_feed_rate_override();
+	return (STAT_OK);
+}
+
+stat_t cm_set_mto(nvObj_t *nv)
+{
+	if ((nv->value < TRAVERSE_OVERRIDE_MIN) || (nv->value > TRAVERSE_OVERRIDE_MAX)) {
+		return (STAT_INPUT_VALUE_RANGE_ERROR);
+	}
+	set_flt(nv);
+	cm.gmx.traverse_override_enable = true;
+	mp_feed_rate_override();
+	return (STAT_OK);
+}
+
 /*
  * Debugging Commands
  *
@@ -2157,6 +2242,8 @@ const char fmt_frmo[] PROGMEM = "Feed rate mode:      %s\n";
 const char fmt_tool[] PROGMEM = "Tool number          %d\n";
 const char fmt_ilck[] PROGMEM = "Safety Interlock:    %s\n";
 const char fmt_estp[] PROGMEM = "Emergency Stop:      %s\n";
+const char fmt_mfo[] PROGMEM = "Feed rate override:%7.3f\n";
+const char fmt_mto[] PROGMEM = "Traverse override:%8.3f\n";
 
 const char fmt_pos[] PROGMEM = "%c position:%15.3f%s\n";
 const char fmt_mpo[] PROGMEM = "%c machine posn:%11.3f%s\n";
@@ -2188,6 +2275,8 @@ void cm_print_plan(nvObj_t *nv) { text_print_str(nv, fmt_plan);}
 void cm_print_path(nvObj_t *nv) { text_print_str(nv, fmt_path);}
 void cm_print_dist(nvObj_t *nv) { text_print_str(nv, fmt_dist);}
 void cm_print_frmo(nvObj_t *nv) { text_print_str(nv, fmt_frmo);}
+void cm_print_mfo(nvObj_t *nv) { text_print(nv, fmt_mfo);}      // TYPE_FLOAT
+void cm_print_mto(nvObj_t *nv) { text_print(nv, fmt_mto);}      // TYPE_FLOAT
 
 //void cm_print_ilck(nvObj_t *nv) { text_print_str(nv, fmt_ilck);}
 //void cm_print_estp(nvObj_t *nv) { text_print_str(nv, fmt_estp);}
@@ -2201,19 +2290,27 @@ void cm_print_gdi(nvObj_t *nv) { text_print(nv, fmt_gdi);}  // TYPE_INT
 /* system state print functions */
 
 const char fmt_ja[] PROGMEM = "[ja]  junction acceleration%8.0f%s\n";
+const char fmt_jt[] PROGMEM = "[jt]  junction type%16d [0=centripetal,1=per axis]\n";
 const char fmt_ct[] PROGMEM = "[ct]  chordal tolerance%17.4f%s\n";
+const char fmt_clt[] PROGMEM ="[clt] coalescing tolerance%14.4f%s\n";
+const char fmt_cla[] PROGMEM ="[cla] coalescing angle%18.2f degrees\n";
 const char fmt_sl[] PROGMEM = "[sl]  soft limit enable%12d [0=disable,1=enable]\n";
 const char fmt_lim[] PROGMEM ="[lim] limit switch enable%10d [0=disable,1=enable]\n";
 const char fmt_saf[] PROGMEM ="[saf] safety interlock enable%6d [0=disable,1=enable]\n";
+const char fmt_hgrp[] PROGMEM="[hgrp] homing group%16d [axes homed together: 1=X,2=Y,4=Z,8=A - add them]\n";
 const char fmt_ml[] PROGMEM = "[ml]  min line segment%17.3f%s\n";
 const char fmt_ma[] PROGMEM = "[ma]  min arc segment%18.3f%s\n";
 const char fmt_ms[] PROGMEM = "[ms]  min segment time%13.0f uSec\n";
 
 void cm_print_ja(nvObj_t *nv) { text_print_flt_units(nv, fmt_ja, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_jt(nvObj_t *nv) { text_print(nv, fmt_jt);}    // TYPE_INT
 void cm_print_ct(nvObj_t *nv) { text_print_flt_units(nv, fmt_ct, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_clt(nvObj_t *nv){ text_print_flt_units(nv, fmt_clt, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_cla(nvObj_t *nv){ text_print(nv, fmt_cla);}
 void cm_print_sl(nvObj_t *nv) { text_print(nv, fmt_sl);}    // TYPE_INT
 void cm_print_lim(nvObj_t *nv){ text_print(nv, fmt_lim);}   // TYPE_INT
 void cm_print_saf(nvObj_t *nv){ text_print(nv, fmt_saf);}   // TYPE_INT
+void cm_print_hgrp(nvObj_t *nv){ text_print(nv, fmt_hgrp);} // TYPE_INT
 void cm_print_ml(nvObj_t *nv) { text_print_flt_units(nv, fmt_ml, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_ma(nvObj_t *nv) { text_print_flt_units(nv, fmt_ma, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_ms(nvObj_t *nv) { text_print(nv, fmt_ms);}    // TYPE_FLOAT
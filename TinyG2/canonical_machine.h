@@ -36,7 +36,7 @@
 /* Defines, Macros, and  Assorted Parameters */
 
 #define MODEL 	(GCodeState_t *)&cm.gm		// absolute pointer from canonical machine gm model
-#define PLANNER (GCodeState_t *)&bf->gm		// relative to buffer *bf is currently pointing to
+#define PLANNER mp_get_buffer_gm(bf)			// relative to buffer *bf is currently pointing to
 #define RUNTIME (GCodeState_t *)&mr.gm		// absolute pointer from runtime mm struct
 #define ACTIVE_MODEL cm.am					// active model pointer is maintained by state management
 
@@ -45,6 +45,15 @@
 #define JOGGING_START_VELOCITY ((float)10.0)
 #define DISABLE_SOFT_LIMIT (999999)
 
+#define FEED_OVERRIDE_MIN ((float)0.05)		// feed rate override range (M50.1, mfo)
+#define FEED_OVERRIDE_MAX ((float)2.00)
+#define TRAVERSE_OVERRIDE_MIN ((float)0.05)	// traverse override range (M50.3, mto) - can't go over 100%
+#define TRAVERSE_OVERRIDE_MAX ((float)1.00)
+
+#ifndef HOMING_GROUP
+#define HOMING_GROUP 0						// axes homed together ($hgrp, bit per axis: 1=X,2=Y,4=Z,8=A). 0 = none
+#endif
+
 /*****************************************************************************
  * MACHINE STATE MODEL
  *
@@ -189,7 +198,9 @@ typedef enum {						    // G Modal Group 1
 	MOTION_MODE_CANNED_CYCLE_86,		// G86 - boring, spindle stop, rapid out
 	MOTION_MODE_CANNED_CYCLE_87,		// G87 - back boring
 	MOTION_MODE_CANNED_CYCLE_88,		// G88 - boring, spindle stop, manual out
-	MOTION_MODE_CANNED_CYCLE_89			// G89 - boring, dwell, feed out
+	MOTION_MODE_CANNED_CYCLE_89,		// G89 - boring, dwell, feed out
+	MOTION_MODE_CUBIC_SPLINE,			// G5 - cubic spline feed (added last so momo values don't move)
+	MOTION_MODE_QUADRATIC_SPLINE		// G5.1 - quadratic spline feed
 } cmMotionMode;
 
 typedef enum {						    // Used for detecting gcode errors. See NIST section 3.4
@@ -316,7 +327,8 @@ typedef enum {					    // axis modes (ordered: see _cm_get_feed_time())
 typedef struct GCodeState {				// Gcode model state - used by model, planning and runtime
     uint32_t linenum;					// Gcode block line number
     uint8_t motion_mode;				// Group1: G0, G1, G2, G3, G38.2, G80, G81,
-                                        // G82, G83 G84, G85, G86, G87, G88, G89
+                                        // G82, G83 G84, G85, G86, G87, G88, G89,
+                                        // G5, G5.1
 
     float target[AXES]; 				// XYZABC where the move should go
     float work_offset[AXES];			// offset from the work coordinate system (for reporting only)
@@ -353,6 +365,7 @@ typedef struct GCodeStateExtended {		// Gcode dynamic state extensions - used by
 	uint8_t	feed_rate_override_enable;	// TRUE = overrides enabled (M48), F=(M49)
 	uint8_t	traverse_override_enable;	// TRUE = traverse override enabled
 	uint8_t L_word;						// L word - used by G10s
+	float path_tolerance;				// G64 P - corners are blended within this distance (mm). 0 = no blending
 
 	uint8_t origin_offset_enable;		// G92 offsets enabled/disabled.  0=disabled, 1=enabled
 	uint8_t block_delete_switch;		// set true to enable block deletes (true is default)
@@ -368,7 +381,8 @@ typedef struct GCodeStateExtended {		// Gcode dynamic state extensions - used by
 typedef struct GCodeInput {				// Gcode model inputs - meaning depends on context
 	uint8_t next_action;				// handles G modal group 1 moves & non-modals
 	uint8_t motion_mode;				// Group1: G0, G1, G2, G3, G38.2, G80, G81,
-										// G82, G83 G84, G85, G86, G87, G88, G89
+										// G82, G83 G84, G85, G86, G87, G88, G89,
+										// G5, G5.1
 	uint8_t program_flow;				// used only by the gcode_parser
 	uint32_t linenum;					// N word
 
@@ -403,7 +417,8 @@ typedef struct GCodeInput {				// Gcode model inputs - meaning depends on contex
 
 	float parameter;					// P - parameter used for dwell time in seconds, G10 coord select...
 	float arc_radius;					// R - radius value in arc radius mode
-	float arc_offset[3];  				// IJK - used by arc commands
+	float arc_offset[3];  				// IJK - used by arc commands (IJ by splines)
+	float Q_word;						// Q - used by G5 splines (with P)
 
 // unimplemented gcode parameters
 //	float cutter_radius;				// D - cutter radius compensation (0 is off)
@@ -442,10 +457,14 @@ typedef struct cmSingleton {			// struct to manage cm globals and cycles
 
 	// system group settings
 	float junction_acceleration;		// centripetal acceleration max for cornering
+	uint8_t junction_model;				// how corner velocities are limited (see _calculate_junction_vmax())
 	float chordal_tolerance;			// arc chordal accuracy setting in mm
+	float coalesce_tolerance;			// collinear lines are merged within this distance in mm. 0 = off
+	float coalesce_angle;				// ...if they turn less than this many degrees
 	bool soft_limit_enable;             // true to enable soft limit testing on Gcode inputs
     bool limit_enable;                  // true to enable limit switches (disabled is same as override)
     bool safety_interlock_enable;       // true to enable safety interlock system
+	uint8_t homing_group;				// axes G28.2 searches at once, bit per axis (see cycle_homing.cpp)
 
 	// hidden system settings
 //	float min_segment_len;				// line drawing resolution in mm
@@ -613,6 +632,7 @@ stat_t cm_goto_g30_position(const float target[], const float flags[]);     // G
 stat_t cm_set_feed_rate(const float feed_rate);                             // F parameter
 stat_t cm_set_feed_rate_mode(const uint8_t mode);                           // G93, G94, (G95 unimplemented)
 stat_t cm_set_path_control(const uint8_t mode);                             // G61, G61.1, G64
+stat_t cm_set_path_tolerance(const float tolerance);                        // G64 P
 
 // Machining Functions (4.3.6)
 stat_t cm_straight_feed(const float target[], const float flags[]); // G1
@@ -621,6 +641,11 @@ stat_t cm_arc_feed(const float target[],                                    // G
                    const float i, const float j, const float k,
                    const float radius, 
                    const uint8_t motion_mode);
+stat_t cm_spline_feed(const float target[],                                 // G5, G5.1
+                      const float flags[],
+                      const float i, const float j,
+                      const float p, const float q,
+                      const uint8_t motion_mode);
 stat_t cm_dwell(const float seconds);                                       // G4, P parameter
 
 // Spindle Functions (4.3.7)
@@ -632,13 +657,11 @@ stat_t cm_change_tool(const uint8_t tool);                                  // M
 
 // Miscellaneous Functions (4.3.9)
 // see coolant.h for coolant functions - which would go right here
-/*
 stat_t cm_override_enables(uint8_t flag);                       // M48, M49
 stat_t cm_feed_rate_override_enable(uint8_t flag);              // M50
 stat_t cm_feed_rate_override_factor(uint8_t flag);              // M50.1
 stat_t cm_traverse_override_enable(uint8_t flag);               // M50.2
 stat_t cm_traverse_override_factor(uint8_t flag);               // M50.3
-*/
 void cm_message(const char *message);                           // msg to console (e.g. Gcode comments)
 
 // Program Functions (4.3.10)
@@ -668,6 +691,7 @@ void cm_program_end(void);										// M2
 stat_t cm_homing_cycle_start(void);								// G28.2
 stat_t cm_homing_cycle_start_no_set(void);						// G28.4
 stat_t cm_homing_cycle_callback(void);							// G28.2/.4 main loop callback
+void cm_homing_input_changed(const uint8_t input_num);			// homing switch edge, from the input interrupt
 
 // Probe cycles
 stat_t cm_straight_probe(float target[], float flags[]);		// G38.2
@@ -708,6 +732,8 @@ stat_t cm_get_ofs(nvObj_t *nv);			// get runtime work offset...
 
 stat_t cm_run_qf(nvObj_t *nv);			// run queue flush
 stat_t cm_run_home(nvObj_t *nv);		// start homing cycle
+stat_t cm_set_mfo(nvObj_t *nv);			// set feed rate override factor
+stat_t cm_set_mto(nvObj_t *nv);			// set traverse override factor
 
 stat_t cm_dam(nvObj_t *nv);				// dump active model (debugging command)
 
@@ -719,6 +745,7 @@ stat_t cm_run_joga(nvObj_t *nv);		// start jogging cycle for a
 stat_t cm_get_am(nvObj_t *nv);			// get axis mode
 stat_t cm_set_am(nvObj_t *nv);			// set axis mode
 stat_t cm_set_hi(nvObj_t *nv);          // set homing input
+stat_t cm_set_hgrp(nvObj_t *nv);        // set homing group
 
 stat_t cm_set_jm(nvObj_t *nv);			// set jerk max with 1,000,000 correction
 stat_t cm_set_jh(nvObj_t *nv);			// set jerk homing with 1,000,000 correction
@@ -744,6 +771,8 @@ stat_t cm_set_jh(nvObj_t *nv);			// set jerk homing with 1,000,000 correction
 	void cm_print_path(nvObj_t *nv);
 	void cm_print_dist(nvObj_t *nv);
 	void cm_print_frmo(nvObj_t *nv);
+	void cm_print_mfo(nvObj_t *nv);
+	void cm_print_mto(nvObj_t *nv);
 	void cm_print_tool(nvObj_t *nv);
 	void cm_print_ilck(nvObj_t *nv);
 	void cm_print_estp(nvObj_t *nv);
@@ -760,10 +789,14 @@ stat_t cm_set_jh(nvObj_t *nv);			// set jerk homing with 1,000,000 correction
 	void cm_print_ofs(nvObj_t *nv);		// print runtime work offset always in MM uints
 
 	void cm_print_ja(nvObj_t *nv);		// global CM settings
+	void cm_print_jt(nvObj_t *nv);
 	void cm_print_ct(nvObj_t *nv);
+	void cm_print_clt(nvObj_t *nv);
+	void cm_print_cla(nvObj_t *nv);
 	void cm_print_sl(nvObj_t *nv);
 	void cm_print_lim(nvObj_t *nv);
 	void cm_print_saf(nvObj_t *nv);
+	void cm_print_hgrp(nvObj_t *nv);
 	void cm_print_ml(nvObj_t *nv);
 	void cm_print_ma(nvObj_t *nv);
 	void cm_print_ms(nvObj_t *nv);
@@ -807,6 +840,8 @@ stat_t cm_set_jh(nvObj_t *nv);			// set jerk homing with 1,000,000 correction
 	#define cm_print_path tx_print_stub
 	#define cm_print_dist tx_print_stub
 	#define cm_print_frmo tx_print_stub
+	#define cm_print_mfo tx_print_stub
+	#define cm_print_mto tx_print_stub
 	#define cm_print_tool tx_print_stub
 	#define cm_print_ilck tx_print_stub
 	#define cm_print_estp tx_print_stub
@@ -823,10 +858,14 @@ stat_t cm_set_jh(nvObj_t *nv);			// set jerk homing with 1,000,000 correction
 	#define cm_print_ofs tx_print_stub		// print runtime work offset always in MM uints
 
 	#define cm_print_ja tx_print_stub		// global CM settings
+	#define cm_print_jt tx_print_stub
 	#define cm_print_ct tx_print_stub
+	#define cm_print_clt tx_print_stub
+	#define cm_print_cla tx_print_stub
 	#define cm_print_sl tx_print_stub
 	#define cm_print_lim tx_print_stub
 	#define cm_print_saf tx_print_stub
+	#define cm_print_hgrp tx_print_stub
 	#define cm_print_ml tx_print_stub
 	#define cm_print_ma tx_print_stub
 	#define cm_print_ms tx_print_stub
@@ -36,6 +36,7 @@
 #include "planner.h"
 #include "plan_arc.h"
 #include "stepper.h"
+#include "kinematics.h"
 #include "gpio.h"
 #include "spindle.h"
 #include "coolant.h"
@@ -174,7 +175,7 @@ const cfgItem_t cfgArray[] PROGMEM = {
 //	{ "jog","jogc",_f0, 0, tx_print_nul, get_nul, cm_run_jogc, (float *)&cm.jogging_dest, 0},
 
 	// Motor parameters
-	{ "1","1ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_1].motor_map,	M1_MOTOR_MAP },
+	{ "1","1ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_1].motor_map,	M1_MOTOR_MAP },
 	{ "1","1sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_1].step_angle,	M1_STEP_ANGLE },
 	{ "1","1tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_1].travel_rev,	M1_TRAVEL_PER_REV },
 	{ "1","1mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_1].microsteps,	M1_MICROSTEPS },
@@ -183,8 +184,9 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "1","1pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_1].power_level,M1_POWER_LEVEL },
 #endif
+	{ "1","1hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_1].homing_input,M1_HOMING_INPUT },
 #if (MOTORS >= 2)
-	{ "2","2ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_2].motor_map,	M2_MOTOR_MAP },
+	{ "2","2ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_2].motor_map,	M2_MOTOR_MAP },
 	{ "2","2sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_2].step_angle,	M2_STEP_ANGLE },
 	{ "2","2tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_2].travel_rev,	M2_TRAVEL_PER_REV },
 	{ "2","2mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_2].microsteps,	M2_MICROSTEPS },
@@ -193,9 +195,10 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "2","2pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_2].power_level,M2_POWER_LEVEL},
 #endif
+	{ "2","2hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_2].homing_input,M2_HOMING_INPUT },
 #endif
 #if (MOTORS >= 3)
-	{ "3","3ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_3].motor_map,	M3_MOTOR_MAP },
+	{ "3","3ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_3].motor_map,	M3_MOTOR_MAP },
 	{ "3","3sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_3].step_angle,	M3_STEP_ANGLE },
 	{ "3","3tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_3].travel_rev,	M3_TRAVEL_PER_REV },
 	{ "3","3mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_3].microsteps,	M3_MICROSTEPS },
@@ -204,9 +207,10 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "3","3pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_3].power_level,M3_POWER_LEVEL },
 #endif
+	{ "3","3hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_3].homing_input,M3_HOMING_INPUT },
 #endif
 #if (MOTORS >= 4)
-	{ "4","4ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_4].motor_map,	M4_MOTOR_MAP },
+	{ "4","4ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_4].motor_map,	M4_MOTOR_MAP },
 	{ "4","4sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_4].step_angle,	M4_STEP_ANGLE },
 	{ "4","4tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_4].travel_rev,	M4_TRAVEL_PER_REV },
 	{ "4","4mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_4].microsteps,	M4_MICROSTEPS },
@@ -215,9 +219,10 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "4","4pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_4].power_level,M4_POWER_LEVEL },
 #endif
+	{ "4","4hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_4].homing_input,M4_HOMING_INPUT },
 #endif
 #if (MOTORS >= 5)
-	{ "5","5ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_5].motor_map,	M5_MOTOR_MAP },
+	{ "5","5ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_5].motor_map,	M5_MOTOR_MAP },
 	{ "5","5sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_5].step_angle,	M5_STEP_ANGLE },
 	{ "5","5tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_5].travel_rev,	M5_TRAVEL_PER_REV },
 	{ "5","5mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_5].microsteps,	M5_MICROSTEPS },
@@ -226,9 +231,10 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "5","5pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_5].power_level,M5_POWER_LEVEL },
 #endif
+	{ "5","5hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_5].homing_input,M5_HOMING_INPUT },
 #endif
 #if (MOTORS >= 6)
-	{ "6","6ma",_fip, 0, st_print_ma, get_ui8, set_ui8,   (float *)&st_cfg.mot[MOTOR_6].motor_map,	M6_MOTOR_MAP },
+	{ "6","6ma",_fip, 0, st_print_ma, get_ui8, st_set_ma,  (float *)&st_cfg.mot[MOTOR_6].motor_map,	M6_MOTOR_MAP },
 	{ "6","6sa",_fip, 3, st_print_sa, get_flt, st_set_sa, (float *)&st_cfg.mot[MOTOR_6].step_angle,	M6_STEP_ANGLE },
 	{ "6","6tr",_fipc,4, st_print_tr, get_flt, st_set_tr, (float *)&st_cfg.mot[MOTOR_6].travel_rev,	M6_TRAVEL_PER_REV },
 	{ "6","6mi",_fip, 0, st_print_mi, get_ui8, st_set_mi, (float *)&st_cfg.mot[MOTOR_6].microsteps,	M6_MICROSTEPS },
@@ -237,6 +243,7 @@ const cfgItem_t cfgArray[] PROGMEM = {
 #ifdef __ARM
 	{ "6","6pl",_fip, 3, st_print_pl, get_flt, st_set_pl, (float *)&st_cfg.mot[MOTOR_6].power_level,M6_POWER_LEVEL },
 #endif
+	{ "6","6hi",_fip, 0, st_print_hi, get_ui8, cm_set_hi, (float *)&st_cfg.mot[MOTOR_6].homing_input,M6_HOMING_INPUT },
 #endif
 	// Axis parameters
 	{ "x","xam",_fip,  0, cm_print_am, cm_get_am, cm_set_am, (float *)&cm.a[AXIS_X].axis_mode,		X_AXIS_MODE },
@@ -469,12 +476,25 @@ const cfgItem_t cfgArray[] PROGMEM = {
 
 	// General system parameters
 	{ "sys","ja", _fipnc,0, cm_print_ja,  get_flt, set_flu,  (float *)&cm.junction_acceleration,    JUNCTION_ACCELERATION },
+	{ "sys","jt", _fipn, 0, cm_print_jt,  get_ui8, set_01,   (float *)&cm.junction_model,           JUNCTION_MODEL },
+	{ "sys","kin",_fipn, 0, ik_print_kin, get_ui8, ik_set_kin,     (float *)&kin.type,          KINEMATICS },
+	{ "sys","kdr",_fipnc,3, ik_print_kdr, get_flt, ik_set_geometry,(float *)&kin.delta_radius,  DELTA_RADIUS },
+	{ "sys","kdl",_fipnc,3, ik_print_kdl, get_flt, ik_set_geometry,(float *)&kin.delta_arm,     DELTA_ARM_LENGTH },
+	{ "sys","ksi",_fipnc,3, ik_print_ksi, get_flt, ik_set_geometry,(float *)&kin.scara_inner,   SCARA_INNER_ARM },
+	{ "sys","kso",_fipnc,3, ik_print_kso, get_flt, ik_set_geometry,(float *)&kin.scara_outer,   SCARA_OUTER_ARM },
 	{ "sys","ct", _fipnc,4, cm_print_ct,  get_flt, set_flu,  (float *)&cm.chordal_tolerance,        CHORDAL_TOLERANCE },
+	{ "sys","clt",_fipnc,4, cm_print_clt, get_flt, set_flu,  (float *)&cm.coalesce_tolerance,       COALESCE_TOLERANCE },
+	{ "sys","cla",_fipn, 2, cm_print_cla, get_flt, set_flt,  (float *)&cm.coalesce_angle,           COALESCE_ANGLE },
 	{ "sys","sl", _fipn, 0, cm_print_sl,  get_ui8, set_01,   (float *)&cm.soft_limit_enable,        SOFT_LIMIT_ENABLE },
 	{ "sys","lim",_fipn, 0, cm_print_lim, get_ui8, set_01,   (float *)&cm.limit_enable,	            HARD_LIMIT_ENABLE },
 	{ "sys","saf",_fipn, 0, cm_print_saf, get_ui8, set_01,   (float *)&cm.safety_interlock_enable,	SAFETY_INTERLOCK_ENABLE },
+	{ "sys","hgrp",_fipn,0, cm_print_hgrp,get_ui8, cm_set_hgrp,(float *)&cm.homing_group,           HOMING_GROUP },
 	{ "sys","mt", _fipn, 2, st_print_mt,  get_flt, st_set_mt,(float *)&st_cfg.motor_power_timeout,  MOTOR_POWER_TIMEOUT},
 
+    // Feed rate and traverse overrides
+    { "",   "mfo", _f0,  3, cm_print_mfo, get_flt, cm_set_mfo,(float *)&cm.gmx.feed_rate_override_factor, 0 },
+    { "",   "mto", _f0,  3, cm_print_mto, get_flt, cm_set_mto,(float *)&cm.gmx.traverse_override_factor, 0 },
+
     // Spindle functions
     { "sys","spep",_fipn,0, cm_print_spep,get_ui8, set_01,  (float *)&spindle.enable_polarity,      SPINDLE_ENABLE_POLARITY },
     { "sys","spdp",_fipn,0, cm_print_spdp,get_ui8, set_01,  (float *)&spindle.dir_polarity,         SPINDLE_DIR_POLARITY },
@@ -575,6 +595,7 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	// Diagnostic parameters
 #ifdef __DIAGNOSTIC_PARAMETERS
 	{ "",    "clc",_f0, 0, tx_print_nul, st_clc,  st_clc, (float *)&cs.null, 0 },	// clear diagnostic step counters
+	{ "",    "_un",_f0, 0, tx_print_int, get_int, set_nul,(float *)&st_pre.underruns, 0 },	// stepper prep underruns
 
 	{ "_te","_tex",_f0, 2, tx_print_flt, get_flt, set_nul,(float *)&mr.target[AXIS_X], 0 },				// X target endpoint
 	{ "_te","_tey",_f0, 2, tx_print_flt, get_flt, set_nul,(float *)&mr.target[AXIS_Y], 0 },
@@ -136,9 +136,13 @@ void controller_init(uint8_t std_in, uint8_t std_out, uint8_t std_err)
 
 void controller_run()
 {
+#ifdef __HOST__
+	_controller_HSM();          // the host simulation owns the loop so it can charge each pass to the clock
+#else
 	while (true) {
 		_controller_HSM();
 	}
+#endif
 }
 
 #define	DISPATCH(func) if (func == STAT_EAGAIN) return;
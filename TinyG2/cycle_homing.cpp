@@ -33,6 +33,9 @@
 #include "text_parser.h"
 #include "canonical_machine.h"
 #include "planner.h"
+#include "kinematics.h"
+#include "encoder.h"
+#include "stepper.h"
 #include "gpio.h"
 #include "report.h"
 
@@ -63,6 +66,17 @@ struct hmHomingSingleton {			// persistent homing runtime variables
 	float saved_feed_rate;			// F setting
 	float saved_jerk;				// saved and restored for each axis homed
 //    bool saved_limit_enable;        // limit switch processing / overrride
+
+	// group homing (see _homing_group_start())
+	uint8_t group;					// axes being homed together, bit per axis
+	uint8_t group_done;				// axes already homed in a group this cycle
+	volatile bool grouped;			// true = switch changes stop their motors, not the move
+	volatile uint16_t group_inputs;	// inputs yet to change in the group move now running, bit per input
+	uint8_t input_motors[DI_CHANNELS];	// motors each input stops, bit per motor
+	int8_t input_axis[DI_CHANNELS];	// axis each input belongs to, -1 for none
+	float group_edge[AXES];			// where each axis' switch changed
+	float group_jerk[AXES];			// saved and restored for each axis in the group
+	uint8_t group_jerk_saved;		// axes whose group_jerk is yet to be restored, bit per axis
 };
 static struct hmHomingSingleton hm;
 
@@ -70,16 +84,26 @@ static struct hmHomingSingleton hm;
 
 static stat_t _set_homing_func(stat_t (*func)(int8_t axis));
 static stat_t _homing_axis_start(int8_t axis);
+static stat_t _homing_axis_check(int8_t axis);
+static float _homing_travel_distance(int8_t axis);
 static stat_t _homing_axis_clear(int8_t axis);
 static stat_t _homing_axis_search(int8_t axis);
 static stat_t _homing_axis_latch(int8_t axis);
 static stat_t _homing_axis_zero_backoff(int8_t axis);
 static stat_t _homing_axis_set_zero(int8_t axis);
 static stat_t _homing_axis_move(int8_t axis, float target, float velocity);
+static float _homing_axis_edge_offset(int8_t axis);
 static stat_t _homing_error_exit(int8_t axis, stat_t status);
 static stat_t _homing_finalize_exit(int8_t axis);
 static int8_t _get_next_axis(int8_t axis);
 
+static uint8_t _homing_group_axes(int8_t axis);
+static stat_t _homing_group_start(int8_t axis);
+static stat_t _homing_group_search(int8_t axis);
+static stat_t _homing_group_latch(int8_t axis);
+static stat_t _homing_group_zero_backoff(int8_t axis);
+static stat_t _homing_group_set_zero(int8_t axis);
+
 /**** HELPERS ***************************************************************************
  * _set_homing_func() - a convenience for setting the next dispatch vector and exiting
  */
@@ -123,6 +147,17 @@ static stat_t _set_homing_func(stat_t (*func)(int8_t axis))
  *	  2. Move off the homing switch at latch velocity until switch opens
  *	  3. Back off switch by the zero backoff distance and set zero for that axis
  *
+ *	The input interrupt latches the step position at each switch edge (en_latch_encoders()),
+ *	and zero is set relative to the latched edge - zero backoff distance from it - not to
+ *	wherever the feedhold after the edge happened to stop. So the latch velocity no longer
+ *	limits the accuracy, and with a latch backoff of zero the latch move (2) is skipped and
+ *	zero is taken from the edge the search hit. The switch's hysteresis moves that edge
+ *	from the one the latch move finds, so re-check the zero backoff when changing to it.
+ *
+ *	Axes in the homing group ($hgrp, bit per axis: 1=X,2=Y,4=Z,8=A) are homed together
+ *	when the first of them comes up in the order - see _homing_group_start(). So is an
+ *	axis with a motor that has its own homing input ($1hi...), for gantry squaring.
+ *
  *	Homing works as a state machine that is driven by registering a callback function
  *  at hm.func() for the next state to be run. Once the axis is initialized each
  *  callback basically does two things (1) start the move for the current function,
@@ -167,6 +202,9 @@ stat_t cm_homing_cycle_start(void)
 	hm.set_coordinates = true;
 
 	hm.axis = -1;							// set to retrieve initial axis
+	hm.group_done = 0;
+	hm.group_jerk_saved = 0;
+	hm.grouped = false;
 	hm.func = _homing_axis_start; 			// bind initial processing function
 	cm.machine_state = MACHINE_CYCLE;
 	cm.cycle_state = CYCLE_HOMING;
@@ -202,8 +240,11 @@ stat_t cm_homing_cycle_callback(void)
 
 static stat_t _homing_axis_start(int8_t axis)
 {
-	// get the first or next axis
-	if ((axis = _get_next_axis(axis)) < 0) { 				// axes are done or error
+	// get the first or next axis, skipping any already homed in a group
+	do {
+		axis = _get_next_axis(axis);
+	} while ((axis >= 0) && (hm.group_done & (1<<axis)));
+	if (axis < 0) { 										// axes are done or error
 		if (axis == -1) {									// -1 is done
 			cm.homing_state = HOMING_HOMED;
 			return (_set_homing_func(_homing_finalize_exit));
@@ -211,18 +252,19 @@ static stat_t _homing_axis_start(int8_t axis)
 			return (_homing_error_exit(-2, STAT_HOMING_ERROR_BAD_OR_NO_AXIS));
 		}
 	}
+	// axes homed together go off to the group state machine
+	if ((hm.group = _homing_group_axes(axis)) != 0) {
+		hm.axis = axis;
+		return (_set_homing_func(_homing_group_start));
+	}
+
 	// clear the homed flag for axis so we'll be able to move w/o triggering soft limits
 	cm.homed[axis] = false;
 
 	// trap axis mis-configurations
-	if (fp_ZERO(cm.a[axis].homing_input)) return (_homing_error_exit(axis, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
-	if (fp_ZERO(cm.a[axis].search_velocity)) return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_SEARCH_VELOCITY));
-	if (fp_ZERO(cm.a[axis].latch_velocity)) return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_LATCH_VELOCITY));
-	if (cm.a[axis].latch_backoff < 0) return (_homing_error_exit(axis, STAT_HOMING_ERROR_NEGATIVE_LATCH_BACKOFF));
-
-	// calculate and test travel distance
-	float travel_distance = fabs(cm.a[axis].travel_max - cm.a[axis].travel_min) + cm.a[axis].latch_backoff;
-	if (fp_ZERO(travel_distance)) return (_homing_error_exit(axis, STAT_HOMING_ERROR_TRAVEL_MIN_MAX_IDENTICAL));
+	stat_t status;
+	if ((status = _homing_axis_check(axis)) != STAT_OK) return (_homing_error_exit(axis, status));
+	float travel_distance = _homing_travel_distance(axis);
 
     // Nothing to do about direction now that direction is explicit
     // However, here's a good place to stash the homing_switch:
@@ -262,7 +304,8 @@ static stat_t _homing_axis_clear(int8_t axis)				// first clear move
                 return (_homing_error_exit(axis, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING)); // axis cannot be homed
             }
         }
-        _homing_axis_move(axis, hm.latch_backoff, hm.search_velocity);  // otherwise back off the switch
+        float clear_backoff = (fp_ZERO(hm.latch_backoff) ? hm.zero_backoff : hm.latch_backoff);
+        _homing_axis_move(axis, clear_backoff, hm.search_velocity);     // otherwise back off the switch
     }
  	return (_set_homing_func(_homing_axis_search));			// start the search
 }
@@ -270,13 +313,18 @@ static stat_t _homing_axis_clear(int8_t axis)				// first clear move
 static stat_t _homing_axis_search(int8_t axis)				// start the search
 {
 	cm_set_axis_jerk(axis, cm.a[axis].jerk_high);			// use the high-speed jerk for search onward
+	en_reset_latch();										// latch where the switch closes
 	_homing_axis_move(axis, hm.search_travel, hm.search_velocity);
 	return (_set_homing_func(_homing_axis_latch));
 }
 
 static stat_t _homing_axis_latch(int8_t axis)				// latch to switch open
 {
+	if (fp_ZERO(hm.latch_backoff)) {						// zero from the search edge latched above
+		return (_set_homing_func(_homing_axis_zero_backoff));
+	}
 	mp_flush_planner();                                     // clear out the remaining search move
+	en_reset_latch();										// latch where the switch opens
 	_homing_axis_move(axis, hm.latch_backoff, hm.latch_velocity);
 	return (_set_homing_func(_homing_axis_zero_backoff));
 }
@@ -284,6 +332,7 @@ static stat_t _homing_axis_latch(int8_t axis)				// latch to switch open
 static stat_t _homing_axis_zero_backoff(int8_t axis)		// backoff to zero position
 {
     mp_flush_planner();                                     // clear out the remaining latch move
+    gpio_set_homing_mode(hm.homing_input, false);           // end homing mode - the backoff may still open the switch
 	_homing_axis_move(axis, hm.zero_backoff, hm.search_velocity);
 	return (_set_homing_func(_homing_axis_set_zero));
 }
@@ -291,17 +340,56 @@ static stat_t _homing_axis_zero_backoff(int8_t axis)		// backoff to zero positio
 static stat_t _homing_axis_set_zero(int8_t axis)			// set zero and finish up
 {
 	if (hm.set_coordinates) {
-		cm_set_position(axis, 0);
+		cm_set_position(axis, _homing_axis_edge_offset(axis));
 		cm.homed[axis] = true;
 	} else {                                                // do not set axis if in G28.4 cycle
 		cm_set_position(axis, cm_get_work_position(RUNTIME, axis));
 	}
 	cm_set_axis_jerk(axis, hm.saved_jerk);					// restore the max jerk value
-
-    gpio_set_homing_mode(hm.homing_input, false);           // end homing mode
 	return (_set_homing_func(_homing_axis_start));
 }
 
+/*
+ * _homing_axis_edge_offset() - where the axis is now, taking the latched switch edge as -zero_backoff
+ *
+ *	Returns 0 (the old rule: zero is wherever the backoff stopped) if no edge was latched.
+ */
+
+static float _homing_axis_edge_offset(int8_t axis)
+{
+	float steps[MOTORS];
+	float edge[AXES];
+
+	if (!en_read_latch(steps)) {
+		return (0);
+	}
+	for (uint8_t i=0; i<AXES; i++) {						// seed for the kinematics
+		edge[i] = cm_get_absolute_position(RUNTIME, i);
+	}
+	ik_forward_kinematics(steps, edge);
+	return (cm_get_absolute_position(RUNTIME, axis) - edge[axis] - hm.zero_backoff);
+}
+
+/*
+ * _homing_axis_check()			 - trap axis mis-configurations
+ * _homing_travel_distance()	 - how far a search may go looking for the switch
+ */
+
+static stat_t _homing_axis_check(int8_t axis)
+{
+	if (fp_ZERO(cm.a[axis].homing_input)) return (STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED);
+	if (fp_ZERO(cm.a[axis].search_velocity)) return (STAT_HOMING_ERROR_ZERO_SEARCH_VELOCITY);
+	if (fp_ZERO(cm.a[axis].latch_velocity)) return (STAT_HOMING_ERROR_ZERO_LATCH_VELOCITY);
+	if (cm.a[axis].latch_backoff < 0) return (STAT_HOMING_ERROR_NEGATIVE_LATCH_BACKOFF);
+	if (fp_ZERO(_homing_travel_distance(axis))) return (STAT_HOMING_ERROR_TRAVEL_MIN_MAX_IDENTICAL);
+	return (STAT_OK);
+}
+
+static float _homing_travel_distance(int8_t axis)
+{
+	return (fabs(cm.a[axis].travel_max - cm.a[axis].travel_min) + cm.a[axis].latch_backoff);
+}
+
 static stat_t _homing_axis_move(int8_t axis, float target, float velocity)
 {
 	float vect[] = {0,0,0,0,0,0};
@@ -318,6 +406,342 @@ static stat_t _homing_axis_move(int8_t axis, float target, float velocity)
 	return (STAT_EAGAIN);
 }
 
+/***********************************************************************************
+ **** Group homing *****************************************************************
+ ***********************************************************************************/
+/*
+ * Group homing runs the same clear, search, latch and zero backoff as a single axis,
+ * but each one is a single move of all the axes in the group. Rather than a feedhold
+ * when a switch changes, the input interrupt stops just the motors on that switch
+ * (st_lock_motors()), dead, and the rest of the move runs on. When the last switch in
+ * the move has changed it holds, as before. So axes finish in whatever order their
+ * switches come, and each stops at its switch - there's no overshoot to back out.
+ *
+ * Every motor stops on its axis' homing input, or on its own ($1hi...) if it has one.
+ * Giving the two motors of a gantry axis a switch each squares the gantry: each side
+ * stops at its own switch, and when the search is over both are taken to be at the
+ * edge (the lowest numbered motor sets the axis position - see ik_forward_kinematics()).
+ * Motors of different axes can't share an input, as the switch couldn't say which axis
+ * it saw.
+ *
+ * Stopping a motor dead at the search velocity is harder on it than a feedhold. Keep
+ * the search velocity within what the motor can start and stop at without losing steps.
+ *
+ * Each move takes as long as the slowest axis needs at its own velocity, so no axis
+ * goes faster than its search (or latch) velocity, and none goes further than its own
+ * search travel. A switch that doesn't change in a move is an error for its axis.
+ */
+
+#define _in_group(a) (hm.group & (1<<(a)))
+
+/*
+ * _homing_group_axes() - the axes to home along with this one, or 0 to home it on its own
+ */
+
+static uint8_t _homing_group_axes(int8_t axis)
+{
+	uint8_t group = (1<<axis);
+
+	if (cm.homing_group & (1<<axis)) {
+		for (uint8_t a=0; a<HOMING_AXES; a++) {
+			if ((cm.homing_group & (1<<a)) && (fp_TRUE(cm.gf.target[a]))) {
+				group |= (1<<a);
+			}
+		}
+	}
+	if (group != (1<<axis)) {
+		return (group);
+	}
+	for (uint8_t motor=0; motor<MOTORS; motor++) {			// a motor on its own switch needs the group code
+		if ((st_cfg.mot[motor].motor_map == axis) && (st_cfg.mot[motor].homing_input != 0)) {
+			return (group);
+		}
+	}
+	return (0);
+}
+
+/*
+ * _homing_group_move() - one move of all the group axes with travel, each at its velocity
+ * _homing_group_sync() - set the group axes to where their motors actually are
+ * _homing_group_missed() - the axis of a switch that didn't change in the last move, or -1
+ * _homing_group_locked_out() - true while any group input is in its debounce lockout
+ */
+
+static stat_t _homing_group_move(const float travel[], const float velocity[])
+{
+	float vect[] = {0,0,0,0,0,0};
+	float flags[] = {false, false, false, false, false, false};
+	float length = 0;
+	float time = 0;
+
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		if (fp_ZERO(travel[axis])) {
+			continue;
+		}
+		vect[axis] = travel[axis];
+		flags[axis] = true;
+		length += square(travel[axis]);
+		time = max(time, fabs(travel[axis]) / velocity[axis]);
+	}
+	if (fp_ZERO(time)) {
+		return (STAT_OK);									// nothing to move
+	}
+	cm_set_feed_rate(sqrt(length) / time);
+	mp_flush_planner();
+	cm_end_hold();
+	ritorno(cm_straight_feed(vect, flags));
+	return (STAT_EAGAIN);
+}
+
+static void _homing_group_sync()
+{
+	float steps[MOTORS];
+	float travel[AXES];
+
+	mp_flush_planner();										// clear out what's left of the last move
+	st_unlock_motors();
+	en_read_encoders(steps);
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		travel[axis] = cm_get_absolute_position(RUNTIME, axis);
+	}
+	ik_forward_kinematics(steps, travel);
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		if (_in_group(axis)) {
+			cm_set_position(axis, travel[axis]);
+		}
+	}
+}
+
+static int8_t _homing_group_missed()
+{
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		if (hm.group_inputs & (1<<input)) {
+			return (hm.input_axis[input]);
+		}
+	}
+	return (-1);
+}
+
+static bool _homing_group_locked_out()
+{
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		if ((hm.input_axis[input] != -1) && (gpio_input_locked_out(input+1))) {
+			return (true);
+		}
+	}
+	return (false);
+}
+
+/*
+ * cm_homing_input_changed() - a homing switch changed (called from the input interrupt)
+ */
+
+void cm_homing_input_changed(const uint8_t input_num)
+{
+	if (!hm.grouped) {
+		cm_start_hold();									// one axis at a time: stop the move
+		return;
+	}
+	uint16_t input_bit = (1<<(input_num-1));
+	if (!(hm.group_inputs & input_bit)) {					// not in this move, or already seen
+		return;
+	}
+	st_lock_motors(hm.input_motors[input_num-1]);
+	if ((hm.group_inputs &= ~input_bit) == 0) {
+		cm_start_hold();									// the last one - stop the move
+	}
+}
+
+/*
+ * Group homing moves - these execute in sequence for the group
+ *
+ *	_homing_group_start()		- check the axes, map inputs to motors, clear any switches thrown at the start
+ *	_homing_group_search()		- search for the switches, each axis stopping on its own
+ *	_homing_group_latch()		- slow reverse until each switch opens again
+ *	_homing_group_zero_backoff() - back off from the switch edges to the zero positions
+ *	_homing_group_set_zero()	- set zero from the edges, and go on to the next axis
+ */
+
+static stat_t _homing_group_start(int8_t axis)
+{
+	stat_t status;
+
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		hm.input_motors[input] = 0;
+		hm.input_axis[input] = -1;
+	}
+	for (uint8_t a=0; a<AXES; a++) {
+		if (!_in_group(a)) {
+			continue;
+		}
+		if ((status = _homing_axis_check(a)) != STAT_OK) {
+			return (_homing_error_exit(a, status));
+		}
+		for (uint8_t motor=0; motor<MOTORS; motor++) {
+			if (st_cfg.mot[motor].motor_map != a) {
+				continue;
+			}
+			uint8_t input = st_cfg.mot[motor].homing_input;
+			if (input == 0) {
+				input = cm.a[a].homing_input;
+			}
+			if ((hm.input_axis[input-1] != -1) && (hm.input_axis[input-1] != a)) {
+				return (_homing_error_exit(a, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
+			}
+			hm.input_axis[input-1] = a;
+			hm.input_motors[input-1] |= (1<<motor);
+		}
+	}
+
+	// set up the axes and inputs, and clear off any switches that are closed
+	float travel[AXES] = {0,0,0,0,0,0};
+	float velocity[AXES];
+	uint16_t closed = 0;
+
+	for (uint8_t a=0; a<AXES; a++) {
+		if (_in_group(a)) {
+			cm.homed[a] = false;
+			hm.group_jerk[a] = cm_get_axis_jerk(a);
+			hm.group_jerk_saved |= (1<<a);
+			cm_set_axis_jerk(a, cm.a[a].jerk_high);
+			velocity[a] = fabs(cm.a[a].search_velocity);
+		}
+	}
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		if (hm.input_axis[input] == -1) {
+			continue;
+		}
+		gpio_set_homing_mode(input+1, true);
+		if (gpio_read_input(input+1) == INPUT_ACTIVE) {
+			int8_t a = hm.input_axis[input];
+			float clear_backoff = (fp_ZERO(cm.a[a].latch_backoff) ? cm.a[a].zero_backoff : cm.a[a].latch_backoff);
+			travel[a] = (cm.a[a].homing_dir ? -clear_backoff : clear_backoff);
+			closed |= (1<<input);
+		}
+	}
+	hm.group_inputs = closed;
+	hm.grouped = true;
+	_homing_group_move(travel, velocity);
+	return (_set_homing_func(_homing_group_search));
+}
+
+static stat_t _homing_group_search(int8_t axis)
+{
+	_homing_group_sync();									// before any error exit, so a failed group knows where it is
+	int8_t missed;
+	if ((missed = _homing_group_missed()) >= 0) {
+		return (_homing_error_exit(missed, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING));
+	}
+
+	float travel[AXES] = {0,0,0,0,0,0};
+	float velocity[AXES];
+	uint16_t inputs = 0;
+
+	for (uint8_t a=0; a<AXES; a++) {
+		if (_in_group(a)) {
+			float distance = _homing_travel_distance(a);
+			travel[a] = (cm.a[a].homing_dir ? distance : -distance);
+			velocity[a] = fabs(cm.a[a].search_velocity);
+		}
+	}
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		if (hm.input_axis[input] != -1) {
+			inputs |= (1<<input);
+		}
+	}
+	hm.group_inputs = inputs;
+	_homing_group_move(travel, velocity);
+	return (_set_homing_func(_homing_group_latch));
+}
+
+static stat_t _homing_group_latch(int8_t axis)
+{
+	// A motor stopped at its switch opens it again on its first step back. Wait out the
+	// lockout from the closing edge or the opening one would be ignored.
+	if (_homing_group_locked_out()) {
+		return (STAT_EAGAIN);
+	}
+	_homing_group_sync();
+	int8_t missed;
+	if ((missed = _homing_group_missed()) >= 0) {
+		return (_homing_error_exit(missed, STAT_HOMING_ERROR_SWITCH_NOT_FOUND));
+	}
+
+	float travel[AXES] = {0,0,0,0,0,0};
+	float velocity[AXES];
+	uint16_t inputs = 0;
+
+	for (uint8_t a=0; a<AXES; a++) {
+		if (!_in_group(a)) {
+			continue;
+		}
+		hm.group_edge[a] = cm_get_absolute_position(RUNTIME, a);	// the closing edge, if there's no latch move
+		if (fp_NOT_ZERO(cm.a[a].latch_backoff)) {
+			travel[a] = (cm.a[a].homing_dir ? -cm.a[a].latch_backoff : cm.a[a].latch_backoff);
+			velocity[a] = fabs(cm.a[a].latch_velocity);
+			for (uint8_t input=0; input<DI_CHANNELS; input++) {
+				if (hm.input_axis[input] == a) {
+					inputs |= (1<<input);
+				}
+			}
+		}
+	}
+	hm.group_inputs = inputs;
+	_homing_group_move(travel, velocity);
+	return (_set_homing_func(_homing_group_zero_backoff));
+}
+
+static stat_t _homing_group_zero_backoff(int8_t axis)
+{
+	_homing_group_sync();
+	int8_t missed;
+	if ((missed = _homing_group_missed()) >= 0) {			// the switch didn't open in the latch backoff
+		return (_homing_error_exit(missed, STAT_HOMING_ERROR_SWITCH_NOT_FOUND));
+	}
+	hm.grouped = false;
+
+	float travel[AXES] = {0,0,0,0,0,0};
+	float velocity[AXES];
+
+	for (uint8_t a=0; a<AXES; a++) {
+		if (!_in_group(a)) {
+			continue;
+		}
+		if (fp_NOT_ZERO(cm.a[a].latch_backoff)) {
+			hm.group_edge[a] = cm_get_absolute_position(RUNTIME, a);	// the opening edge
+		}
+		travel[a] = (cm.a[a].homing_dir ? -cm.a[a].zero_backoff : cm.a[a].zero_backoff);
+		velocity[a] = fabs(cm.a[a].search_velocity);
+	}
+	for (uint8_t input=0; input<DI_CHANNELS; input++) {
+		if (hm.input_axis[input] != -1) {
+			gpio_set_homing_mode(input+1, false);			// end homing mode - the backoff may still open a switch
+		}
+	}
+	_homing_group_move(travel, velocity);
+	return (_set_homing_func(_homing_group_set_zero));
+}
+
+static stat_t _homing_group_set_zero(int8_t axis)
+{
+	for (uint8_t a=0; a<AXES; a++) {
+		if (!_in_group(a)) {
+			continue;
+		}
+		if (hm.set_coordinates) {
+			float zero_backoff = (cm.a[a].homing_dir ? -cm.a[a].zero_backoff : cm.a[a].zero_backoff);
+			cm_set_position(a, cm_get_absolute_position(RUNTIME, a) - hm.group_edge[a] - zero_backoff);
+			cm.homed[a] = true;
+		} else {                                            // do not set axis if in G28.4 cycle
+			cm_set_position(a, cm_get_work_position(RUNTIME, a));
+		}
+		cm_set_axis_jerk(a, hm.group_jerk[a]);				// restore the max jerk value
+	}
+	hm.group_jerk_saved &= ~hm.group;
+	hm.group_done |= hm.group;
+	return (_set_homing_func(_homing_axis_start));
+}
+
 /*
  * _homing_error_exit()
  *
@@ -347,6 +771,17 @@ static stat_t _homing_error_exit(int8_t axis, stat_t status)
 
 static stat_t _homing_finalize_exit(int8_t axis)			// third part of return to home
 {
+	hm.grouped = false;										// in case a group homing failed
+	st_unlock_motors();
+	for (uint8_t a=0; a<AXES; a++) {						// a failed group leaves its axes at jerk_high
+		if (hm.group_jerk_saved & (1<<a)) {
+			cm_set_axis_jerk(a, hm.group_jerk[a]);
+		}
+	}
+	hm.group_jerk_saved = 0;
+	for (uint8_t input=1; input<=DI_CHANNELS; input++) {
+		gpio_set_homing_mode(input, false);
+	}
 	mp_flush_planner(); 									// should be stopped, but in case of switch feedhold.
 //	if (cm.hold_state == FEEDHOLD_HOLD); {
     cm_end_hold();                                          // ends hold if on is in effect
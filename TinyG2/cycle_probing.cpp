@@ -33,6 +33,8 @@
 #include "spindle.h"
 #include "report.h"
 #include "gpio.h"
+#include "encoder.h"
+#include "kinematics.h"
 #include "planner.h"
 #include "util.h"
 
@@ -190,7 +192,8 @@ static uint8_t _probing_init()
     // TODO -- for now we hard code it to zmin
     pb.probe_input = 5;
 
-    // Set the input into probing mode
+    // Set the input into probing mode and arm the position latch
+    en_reset_latch();
     gpio_set_probing_mode(pb.probe_input, true);
 	cm_spindle_control(SPINDLE_OFF);
 	return (_set_pb_func(_probing_start));							// start the move
@@ -243,7 +246,9 @@ static stat_t _probing_backoff()
 static stat_t _probing_finish()
 {
     int8_t probe = gpio_read_input(pb.probe_input);
-	cm.probe_state = (probe==true) ? PROBE_SUCCEEDED : PROBE_FAILED;
+	float latched_steps[MOTORS];
+	bool latched = en_read_latch(latched_steps);	// the probe tripped during the move
+	cm.probe_state = ((probe==true) || latched) ? PROBE_SUCCEEDED : PROBE_FAILED;
 
 	for (uint8_t axis=0; axis<AXES; axis++ ) {
 		// if we got here because of a feed hold we need to keep the model position correct
@@ -253,6 +258,13 @@ static stat_t _probing_finish()
 		cm.probe_results[axis] = cm_get_absolute_position(ACTIVE_MODEL, axis);
 	}
 
+	// If the probe tripped during the move the result is where it tripped - the step position
+	// the input interrupt latched at the edge - not where the hold stopped after decelerating
+	// past it. The stopped position seeds the forward kinematics.
+	if (latched) {
+		ik_forward_kinematics(latched_steps, cm.probe_results);
+	}
+
 	// If probe was successful the 'e' word == 1, otherwise e == 0 to signal an error
 	printf_P(PSTR("{\"prb\":{\"e\":%i"), (int)cm.probe_state);
 	if (fp_TRUE(pb.flags[AXIS_X])) printf_P(PSTR(",\"x\":%0.3f"), cm.probe_results[AXIS_X]);
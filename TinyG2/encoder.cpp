@@ -100,6 +100,68 @@ float en_read_encoder(uint8_t motor)
 	return((float)en.en[motor].encoder_steps);
 }
 
+/*
+ * en_reset_latch()	   - arm the latch for the next en_latch_encoders()
+ * en_latch_encoders() - capture the step position of every motor, right now
+ * en_read_latch()	   - get the latched position, if there is one
+ * en_read_encoders()  - get the step position of every motor, right now
+ *
+ *	en_latch_encoders() is called from an input interrupt at the switch edge, so the
+ *	position is where the machine was when the switch tripped, not where a feedhold left
+ *	it after decelerating past. Only the first latch after a reset counts - bounces and
+ *	later edges don't move it.
+ *
+ *	The position is encoder_steps plus the steps_run of the segment now running. A load
+ *	folds steps_run into encoder_steps, and can run from above or below the input
+ *	interrupts, so interrupts are off for the few reads it takes. The latch is called from
+ *	the input interrupt, so the interrupt mask is put back as it was, not just re-enabled.
+ */
+
+void en_reset_latch()
+{
+	en.latched = false;
+}
+
+void en_latch_encoders()
+{
+	if (en.latched) {
+		return;
+	}
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		en.en[motor].latched_steps = en.en[motor].encoder_steps + en.en[motor].steps_run;
+	}
+	en.latched = true;
+	__set_PRIMASK(primask);
+}
+
+bool en_read_latch(float steps[])
+{
+	if (!en.latched) {
+		return (false);
+	}
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		steps[motor] = (float)en.en[motor].latched_steps;
+	}
+	return (true);
+}
+
+void en_read_encoders(float steps[])
+{
+	int32_t now[MOTORS];
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		now[motor] = en.en[motor].encoder_steps + en.en[motor].steps_run;
+	}
+	__set_PRIMASK(primask);
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		steps[motor] = (float)now[motor];
+	}
+}
+
 /***********************************************************************************
  * CONFIGURATION AND INTERFACE FUNCTIONS
  * Functions to get and set variables from the cfgArray table
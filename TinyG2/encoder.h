@@ -103,10 +103,12 @@ typedef struct enEncoder { 			// one real or virtual encoder per controlled moto
 	int8_t  step_sign;				// set to +1 or -1
 	int16_t steps_run;				// steps counted during stepper interrupt
 	int32_t encoder_steps;			// counted encoder position	in steps
+	int32_t latched_steps;			// position at the last latch (see en_latch_encoders())
 } enEncoder_t;
 
 typedef struct enEncoders {
 	magic_t magic_start;
+	volatile bool latched;			// latched_steps hold a position not yet read
 	enEncoder_t en[MOTORS];			// runtime encoder structures
 	magic_t magic_end;
 } enEncoders_t;
@@ -124,4 +126,9 @@ stat_t encoder_test_assertions(void);
 void en_set_encoder_steps(uint8_t motor, float steps);
 float en_read_encoder(uint8_t motor);
 
+void en_reset_latch(void);
+void en_latch_encoders(void);
+bool en_read_latch(float steps[]);
+void en_read_encoders(float steps[]);
+
 #endif	// End of include guard: ENCODER_H_ONCE
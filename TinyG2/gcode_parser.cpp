@@ -272,6 +272,14 @@ static stat_t _parse_gcode_block(char *buf)
 				case 2:  SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CW_ARC);
 				case 3:  SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CCW_ARC);
 				case 4:  SET_NON_MODAL (next_action, NEXT_ACTION_DWELL);
+				case 5: {
+					switch (_point(value)) {
+						case 0: SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_CUBIC_SPLINE);
+						case 1: SET_MODAL (MODAL_GROUP_G1, motion_mode, MOTION_MODE_QUADRATIC_SPLINE);
+						default: status = STAT_GCODE_COMMAND_UNSUPPORTED;
+					}
+					break;
+				}
 				case 10: SET_MODAL (MODAL_GROUP_G0, next_action, NEXT_ACTION_SET_COORD_DATA);
 				case 17: SET_MODAL (MODAL_GROUP_G2, select_plane, CANON_PLANE_XY);
 				case 18: SET_MODAL (MODAL_GROUP_G2, select_plane, CANON_PLANE_XZ);
@@ -355,9 +363,18 @@ static stat_t _parse_gcode_block(char *buf)
 				case 7: SET_MODAL (MODAL_GROUP_M8, mist_coolant, true);
 				case 8: SET_MODAL (MODAL_GROUP_M8, flood_coolant, true);
 				case 9: SET_MODAL (MODAL_GROUP_M8, flood_coolant, false);
-//				case 48: SET_MODAL (MODAL_GROUP_M9, override_enables, true);
-//				case 49: SET_MODAL (MODAL_GROUP_M9, override_enables, false);
-//				case 50: SET_MODAL (MODAL_GROUP_M9, feed_rate_override_enable, true); // conditionally true
+				case 48: SET_MODAL (MODAL_GROUP_M9, override_enables, true);
+				case 49: SET_MODAL (MODAL_GROUP_M9, override_enables, false);
+				case 50: {
+					switch (_point(value)) {
+						case 0: SET_MODAL (MODAL_GROUP_M9, feed_rate_override_enable, true); // conditionally true
+						case 1: SET_MODAL (MODAL_GROUP_M9, feed_rate_override_factor, true); // factor is in P
+						case 2: SET_MODAL (MODAL_GROUP_M9, traverse_override_enable, true);  // conditionally true
+						case 3: SET_MODAL (MODAL_GROUP_M9, traverse_override_factor, true);  // factor is in P
+						default: status = STAT_MCODE_COMMAND_UNSUPPORTED;
+					}
+					break;
+				}
 //				case 51: SET_MODAL (MODAL_GROUP_M9, spindle_override_enable, true);	  // conditionally true
 				default: status = STAT_MCODE_COMMAND_UNSUPPORTED;
 			}
@@ -365,7 +382,8 @@ static stat_t _parse_gcode_block(char *buf)
 
 			case 'T': SET_NON_MODAL (tool_select, (uint8_t)trunc(value));
 			case 'F': SET_NON_MODAL (feed_rate, value);
-			case 'P': SET_NON_MODAL (parameter, value);				// used for dwell time, G10 coord select
+			case 'P': SET_NON_MODAL (parameter, value);				// used for dwell time, G10 coord select, G5
+			case 'Q': SET_NON_MODAL (Q_word, value);				// used by G5
 			case 'S': SET_NON_MODAL (spindle_speed, value);
 			case 'X': SET_NON_MODAL (target[AXIS_X], value);
 			case 'Y': SET_NON_MODAL (target[AXIS_Y], value);
@@ -404,7 +422,7 @@ static stat_t _parse_gcode_block(char *buf)
  *		2. set feed rate mode (G93, G94 - inverse time or per minute)
  *		3. set feed rate (F)
  *		3a. set feed override rate (M50.1)
- *		3a. set traverse override rate (M50.2)
+ *		3a. set traverse override rate (M50.3)
  *		4. set spindle speed (S)
  *		4a. set spindle override rate (M51.1)
  *		5. select tool (T)
@@ -418,7 +436,7 @@ static stat_t _parse_gcode_block(char *buf)
  *		13. cutter radius compensation on or off (G40, G41, G42)
  *		14. cutter length compensation on or off (G43, G49)
  *		15. coordinate system selection (G54, G55, G56, G57, G58, G59)
- *		16. set path control mode (G61, G61.1, G64)
+ *		16. set path control mode (G61, G61.1, G64, G64 P)
  *		17. set distance mode (G90, G91)
  *		18. set retract mode (G98, G99)
  *		19a. homing functions (G28.2, G28.3, G28.1, G28, G30)
@@ -438,8 +456,8 @@ static stat_t _execute_gcode_block()
 	cm_set_model_linenum(cm.gn.linenum);
 	EXEC_FUNC(cm_set_feed_rate_mode, feed_rate_mode);
 	EXEC_FUNC(cm_set_feed_rate, feed_rate);
-//	EXEC_FUNC(cm_feed_rate_override_factor, feed_rate_override_factor);
-//	EXEC_FUNC(cm_traverse_override_factor, traverse_override_factor);
+	EXEC_FUNC(cm_feed_rate_override_factor, feed_rate_override_factor);
+	EXEC_FUNC(cm_traverse_override_factor, traverse_override_factor);
 	EXEC_FUNC(cm_set_spindle_speed, spindle_speed);
 //	EXEC_FUNC(cm_spindle_override_factor, spindle_override_factor);
 	EXEC_FUNC(cm_select_tool, tool_select);					// tool_select is where it's written
@@ -447,10 +465,10 @@ static stat_t _execute_gcode_block()
 	EXEC_FUNC(cm_spindle_control, spindle_control); 		// spindle CW, CCW, OFF
 	EXEC_FUNC(cm_mist_coolant_control, mist_coolant);
 	EXEC_FUNC(cm_flood_coolant_control, flood_coolant);		// also disables mist coolant if OFF
-//	EXEC_FUNC(cm_feed_rate_override_enable, feed_rate_override_enable);
-//	EXEC_FUNC(cm_traverse_override_enable, traverse_override_enable);
+	EXEC_FUNC(cm_feed_rate_override_enable, feed_rate_override_enable);
+	EXEC_FUNC(cm_traverse_override_enable, traverse_override_enable);
 //	EXEC_FUNC(cm_spindle_override_enable, spindle_override_enable);
-//	EXEC_FUNC(cm_override_enables, override_enables);
+	EXEC_FUNC(cm_override_enables, override_enables);
 
 	if (cm.gn.next_action == NEXT_ACTION_DWELL) { 			// G4 - dwell
 		ritorno(cm_dwell(cm.gn.parameter));					// return if error, otherwise complete the block
@@ -461,6 +479,9 @@ static stat_t _execute_gcode_block()
 	//--> cutter length compensation goes here
 	EXEC_FUNC(cm_set_coord_system, coord_system);
 	EXEC_FUNC(cm_set_path_control, path_control);
+	if ((cm.gf.path_control) && (cm.gn.path_control == PATH_CONTINUOUS)) {	// G64 P sets the blending tolerance
+		status = cm_set_path_tolerance(fp_TRUE(cm.gf.parameter) ? cm.gn.parameter : 0);
+	}
 	EXEC_FUNC(cm_set_distance_mode, distance_mode);
 	//--> set retract mode goes here
 
@@ -498,6 +519,16 @@ static stat_t _execute_gcode_block()
                                                                  cm.gn.motion_mode);
                                                                  break;
                                           }
+        		case MOTION_MODE_CUBIC_SPLINE:
+                case MOTION_MODE_QUADRATIC_SPLINE: { status = cm_spline_feed(cm.gn.target,
+                                                                             cm.gf.target,
+                                                                             cm.gn.arc_offset[0],
+                                                                             cm.gn.arc_offset[1],
+                                                                             cm.gn.parameter,
+                                                                             cm.gn.Q_word,
+                                                                             cm.gn.motion_mode);
+                                                                             break;
+                                                   }
     		}
             cm_set_absolute_override(MODEL, false);	 // un-set absolute override once the move is planned
 		}
@@ -44,6 +44,7 @@
 #include "config.h"
 #include "gpio.h"
 #include "stepper.h"
+#include "encoder.h"
 #include "hardware.h"
 #include "canonical_machine.h"
 #include "report.h"
@@ -146,6 +147,7 @@ void gpio_reset(void)
  * gpio_set_homing_mode()   - set/clear input to homing mode
  * gpio_set_probing_mode()  - set/clear input to probing mode
  * gpio_read_input()        - read conditioned input
+ * gpio_input_locked_out()  - true while an input is ignoring changes after its last one
  *
  (* Note: input_num_ext means EXTERNAL input number -- 1-based
  */
@@ -167,6 +169,12 @@ bool gpio_read_input(const uint8_t input_num_ext)
     return io.in[input_num_ext-1].state;
 }
 
+bool gpio_input_locked_out(const uint8_t input_num_ext)
+{
+    if (input_num_ext == 0) return false;
+    return (SysTickTimer.getValue() < io.in[input_num_ext-1].lockout_timer);
+}
+
 /*
  * pin change ISRs - ISR entry point for input pin changes
  *
@@ -236,10 +244,14 @@ void static _handle_pin_changed(const uint8_t input_num_ext, const int8_t pin_va
     // perform homing operations if in homing mode
     // We want either edge -- leading on home and trailing on backoff
     if (in->homing_mode) {
-        cm_start_hold();
+        en_latch_encoders();                    // the switch position, for the homing zero
+        cm_homing_input_changed(input_num_ext); // stop the axis (or just its motors in group homing)
         return;
     }
     if (in->probing_mode) {
+        if (in->edge == INPUT_EDGE_LEADING) {
+            en_latch_encoders();                // the trip position, before the hold carries past it
+        }
         cm_start_hold();
         return;
     }
@@ -127,6 +127,7 @@ void gpio_init(void);
 void gpio_reset(void);
 
 bool gpio_read_input(const uint8_t input_num);
+bool gpio_input_locked_out(const uint8_t input_num);
 void gpio_set_homing_mode(const uint8_t input_num, const bool is_homing);
 void gpio_set_probing_mode(const uint8_t input_num, const bool is_probing);
 
@@ -485,7 +485,7 @@ uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
             else if (nv->valuetype == TYPE_DATA)    {
 				uint32_t *v = (uint32_t*)&nv->value;
 //				str += (char_t)sprintf((char *)str, "\"0x%lx\"", *v);
-				str += sprintf(str, "\"0x%lx\"", *v);
+				str += sprintf(str, "\"0x%lx\"", (unsigned long)*v);
             }
 			else if (nv->valuetype == TYPE_BOOL) {
 				if (fp_FALSE(nv->value)) {
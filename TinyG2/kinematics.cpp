@@ -28,10 +28,53 @@
 #include "tinyg2.h"
 #include "config.h"
 #include "canonical_machine.h"
+#include "planner.h"
 #include "stepper.h"
 #include "kinematics.h"
+#include "text_parser.h"
+#include "util.h"
 
-static void _inverse_kinematics(const float travel[], float joint[]);
+static void _cartesian_inverse(const float travel[], float joint[]);
+static void _cartesian_forward(const float joint[], float travel[]);
+static void _corexy_inverse(const float travel[], float joint[]);
+static void _corexy_forward(const float joint[], float travel[]);
+static void _delta_inverse(const float travel[], float joint[]);
+static void _delta_forward(const float joint[], float travel[]);
+static void _scara_inverse(const float travel[], float joint[]);
+static void _scara_forward(const float joint[], float travel[]);
+
+kinConfig_t kin;							// kinematics configs
+
+/*
+ * The kinematics, indexed by kinType. The cycle counts are worked out from the soft
+ * float calls each one makes on the M3 (roughly 50-60 cycles for an add or multiply,
+ * 450 for sqrt(), 2500 for atan2()), plus about 400 for mapping six motors.
+ */
+static const kinKinematics_t kinematics[KINEMATICS_MAX_VALUE] = {
+	{ "cartesian", _cartesian_inverse, _cartesian_forward, true,  450 },
+	{ "corexy",    _corexy_inverse,    _corexy_forward,    true,  550 },
+	{ "delta",     _delta_inverse,     _delta_forward,     false, 3000 },
+	{ "scara",     _scara_inverse,     _scara_forward,     false, 8700 }
+};
+static const kinKinematics_t *_kinematics = &kinematics[KINEMATICS_CARTESIAN];
+
+static struct kinGeometry {					// derived from the configs by _set_kinematics()
+	float tower[3][2];						// delta tower X and Y
+	float arm_squared;						// delta arm length squared
+	float arm_sum_squared;					// SCARA inner^2 + outer^2
+	float arm_product_recip;				// 1 / (2 * inner * outer)
+} geo;
+
+// The axis to motor mapping is compiled into a gather table when the config changes
+// so the per-segment path doesn't have to search it. See ik_set_motor_map()
+
+typedef struct ikGather {
+	uint8_t motors;							// number of motors mapped to an axis
+	uint8_t motor[MOTORS];					// motor to set...
+	uint8_t axis[MOTORS];					// ...from this joint...
+	float steps_per_unit[MOTORS];			// ...times this (0 for an inhibited axis)
+} ikGather_t;
+static ikGather_t ik;
 
 /*
  * ik_kinematics() - wrapper routine for inverse kinematics
@@ -43,61 +86,294 @@ static void _inverse_kinematics(const float travel[], float joint[]);
  *	fractional DDA steps. The DDA deals with fractional step values as fixed-point binary in
  *	order to get the smoothest possible operation. Steps are passed to the move prep routine
  *	as floats and converted to fixed-point binary during queue loading. See stepper.c for details.
+ *
+ *	This is run during the _exec() portion of the cycle, once per interpolation segment.
+ *	The total time for the segment load, including the inverse kinematics transformation,
+ *	cannot exceed the segment time - see IK_SEGMENT_BUDGET.
+ *
+ *	Motors that are not mapped to an axis are left alone.
  */
 
 void ik_kinematics(const float travel[], float steps[])
 {
 	float joint[AXES];
 
-	_inverse_kinematics(travel, joint);				// insert inverse kinematics transformations here
-
-	// Map motors to axes and convert length units to steps
-	// Most of the conversion math has already been done in during config in steps_per_unit()
-	// which takes axis travel, step angle and microsteps into account.
-	for (uint8_t axis=0; axis<AXES; axis++) {
-		if (cm.a[axis].axis_mode == AXIS_INHIBITED) { joint[axis] = 0;}
-		if (st_cfg.mot[MOTOR_1].motor_map == axis) { steps[MOTOR_1] = joint[axis] * st_cfg.mot[MOTOR_1].steps_per_unit;}
-		if (st_cfg.mot[MOTOR_2].motor_map == axis) { steps[MOTOR_2] = joint[axis] * st_cfg.mot[MOTOR_2].steps_per_unit;}
-		if (st_cfg.mot[MOTOR_3].motor_map == axis) { steps[MOTOR_3] = joint[axis] * st_cfg.mot[MOTOR_3].steps_per_unit;}
-		if (st_cfg.mot[MOTOR_4].motor_map == axis) { steps[MOTOR_4] = joint[axis] * st_cfg.mot[MOTOR_4].steps_per_unit;}
-#if (MOTORS >= 5)
-		if (st_cfg.mot[MOTOR_5].motor_map == axis) { steps[MOTOR_5] = joint[axis] * st_cfg.mot[MOTOR_5].steps_per_unit;}
-#endif
-#if (MOTORS >= 6)
-		if (st_cfg.mot[MOTOR_6].motor_map == axis) { steps[MOTOR_6] = joint[axis] * st_cfg.mot[MOTOR_6].steps_per_unit;}
-#endif
+	_kinematics->inverse(travel, joint);
+	ik_joints_to_steps(joint, steps);
+}
+
+/*
+ * ik_joints_to_steps() - map joints to motors and convert length units to steps
+ *
+ *	Most of the conversion math has already been done in during config in steps_per_unit()
+ *	which takes axis travel, step angle and microsteps into account.
+ */
+
+void ik_joints_to_steps(const float joint[], float steps[])
+{
+	for (uint8_t i=0; i<ik.motors; i++) {
+		steps[ik.motor[i]] = joint[ik.axis[i]] * ik.steps_per_unit[i];
 	}
+}
 
-/* The above is a loop unrolled version of this:
-	for (uint8_t axis=0; axis<AXES; axis++) {
-		for (uint8_t motor=0; motor<MOTORS; motor++) {
-			if (st_cfg.mot[motor].motor_map == axis) {
-				steps[motor] = joint[axis] * st_cfg.mot[motor].steps_per_unit;
-			}
+/*
+ * ik_forward_kinematics() - the axis position a set of motor steps puts the machine at
+ *
+ *	travel[] comes in holding a position to take any joint from that no motor gives -
+ *	one with no motor mapped to it, or an inhibited axis. Pass the runtime position.
+ *	Where several motors drive one joint the lowest numbered one counts.
+ */
+
+void ik_forward_kinematics(const float steps[], float travel[])
+{
+	float joint[AXES];
+
+	_kinematics->inverse(travel, joint);
+	for (uint8_t i=ik.motors; i>0; i--) {
+		if (fp_NOT_ZERO(ik.steps_per_unit[i-1])) {
+			joint[ik.axis[i-1]] = steps[ik.motor[i-1]] / ik.steps_per_unit[i-1];
 		}
 	}
-*/
+	_kinematics->forward(joint, travel);
 }
 
 /*
- * _inverse_kinematics() - inverse kinematics - example is for a cartesian machine
+ * ik_set_motor_map() - compile the axis to motor gather table
  *
- *	You can glue in inverse kinematics here, but be aware of time budget constrants.
- *	This function is run during the _exec() portion of the cycle and will therefore
- *	be run once per interpolation segment. The total time for the segment load,
- *	including the inverse kinematics transformation cannot exceed the segment time,
- *	and ideally should be no more than 25-50% of the segment time. Currently segments
- *	run avery 5 ms, but this might be lowered. To profile this time look at the
- *	time it takes to complete the mp_exec_move() function.
+ *	Call this whenever a motor map ($1ma), axis mode ($xam) or motor steps per unit
+ *	(step angle, travel per rev, microsteps) changes. Inhibited axes are compiled in
+ *	with zero steps per unit, so their motors get zero steps.
+ */
+
+void ik_set_motor_map()
+{
+	ikGather_t gather;
+
+	gather.motors = 0;
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		uint8_t axis = st_cfg.mot[motor].motor_map;
+		if (axis >= AXES) { continue;}
+		gather.motor[gather.motors] = motor;
+		gather.axis[gather.motors] = axis;
+		gather.steps_per_unit[gather.motors] = (cm.a[axis].axis_mode == AXIS_INHIBITED) ? 0 : st_cfg.mot[motor].steps_per_unit;
+		gather.motors++;
+	}
+	uint32_t primask = __get_PRIMASK();				// the exec reads the table from an interrupt,
+	__disable_irq();								// so it mustn't see half a copy. Called from
+	ik = gather;									// stepper_init() before interrupts are up, so
+	__set_PRIMASK(primask);							// put the mask back rather than enabling them
+}
+
+/*
+ * ik_is_linear() 		- true if the selected kinematics maps lines to lines
+ * ik_get_kinematics() 	- a kinematics by kinType, for the benchmark
+ */
+
+bool ik_is_linear() { return (_kinematics->linear);}
+
+const kinKinematics_t *ik_get_kinematics(uint8_t type)
+{
+	return ((type < KINEMATICS_MAX_VALUE) ? &kinematics[type] : NULL);
+}
+
+/*
+ * Cartesian - joints are axes
  *
- *	Note: the compiler will  inline trivial functions (like memcpy) so there is no
+ *	Note: the compiler will inline trivial functions (like memcpy) so there is no
  *	size or performance penalty for breaking this out
  */
-static void _inverse_kinematics(const float travel[], float joint[])
+
+static void _cartesian_inverse(const float travel[], float joint[])
+{
+	memcpy(joint, travel, sizeof(float)*AXES);
+}
+
+static void _cartesian_forward(const float joint[], float travel[])
+{
+	memcpy(travel, joint, sizeof(float)*AXES);
+}
+
+/*
+ * CoreXY and H-bot - the two motors share the X and Y belts. Either motor alone moves
+ *	the head diagonally; both together move it along X (same way) or Y (opposite ways).
+ */
+
+static void _corexy_inverse(const float travel[], float joint[])
+{
+	memcpy(joint, travel, sizeof(float)*AXES);
+	joint[AXIS_X] = travel[AXIS_X] + travel[AXIS_Y];
+	joint[AXIS_Y] = travel[AXIS_X] - travel[AXIS_Y];
+}
+
+static void _corexy_forward(const float joint[], float travel[])
+{
+	memcpy(travel, joint, sizeof(float)*AXES);
+	travel[AXIS_X] = (joint[AXIS_X] + joint[AXIS_Y]) / 2;
+	travel[AXIS_Y] = (joint[AXIS_X] - joint[AXIS_Y]) / 2;
+}
+
+/*
+ * Linear delta - each carriage is an arm's length from the effector, so its height
+ *	over the effector follows from how far off its tower the effector is. A point out
+ *	of an arm's reach leaves the carriage level with the effector (soft limits are the
+ *	place to keep moves inside the reach).
+ */
+
+static void _delta_inverse(const float travel[], float joint[])
+{
+	memcpy(joint, travel, sizeof(float)*AXES);
+	for (uint8_t t=0; t<3; t++) {
+		float dx = travel[AXIS_X] - geo.tower[t][0];
+		float dy = travel[AXIS_Y] - geo.tower[t][1];
+		joint[t] = travel[AXIS_Z] + sqrt(max(geo.arm_squared - dx*dx - dy*dy, (float)0));
+	}
+}
+
+/*
+ *	Forward is the point an arm's length from all three carriages, below them. Taking
+ *	the first sphere's equation from the others leaves two planes; along their line
+ *	X and Y are linear in Z, which puts a quadratic in Z back in the first sphere.
+ *	This is done in double - it isn't run per segment and the squares lose too much.
+ */
+
+static void _delta_forward(const float joint[], float travel[])
+{
+	double x[3], y[3], z[3], a[2], b[2], c[2], d[2];
+
+	memcpy(travel, joint, sizeof(float)*AXES);
+	for (uint8_t t=0; t<3; t++) {
+		x[t] = geo.tower[t][0];
+		y[t] = geo.tower[t][1];
+		z[t] = joint[t];
+	}
+	for (uint8_t t=1; t<3; t++) {				// a.x + b.y + c.z = d
+		a[t-1] = 2*(x[t] - x[0]);
+		b[t-1] = 2*(y[t] - y[0]);
+		c[t-1] = 2*(z[t] - z[0]);
+		d[t-1] = (x[t]*x[t] + y[t]*y[t] + z[t]*z[t]) - (x[0]*x[0] + y[0]*y[0] + z[0]*z[0]);
+	}
+	double det = a[0]*b[1] - a[1]*b[0];			// non-zero as long as the towers aren't in a line
+	double ex = (d[0]*b[1] - d[1]*b[0]) / det;	// x = ex + fx.z
+	double fx = (c[1]*b[0] - c[0]*b[1]) / det;
+	double ey = (a[0]*d[1] - a[1]*d[0]) / det;	// y = ey + fy.z
+	double fy = (a[1]*c[0] - a[0]*c[1]) / det;
+
+	double gx = ex - x[0];
+	double gy = ey - y[0];
+	double qa = fx*fx + fy*fy + 1;
+	double qb = 2*(fx*gx + fy*gy - z[0]);
+	double qc = gx*gx + gy*gy + z[0]*z[0] - geo.arm_squared;
+	double qd = qb*qb - 4*qa*qc;
+	double zz = (-qb - sqrt(max(qd, 0.0))) / (2*qa);	// the lower root
+
+	travel[AXIS_X] = ex + fx*zz;
+	travel[AXIS_Y] = ey + fy*zz;
+	travel[AXIS_Z] = zz;
+}
+
+/*
+ * SCARA - the elbow angle is set by the shoulder to tool distance (law of cosines),
+ *	the shoulder angle is the tool's direction less the angle the bent arm makes with
+ *	it. A point out of reach leaves the arm pointing at it, straight or folded.
+ */
+
+static void _scara_inverse(const float travel[], float joint[])
+{
+	memcpy(joint, travel, sizeof(float)*AXES);
+	float c2 = (travel[AXIS_X]*travel[AXIS_X] + travel[AXIS_Y]*travel[AXIS_Y] - geo.arm_sum_squared) * geo.arm_product_recip;
+	c2 = min(max(c2, (float)-1), (float)1);
+	float s2 = sqrt(1 - c2*c2);
+	joint[AXIS_X] = (atan2(travel[AXIS_Y], travel[AXIS_X]) - atan2(kin.scara_outer * s2, kin.scara_inner + kin.scara_outer * c2)) * RADIAN;
+	joint[AXIS_Y] = atan2(s2, c2) * RADIAN;
+}
+
+static void _scara_forward(const float joint[], float travel[])
+{
+	float shoulder = joint[AXIS_X] / RADIAN;
+	float elbow = shoulder + joint[AXIS_Y] / RADIAN;
+
+	memcpy(travel, joint, sizeof(float)*AXES);
+	travel[AXIS_X] = kin.scara_inner * cos(shoulder) + kin.scara_outer * cos(elbow);
+	travel[AXIS_Y] = kin.scara_inner * sin(shoulder) + kin.scara_outer * sin(elbow);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * _set_kinematics() - select the kinematics and work out its geometry, then put the
+ *	motors' step counts where the new joints say the runtime position is. The machine
+ *	doesn't move, but every motor position is relative to the kinematics.
+ */
+
+static stat_t _set_kinematics()
 {
-	memcpy(joint, travel, sizeof(float)*AXES);		// just do a memcpy for Cartesian machines
+	static const float tower_angle[3] = { 210, 330, 90 };
+
+	for (uint8_t t=0; t<3; t++) {
+		geo.tower[t][0] = kin.delta_radius * cos(tower_angle[t] / RADIAN);
+		geo.tower[t][1] = kin.delta_radius * sin(tower_angle[t] / RADIAN);
+	}
+	geo.arm_squared = kin.delta_arm * kin.delta_arm;
+	geo.arm_sum_squared = kin.scara_inner * kin.scara_inner + kin.scara_outer * kin.scara_outer;
+	geo.arm_product_recip = 1 / (2 * kin.scara_inner * kin.scara_outer);
 
-//	for (uint8_t i=0; i<AXES; i++) {
-//		joint[i] = travel[i];
-//	}
+	_kinematics = &kinematics[kin.type];
+	mp_set_steps_to_runtime_position();
+	return (STAT_OK);
 }
+
+/*
+ * ik_set_kin() 		- set kinematics
+ * ik_set_geometry() 	- set a delta or SCARA length
+ *
+ *	Neither can change under a running move. The fixed-point exec steps lines only
+ *	(see _fx_init_section()), so it can't take a non-linear kinematics.
+ */
+
+stat_t ik_set_kin(nvObj_t *nv)
+{
+	if ((nv->value < 0) || (nv->value >= KINEMATICS_MAX_VALUE)) { return (STAT_INPUT_VALUE_UNSUPPORTED);}
+#ifdef __FIXED_POINT_EXEC
+	if (!kinematics[(uint8_t)nv->value].linear) { return (STAT_INPUT_VALUE_UNSUPPORTED);}
+#endif
+	if (mp_get_runtime_busy()) { return (STAT_COMMAND_NOT_ACCEPTED);}
+	set_ui8(nv);
+	return (_set_kinematics());
+}
+
+stat_t ik_set_geometry(nvObj_t *nv)
+{
+	if (nv->value <= 0) { return (STAT_INPUT_VALUE_RANGE_ERROR);}
+	if (mp_get_runtime_busy()) { return (STAT_COMMAND_NOT_ACCEPTED);}
+	set_flu(nv);
+	return (_set_kinematics());
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char msg_units0[] PROGMEM = " in";	// used by generic print functions
+static const char msg_units1[] PROGMEM = " mm";
+static const char msg_units2[] PROGMEM = " deg";
+static const char *const msg_units[] PROGMEM = { msg_units0, msg_units1, msg_units2 };
+
+static const char fmt_kin[] PROGMEM = "[kin] kinematics%18d [0=cartesian,1=corexy,2=delta,3=scara]\n";
+static const char fmt_kdr[] PROGMEM = "[kdr] delta radius%22.3f%s\n";
+static const char fmt_kdl[] PROGMEM = "[kdl] delta arm length%18.3f%s\n";
+static const char fmt_ksi[] PROGMEM = "[ksi] scara inner arm%19.3f%s\n";
+static const char fmt_kso[] PROGMEM = "[kso] scara outer arm%19.3f%s\n";
+
+void ik_print_kin(nvObj_t *nv) { text_print(nv, fmt_kin);}	// TYPE_INT
+void ik_print_kdr(nvObj_t *nv) { text_print_flt_units(nv, fmt_kdr, GET_UNITS(ACTIVE_MODEL));}
+void ik_print_kdl(nvObj_t *nv) { text_print_flt_units(nv, fmt_kdl, GET_UNITS(ACTIVE_MODEL));}
+void ik_print_ksi(nvObj_t *nv) { text_print_flt_units(nv, fmt_ksi, GET_UNITS(ACTIVE_MODEL));}
+void ik_print_kso(nvObj_t *nv) { text_print_flt_units(nv, fmt_kso, GET_UNITS(ACTIVE_MODEL));}
+
+#endif // __TEXT_MODE
@@ -28,11 +28,116 @@
 #ifndef KINEMATICS_H_ONCE
 #define KINEMATICS_H_ONCE
 
+/*
+ * Kinematics ($kin)
+ *
+ *	The kinematics turn a position in axis space (travel) into joint positions, one per
+ *	axis slot, which the motor map ($1ma...) then turns into motor steps. Axes a kinematics
+ *	doesn't use (e.g. Z and up on a CoreXY) pass through as they are.
+ *
+ *	KINEMATICS_CARTESIAN	joint = axis
+ *	KINEMATICS_COREXY		CoreXY or H-bot - joint X = X+Y, joint Y = X-Y (belt lengths)
+ *	KINEMATICS_DELTA		linear delta - joints X, Y and Z are the carriage heights on the
+ *							towers at 210, 330 and 90 degrees, $kdr from the center, with
+ *							arms $kdl long. Carriage heights are measured from the effector's
+ *							Z, so a carriage sits $kdl above it when the effector is under it
+ *	KINEMATICS_SCARA		two-arm SCARA with its shoulder at X0 Y0 - joint X is the
+ *							shoulder angle from +X and joint Y the elbow angle, in degrees.
+ *							Arms are $ksi (inner) and $kso (outer) long. The elbow always
+ *							bends the same way, and the joints jump where the tool crosses
+ *							the -X axis, so the work has to stay on one side of it. X0 Y0
+ *							is under the shoulder, where the arm folds up - set the position
+ *							there (G28.3) before the first move
+ *
+ *	Each kinematics publishes whether it is linear and what it costs. A linear kinematics
+ *	maps a straight line to a straight line in joint space, so the runtime can run constant
+ *	velocity sections in long segments (see MAX_SEGMENT_USEC). Non-linear ones get
+ *	NOM_SEGMENT_USEC segments throughout so the joints follow the curve. The cost is the
+ *	estimated Cortex-M3 cycles for one ik_kinematics() call (soft float), motor mapping
+ *	included - the runtime makes one call per segment. The host benchmark (-b) checks the
+ *	published and measured costs against IK_SEGMENT_BUDGET.
+ */
+
+typedef enum {
+	KINEMATICS_CARTESIAN = 0,
+	KINEMATICS_COREXY,
+	KINEMATICS_DELTA,
+	KINEMATICS_SCARA,
+	KINEMATICS_MAX_VALUE
+} kinType;
+
+typedef struct kinKinematics {
+	const char *name;
+	void (*inverse)(const float travel[], float joint[]);
+	void (*forward)(const float joint[], float travel[]);
+	bool linear;							// lines in axis space are lines in joint space
+	uint16_t cycles;						// published cost of one ik_kinematics() call
+} kinKinematics_t;
+
+typedef struct kinConfig {					// kinematics configs
+	uint8_t type;							// kinType
+	float delta_radius;						// tower to center distance
+	float delta_arm;						// arm (diagonal rod) length
+	float scara_inner;						// shoulder to elbow length
+	float scara_outer;						// elbow to tool length
+} kinConfig_t;
+extern kinConfig_t kin;
+
+/*
+ * IK_SEGMENT_BUDGET - the share of the shortest segment (MIN_SEGMENT_USEC) one
+ *	ik_kinematics() call may take on the target, leaving the rest for the runtime.
+ */
+#ifndef IK_SEGMENT_BUDGET
+#define IK_SEGMENT_BUDGET		((float)0.25)
+#endif
+
+#ifndef KINEMATICS
+#define KINEMATICS				KINEMATICS_CARTESIAN
+#endif
+#ifndef DELTA_RADIUS
+#define DELTA_RADIUS			105
+#endif
+#ifndef DELTA_ARM_LENGTH
+#define DELTA_ARM_LENGTH		215
+#endif
+#ifndef SCARA_INNER_ARM
+#define SCARA_INNER_ARM			150
+#endif
+#ifndef SCARA_OUTER_ARM
+#define SCARA_OUTER_ARM			150
+#endif
+
 /*
  * Global Scope Functions
  */
 
 void ik_kinematics(const float travel[], float steps[]);
+void ik_forward_kinematics(const float steps[], float travel[]);
+void ik_joints_to_steps(const float joint[], float steps[]);
+void ik_set_motor_map(void);
+bool ik_is_linear(void);
+const kinKinematics_t *ik_get_kinematics(uint8_t type);
+
+stat_t ik_set_kin(nvObj_t *nv);
+stat_t ik_set_geometry(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+	void ik_print_kin(nvObj_t *nv);
+	void ik_print_kdr(nvObj_t *nv);
+	void ik_print_kdl(nvObj_t *nv);
+	void ik_print_ksi(nvObj_t *nv);
+	void ik_print_kso(nvObj_t *nv);
+
+#else
+
+	#define ik_print_kin tx_print_stub
+	#define ik_print_kdr tx_print_stub
+	#define ik_print_kdl tx_print_stub
+	#define ik_print_ksi tx_print_stub
+	#define ik_print_kso tx_print_stub
+
+#endif // __TEXT_MODE
 
 #endif // End of include Guard: KINEMATICS_H_ONCE
 
@@ -46,7 +46,13 @@
 #include "UniqueId.h"
 #include "MotateTimers.h"
 using Motate::delay;
+#endif // __ARM
+
+#ifdef __HOST__
+#include "Simulation.h"
+#endif // __HOST__
 
+#if defined(__ARM) && !defined(__HOST__)
 /**************************
  *** C++ specific stuff ***
  **************************/
@@ -65,7 +71,7 @@ void __libc_init_array(void);
 
 void* __dso_handle = nullptr;
 
-#endif // __ARM
+#endif // __ARM && !__HOST__
 
 /******************** Application Code ************************/
 
@@ -105,9 +111,11 @@ MOTATE_SET_USB_SERIAL_NUMBER_STRING_FROM_CHIPID()
 void _system_init(void)
 {
 #ifdef __ARM
+#ifndef __HOST__
 	SystemInit();
 	WDT->WDT_MR = WDT_MR_WDDIS;     // Disable watchdog
 	__libc_init_array();            // Initialize C library
+#endif
     cacheUniqueId();                // Store the flash UUID
 	usb.attach();                   // USB setup
 	delay(1000);
@@ -164,6 +172,43 @@ void application_init_startup(void)
  * main()
  */
 
+#ifdef __HOST__
+/*
+ * _host_is_idle() - true once everything that was sent has been executed
+ */
+
+static bool _host_is_idle(void)
+{
+	return ((cm_get_machine_state() != MACHINE_CYCLE) &&
+			(mp_get_planner_buffers_available() == PLANNER_BUFFER_POOL_SIZE) &&
+			(!st_runtime_isbusy()));
+}
+
+int main(int argc, char *argv[])
+{
+	host_init(argc, argv);
+
+	// system initialization
+	_system_init();
+
+	// TinyG application setup
+	application_init_services();
+	application_init_machine();
+	application_init_startup();
+	run_canned_startup();			// run any pre-loaded commands
+
+	// main loop - runs until the input is used up and the machine has stopped
+	while (host_advance()) {
+		controller_run( );			// single pass through the controller
+		if (Motate::hostUSBInputIsAtEnd() && _host_is_idle()) {
+			break;
+		}
+	}
+	host_report();
+	return 0;
+}
+#else
+
 int main(void)
 {
 	// system initialization
@@ -181,6 +226,7 @@ int main(void)
 	}
 	return 0;
 }
+#endif // __HOST__
 
 /**** Status Messages ***************************************************************
  * get_status_message() - return the status message
@@ -394,7 +440,7 @@ static const char stat_177[] PROGMEM = "R word invalid";
 static const char stat_178[] PROGMEM = "T word missing";
 static const char stat_179[] PROGMEM = "T word invalid";
 
-static const char stat_180[] PROGMEM = "180";
+static const char stat_180[] PROGMEM = "Spline specification error";
 static const char stat_181[] PROGMEM = "181";
 static const char stat_182[] PROGMEM = "182";
 static const char stat_183[] PROGMEM = "183";
@@ -468,7 +514,7 @@ static const char stat_244[] PROGMEM = "Homing Err - Travel min & max are the sa
 static const char stat_245[] PROGMEM = "Homing Err - Negative latch backoff";
 static const char stat_246[] PROGMEM = "Homing Err - Homing input is misconfigured";
 static const char stat_247[] PROGMEM = "Homing Err - Must clear switches before homing";
-static const char stat_248[] PROGMEM = "248";
+static const char stat_248[] PROGMEM = "Homing Err - Switch not found";
 static const char stat_249[] PROGMEM = "249";
 
 static const char stat_250[] PROGMEM = "Probe cycle failed";
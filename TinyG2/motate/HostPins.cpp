@@ -0,0 +1,188 @@
+/*
+ HostPins.cpp - Library for the Arduino-compatible Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(__HOST__)
+
+#include <inttypes.h>
+#include "utility/HostPins.h"
+
+using namespace Motate;
+
+// Provided by the linker for any section named as a C identifier.
+extern _pinChangeInterrupt __start_motate_pin_change_interrupts __attribute__ ((weak));
+extern _pinChangeInterrupt __stop_motate_pin_change_interrupts __attribute__ ((weak));
+
+namespace Motate {
+
+    _hostPort _hostPorts[kHostPortCount];
+
+    static FILE *_pinTrace = NULL;
+
+    void hostSetPinTraceFile(FILE *trace) {
+        _pinTrace = trace;
+    }
+
+    uint32_t hostGetEdgeCount(const uint8_t portLetter, const uint8_t bit) {
+        return _hostPortFor(portLetter).edges[bit & 0x1f];
+    }
+
+    // Step/direction counters - what a driver would count, independent of what the firmware
+    // thinks its position is. Rising step edges count up with the direction pin low, down with it high.
+    static const uint8_t kHostStepCounterCount = 8;
+
+    static struct _hostStepCounter {
+        uint8_t stepPort, stepBit;
+        uint8_t dirPort, dirBit;
+        int32_t count;
+    } _stepCounters[kHostStepCounterCount];
+    static uint8_t _stepCountersUsed = 0;
+
+    void hostCountSteps(const uint8_t stepPortLetter, const uint8_t stepBit, const uint8_t dirPortLetter, const uint8_t dirBit) {
+        if (_stepCountersUsed < kHostStepCounterCount) {
+            _stepCounters[_stepCountersUsed++] = { stepPortLetter, stepBit, dirPortLetter, dirBit, 0 };
+        }
+    }
+
+    int32_t hostGetStepCount(const uint8_t stepPortLetter, const uint8_t stepBit) {
+        for (uint8_t i = 0; i < _stepCountersUsed; i++) {
+            if ((_stepCounters[i].stepPort == stepPortLetter) && (_stepCounters[i].stepBit == stepBit))
+                return _stepCounters[i].count;
+        }
+        return 0;
+    }
+
+    static void _countStep(const uint8_t portLetter, const uint8_t bit) {
+        for (uint8_t i = 0; i < _stepCountersUsed; i++) {
+            _hostStepCounter &counter = _stepCounters[i];
+            if ((counter.stepPort == portLetter) && (counter.stepBit == bit)) {
+                counter.count += ((_hostPortFor(counter.dirPort).output >> counter.dirBit) & 1) ? -1 : 1;
+            }
+        }
+    }
+
+    void _hostWriteOutputs(const uint8_t portLetter, const uintPort_t value, const uintPort_t mask) {
+        _hostPort &port = _hostPortFor(portLetter);
+        uintPort_t changed = (port.output ^ value) & mask;
+
+        port.output = (port.output & ~mask) | (value & mask);
+
+        for (uint8_t bit = 0; changed; bit++, changed >>= 1) {
+            if (!(changed & 1))
+                continue;
+            port.edges[bit]++;
+            if (_stepCountersUsed && ((port.output >> bit) & 1)) {
+                _countStep(portLetter, bit);
+            }
+            if (_pinTrace) {
+                fprintf(_pinTrace, "%" PRIu64 " %c%u %u\n", (uint64_t)hostGetTime(),
+                        portLetter, bit, (port.output >> bit) & 1);
+            }
+        }
+    }
+
+    void _hostSetPortInterrupts(const uint8_t portLetter, const uint32_t interrupts, const uintPort_t mask) {
+        _hostPort &port = _hostPortFor(portLetter);
+        const uint8_t irq = kHostIRQ_PIOA + (portLetter - 'A');
+
+        port.risingOnly &= ~mask;
+        port.fallingOnly &= ~mask;
+
+        if (interrupts != kPinInterruptsOff) {
+            if ((interrupts & kPinInterruptTypeMask) == kPinInterruptOnRisingEdge) {
+                port.risingOnly |= mask;
+            } else if ((interrupts & kPinInterruptTypeMask) == kPinInterruptOnFallingEdge) {
+                port.fallingOnly |= mask;
+            }
+            port.interruptEnabled |= mask;
+
+            _hostSetIRQPriorityFromOptions(irq, interrupts);
+            _hostEnableIRQ(irq, true);
+        } else {
+            port.interruptEnabled &= ~mask;
+            if (port.interruptEnabled == 0)
+                _hostEnableIRQ(irq, false);
+        }
+    }
+
+    // What the pin reads when nobody is driving it: pulled up pins read high.
+    void hostSetInputValue(const uint8_t portLetter, const uintPort_t mask, const bool value) {
+        _hostPort &port = _hostPortFor(portLetter);
+        uintPort_t old_input = port.input;
+
+        port.input = value ? (port.input | mask) : (port.input & ~mask);
+
+        uintPort_t changed = (old_input ^ port.input) & ~port.outputEnabled & port.interruptEnabled;
+        changed &= ~(port.risingOnly & ~port.input);    // rising-only pins ignore falling edges
+        changed &= ~(port.fallingOnly & port.input);    // .. and vice versa
+        if (changed) {
+            port.interruptStatus |= changed;
+            _hostSetPendingIRQ(kHostIRQ_PIOA + (portLetter - 'A'));
+        }
+    }
+
+    static void _dispatchPinChange(const uint8_t portLetter) {
+        _hostPort &port = _hostPortFor(portLetter);
+        uint32_t isr = port.interruptStatus;
+        port.interruptStatus = 0;
+
+        if (&__start_motate_pin_change_interrupts == NULL)
+            return;
+
+        _pinChangeInterrupt *current = &__start_motate_pin_change_interrupts;
+        while (current != &__stop_motate_pin_change_interrupts) {
+            if (current->portLetter == portLetter && isr & current->mask) {
+                current->interrupt();
+            }
+            current++;
+        }
+    }
+
+    static void _PIOA_Handler() { _dispatchPinChange('A'); }
+    static void _PIOB_Handler() { _dispatchPinChange('B'); }
+    static void _PIOC_Handler() { _dispatchPinChange('C'); }
+    static void _PIOD_Handler() { _dispatchPinChange('D'); }
+
+    // Until told otherwise, every pin floats high, and the PIO handlers are wired up.
+    struct _hostPortsInit {
+        _hostPortsInit() {
+            for (uint8_t i = 0; i < kHostPortCount; i++) {
+                _hostPorts[i].input = 0xffffffff;
+            }
+            _hostSetIRQHandler(kHostIRQ_PIOA + 0, _PIOA_Handler);
+            _hostSetIRQHandler(kHostIRQ_PIOA + 1, _PIOB_Handler);
+            _hostSetIRQHandler(kHostIRQ_PIOA + 2, _PIOC_Handler);
+            _hostSetIRQHandler(kHostIRQ_PIOA + 3, _PIOD_Handler);
+        };
+    };
+    static _hostPortsInit _portsInit __attribute__ ((init_priority (101)));
+
+} // namespace Motate
+
+#endif // __HOST__
@@ -0,0 +1,291 @@
+/*
+  HostTimers.cpp - Library for the Arduino-compatible Motate system
+  http://tinkerin.gs/
+
+  Copyright (c) 2015 Robert Giseburt
+
+	This file is part of the Motate Library.
+
+	This file ("the software") is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License, version 2 as published by the
+	Free Software Foundation. You should have received a copy of the GNU General Public
+	License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+	As a special exception, you may use this file as part of a software library without
+	restriction. Specifically, if other files instantiate templates or use macros or
+	inline functions from this file, or you compile this file and link it with  other
+	files to produce an executable, this file does not by itself cause the resulting
+	executable to be covered by the GNU General Public License. This exception does not
+	however invalidate any other reasons why the executable file might be covered by the
+	GNU General Public License.
+
+	THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+	WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+	SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+	OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#if defined(__HOST__)
+
+#include "utility/HostTimers.h"
+#include "Reset.h"
+
+uint32_t SystemCoreClock = 84000000;
+
+namespace Motate {
+
+	/*** Simulated NVIC ***/
+
+	_hostIRQ _hostIRQs[kHostIRQ_Count];
+	bool _hostInterruptsMasked = false;
+
+	static uint16_t _currentPriority = kHostThreadPriority;
+
+	void _hostSetIRQHandler(const uint8_t irq, void (*handler)()) {
+		_hostIRQs[irq].handler = handler;
+	}
+
+	void _hostSetIRQPriority(const uint8_t irq, const uint16_t priority) {
+		_hostIRQs[irq].priority = priority;
+	}
+
+	void _hostEnableIRQ(const uint8_t irq, const bool enable) {
+		_hostIRQs[irq].enabled = enable;
+		if (enable)
+			_hostServiceInterrupts();
+	}
+
+	void _hostSetPendingIRQ(const uint8_t irq) {
+		_hostIRQs[irq].pending = true;
+		_hostServiceInterrupts();
+	}
+
+	// Run every pending interrupt that is allowed to preempt what's running now,
+	// most urgent first. A handler that pends a lower priority IRQ will see it run
+	// after it returns -- as it would on the NVIC -- since we loop until none qualify.
+	void _hostServiceInterrupts() {
+		while (!_hostInterruptsMasked) {
+			int8_t next = -1;
+			for (uint8_t irq = 0; irq < kHostIRQ_Count; irq++) {
+				const _hostIRQ &i = _hostIRQs[irq];
+				if (i.pending && i.enabled && (i.priority < _currentPriority) &&
+					((next < 0) || (i.priority < _hostIRQs[next].priority))) {
+					next = irq;
+				}
+			}
+			if (next < 0)
+				return;
+
+			_hostIRQ &i = _hostIRQs[next];
+			i.pending = false;
+			i.count++;
+			if (i.handler) {
+				uint16_t previousPriority = _currentPriority;
+				_currentPriority = i.priority;
+				i.handler();
+				_currentPriority = previousPriority;
+			}
+		}
+	}
+
+	uint16_t hostGetCurrentPriority() {
+		return _currentPriority;
+	}
+
+	/*** Timers ***/
+
+	_hostTimer _hostTimers[kHostTimerCount];
+
+	static host_ticks_t _now = 0;
+
+	static inline host_ticks_t _period(const _hostTimer &t) {
+		return (host_ticks_t)(t.top ? t.top : 0xFFFF) * t.divisor;
+	}
+
+	static void _scheduleMatchA(_hostTimer &t) {
+		if (!t.running || t.ra == 0 || t.ra >= (t.top ? t.top : 0xFFFF)) {
+			t.next_match_a = 0;
+			return;
+		}
+		host_ticks_t period = _period(t);
+		host_ticks_t period_start = _now - ((_now - t.started) % period);
+		t.next_match_a = period_start + (host_ticks_t)t.ra * t.divisor;
+		if (t.next_match_a <= _now)
+			t.next_match_a += period;
+	}
+
+	int32_t _hostTimerSetModeAndFrequency(const uint8_t timerNum, const TimerMode mode, uint32_t freq) {
+		_hostTimer &t = _hostTimers[timerNum];
+
+		_hostTimerStop(timerNum);
+		_hostTimerSetInterrupts(timerNum, kInterruptsOff);
+		t.status = 0;
+		t.mode = mode;
+
+		if (mode == kTimerUpDownToMatch || mode == kTimerUpDown)
+			freq /= 2;
+
+		// Grab the SystemCoreClock value, in case it's volatile.
+		uint32_t masterClock = SystemCoreClock;
+
+		// Same divisor selection as the SAM TC: MCK/2, /8, /32, /128
+		const uint32_t divisors[4] = {2, 8, 32, 128};
+		t.divisor = 0;
+		for (uint8_t i = 0; i < 4; i++) {
+			if (freq > ((masterClock / divisors[i]) / 0x10000) && freq < (masterClock / divisors[i])) {
+				t.divisor = divisors[i];
+				break;
+			}
+		}
+		if (t.divisor == 0) {
+			// PUNT! For now, just guess TC1.
+			t.divisor = 2;
+			return kFrequencyUnattainable;
+		}
+
+		if (mode == kTimerInputCaptureToMatch
+			|| mode == kTimerUpToMatch
+			|| mode == kTimerUpDownToMatch) {
+
+			int32_t newTop = masterClock/(t.divisor*freq);
+			t.top = newTop;
+
+			// Determine and return the new frequency.
+			return masterClock/(t.divisor*newTop);
+		}
+
+		t.top = 0xFFFF;
+		return masterClock/(t.divisor*0xFFFF);
+	}
+
+	void _hostTimerSetInterrupts(const uint8_t timerNum, const uint32_t interrupts) {
+		_hostTimer &t = _hostTimers[timerNum];
+		t.interrupts = interrupts & (kInterruptOnMatchA | kInterruptOnMatchB | kInterruptOnOverflow);
+
+		if (interrupts != kInterruptsOff) {
+			_hostSetIRQPriorityFromOptions(kHostIRQ_TC0 + timerNum, interrupts);
+			_hostEnableIRQ(kHostIRQ_TC0 + timerNum, true);
+		} else {
+			_hostEnableIRQ(kHostIRQ_TC0 + timerNum, false);
+		}
+	}
+
+	void _hostTimerStart(const uint8_t timerNum) {
+		_hostTimer &t = _hostTimers[timerNum];
+		if (t.divisor == 0)
+			return;     // never configured, a software-triggered timer
+		t.running = true;
+		t.started = _now;
+		t.next_overflow = _now + _period(t);
+		_scheduleMatchA(t);
+	}
+
+	void _hostTimerStop(const uint8_t timerNum) {
+		_hostTimer &t = _hostTimers[timerNum];
+		t.running = false;
+		t.next_match_a = 0;
+		t.next_overflow = 0;
+	}
+
+	void _hostTimerSetRA(const uint8_t timerNum, const uint32_t ra) {
+		_hostTimer &t = _hostTimers[timerNum];
+		t.ra = ra;
+		_scheduleMatchA(t);
+	}
+
+	uint32_t _hostTimerGetValue(const uint8_t timerNum) {
+		_hostTimer &t = _hostTimers[timerNum];
+		if (!t.running)
+			return 0;
+		return ((_now - t.started) % _period(t)) / t.divisor;
+	}
+
+	/* System-wide tick counter */
+
+	Timer<SysTickTimerNum> SysTickTimer;
+
+	volatile uint32_t Timer<SysTickTimerNum>::_motateTickCount = 0;
+
+	static host_ticks_t _next_systick = 0;
+
+	static void _sysTickHandler() {
+		tickReset();
+
+		SysTickTimer._increment();
+
+		if (SysTickTimer.interrupt) {
+			SysTickTimer.interrupt();
+		}
+	}
+
+	/*** Virtual clock ***/
+
+	host_ticks_t hostGetTime() {
+		return _now;
+	}
+
+	// Find the next thing that's going to happen no later than 'until'.
+	// Ties go to the lowest numbered timer, overflow before match, and SysTick last.
+	void hostAdvanceTime(const host_ticks_t ticks) {
+		const host_ticks_t until = _now + ticks;
+
+		if (_next_systick == 0) {
+			_hostSetIRQHandler(kHostIRQ_SysTick, _sysTickHandler);
+			_hostSetIRQPriority(kHostIRQ_SysTick, 15);
+			_hostEnableIRQ(kHostIRQ_SysTick, true);
+			_next_systick = SystemCoreClock / 1000;
+		}
+
+		while (true) {
+			host_ticks_t when = until + 1;
+			int8_t which_timer = -1;
+			uint32_t what = 0;
+
+			for (uint8_t n = 0; n < kHostTimerCount; n++) {
+				_hostTimer &t = _hostTimers[n];
+				if (!t.running)
+					continue;
+				if (t.next_overflow && t.next_overflow < when) {
+					when = t.next_overflow;
+					which_timer = n;
+					what = kInterruptOnOverflow;
+				}
+				if (t.next_match_a && t.next_match_a < when) {
+					when = t.next_match_a;
+					which_timer = n;
+					what = kInterruptOnMatchA;
+				}
+			}
+
+			if (_next_systick < when) {
+				_now = _next_systick;
+				_next_systick += SystemCoreClock / 1000;
+				_hostSetPendingIRQ(kHostIRQ_SysTick);
+				continue;
+			}
+
+			if (which_timer < 0)
+				break;
+
+			_now = when;
+			_hostTimer &t = _hostTimers[which_timer];
+			if (what == kInterruptOnOverflow) {
+				t.next_overflow += _period(t);
+			} else {
+				t.next_match_a += _period(t);
+			}
+			t.status |= what;
+			if (t.interrupts & what) {
+				_hostSetPendingIRQ(kHostIRQ_TC0 + which_timer);
+			}
+		}
+
+		_now = until;
+	}
+
+} // namespace Motate
+
+#endif // __HOST__
@@ -0,0 +1,134 @@
+/*
+ HostUSB.cpp - Library for the Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(__HOST__)
+
+#include "MotateUSB.h"
+
+namespace Motate {
+	const uint16_t MOTATE_USBLanguageString[] = {0x0409}; // English
+	const uint16_t *getUSBLanguageString(int16_t &length) {
+        length = 2;
+		return MOTATE_USBLanguageString;
+	}
+
+	uint16_t checkEndpointSizeHardwareLimits(const uint16_t inSize, const uint8_t endpointNumber, const USBEndpointType_t endpointType, const bool otherSpeed) {
+		uint16_t tempSize = inSize;
+
+		if (endpointNumber == 0) {
+			if (tempSize > 64)
+				tempSize = 64;
+		} else if (tempSize > 1024) {
+			tempSize = 1024;
+		}
+
+		return tempSize;
+	};
+
+	uint32_t _inited = 0;
+	uint32_t _configuration = 0;
+
+	USBProxy_t USBProxy;
+
+	// The first CDC interface uses endpoints 1 (control), 2 (read) and 3 (write).
+	static const uint8_t kHostReadEndpoint = 2;
+	static const uint8_t kHostWriteEndpoint = 3;
+
+	static FILE *_input = NULL;
+	static FILE *_output = NULL;
+	static bool _inputAtEnd = false;
+
+	void hostSetUSBStreams(FILE *input, FILE *output) {
+		_input = input;
+		_output = output;
+		_inputAtEnd = false;
+	}
+
+	bool hostUSBInputIsAtEnd() {
+		return _inputAtEnd;
+	}
+
+	// Reading blocks on the stream, but virtual time stands still while it does.
+	int16_t _readByteFromEndpoint(const uint8_t endpoint) {
+		if (endpoint != kHostReadEndpoint || !_configuration || _inputAtEnd)
+			return -1;
+
+		int c = getc(_input ? _input : stdin);
+		if (c == EOF) {
+			_inputAtEnd = true;
+			return -1;
+		}
+		return c;
+	}
+
+	int16_t _readFromEndpoint(const uint8_t endpoint, uint8_t* data, int16_t len) {
+		int16_t count = 0;
+		while (count < len) {
+			int16_t c = _readByteFromEndpoint(endpoint);
+			if (c < 0)
+				break;
+			data[count++] = c;
+		}
+		return count;
+	}
+
+	int16_t _sendToEndpoint(const uint8_t endpoint, const uint8_t* data, int16_t length) {
+		if (endpoint != kHostWriteEndpoint)
+			return length;
+		return fwrite(data, 1, length, _output ? _output : stdout);
+	}
+
+	int32_t _getEndpointBufferCount(const uint8_t endpoint) {
+		return 0;
+	}
+
+	void _flushEndpoint(uint8_t endpoint) {
+		if (endpoint == kHostWriteEndpoint)
+			fflush(_output ? _output : stdout);
+	}
+
+	// There's no FIFO to drop -- everything not yet read is still on its way from the host.
+	void _flushReadEndpoint(uint8_t endpoint) {}
+
+	// Open the port on the first CDC interface: SET_CONTROL_LINE_STATE with DTR up.
+	void _hostConnect() {
+		Setup_t setup;
+		setup._bmRequestType = Setup_t::kRequestHostToDevice | Setup_t::kRequestClass | Setup_t::kRequestInterface;
+		setup._bRequest = 0x22; // kSetControlLineState
+		setup._wValueL = 0x01;  // DTR
+		setup._wValueH = 0;
+		setup._wIndex = 0;      // interface 0
+		setup._wLength = 0;
+		if (USBProxy.handleNonstandardRequest)
+			USBProxy.handleNonstandardRequest(setup);
+	}
+
+} // namespace Motate
+
+#endif // __HOST__
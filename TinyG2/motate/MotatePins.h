@@ -59,4 +59,8 @@ namespace Motate {
 #include <utility/SamPins.h>
 #endif
 
+#if defined(__HOST__)
+#include <utility/HostPins.h>
+#endif
+
 #endif /* end of include guard: MOTATEPINS_H_ONCE */
\ No newline at end of file
@@ -59,4 +59,8 @@ namespace Motate {
 #include <utility/SamSPI.h>
 #endif
 
+#if defined(__HOST__)
+#include <utility/HostSPI.h>
+#endif
+
 #endif /* end of include guard: MOTATESPI_H_ONCE */
\ No newline at end of file
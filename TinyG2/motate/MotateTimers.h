@@ -77,5 +77,9 @@ namespace Motate {
 #include <utility/SamTimers.h>
 #endif
 
+#if defined(__HOST__)
+#include <utility/HostTimers.h>
+#endif
+
 
 #endif /* end of include guard: MOTATETIMERS_H_ONCE */
\ No newline at end of file
@@ -49,6 +49,10 @@
 #include <utility/SamUSB.h>
 #endif
 
+#if defined(__HOST__)
+#include <utility/HostUSB.h>
+#endif
+
 namespace Motate {
 
 	/* ############################################ */
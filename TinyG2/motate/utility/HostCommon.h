@@ -0,0 +1,131 @@
+/*
+ utility/HostCommon.h - Library for the Arduino-compatible Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HOSTCOMMON_H_ONCE
+#define HOSTCOMMON_H_ONCE
+
+#include <inttypes.h>
+
+/****************************************
+ The host "chip" is a simulation of the SAM3X that runs as a normal process.
+
+ There is no real time here. All time is virtual and is counted in master clock
+ ticks (SystemCoreClock, 84MHz like the SAM3X8). Time only moves forward when
+ hostAdvanceTime() is called -- by delay() or by the main loop of the application.
+ While time is advanced every timer event that falls due is raised, in order, and
+ the interrupts are serviced as the NVIC would: highest priority first, and only
+ if it is higher than the priority of the code currently running.
+
+ Interrupt handlers run in zero virtual time. The application is expected to
+ charge each pass of its main loop to the clock, and that's the only cost model.
+ Given the same input the simulation is completely deterministic.
+****************************************/
+
+extern uint32_t SystemCoreClock;
+
+namespace Motate {
+
+    typedef uint64_t host_ticks_t;
+
+    // Simulated interrupt lines. Numbering is arbitrary but fixes the tie-breaking
+    // order for interrupts of equal priority (lowest number wins, as on the NVIC).
+    enum HostIRQn {
+        kHostIRQ_TC0 = 0,       // Timer<0> .. Timer<8> are kHostIRQ_TC0 + timerNum
+        kHostIRQ_PIOA = 9,      // PIO A .. D are kHostIRQ_PIOA + (portLetter - 'A')
+        kHostIRQ_SysTick = 13,
+        kHostIRQ_Count
+    };
+
+    // NVIC priorities run 0 (highest) .. 15 (lowest). Thread mode is below them all.
+    static const uint16_t kHostThreadPriority = 256;
+
+    struct _hostIRQ {
+        void (*handler)();
+        uint16_t priority;
+        bool enabled;
+        bool pending;
+        uint64_t count;         // times the handler has run
+    };
+
+    extern _hostIRQ _hostIRQs[kHostIRQ_Count];
+
+    void _hostSetIRQHandler(const uint8_t irq, void (*handler)());
+    void _hostSetIRQPriority(const uint8_t irq, const uint16_t priority);
+    void _hostEnableIRQ(const uint8_t irq, const bool enable);
+    void _hostSetPendingIRQ(const uint8_t irq);       // pends, and services if it's allowed to preempt
+    void _hostServiceInterrupts();
+
+    // Timers and pins both encode the priority as one of bits 5..9 of their interrupt
+    // options (Highest .. Lowest). Map that to the NVIC priority the SAM code would use.
+    static inline void _hostSetIRQPriorityFromOptions(const uint8_t irq, const uint32_t options) {
+        if (options & (1<<5)) {
+            _hostSetIRQPriority(irq, 0);
+        }
+        else if (options & (1<<6)) {
+            _hostSetIRQPriority(irq, 3);
+        }
+        else if (options & (1<<7)) {
+            _hostSetIRQPriority(irq, 7);
+        }
+        else if (options & (1<<8)) {
+            _hostSetIRQPriority(irq, 11);
+        }
+        else if (options & (1<<9)) {
+            _hostSetIRQPriority(irq, 15);
+        }
+    };
+
+    /*** Virtual clock ***/
+
+    host_ticks_t hostGetTime();                       // current virtual time in master clock ticks
+    void hostAdvanceTime(const host_ticks_t ticks);   // move forward, raising due events on the way
+    uint16_t hostGetCurrentPriority();                // the priority of the code currently executing
+
+    static inline host_ticks_t hostMicrosecondsToTicks(const uint64_t us) {
+        return (us * SystemCoreClock) / 1000000UL;
+    };
+
+    static inline uint64_t hostTicksToMicroseconds(const host_ticks_t ticks) {
+        return (ticks * 1000000UL) / SystemCoreClock;
+    };
+
+    /*** PRIMASK ***/
+
+    extern bool _hostInterruptsMasked;
+
+} // namespace Motate
+
+// Stand-ins for the CMSIS intrinsics the application uses directly.
+static inline void __disable_irq() { Motate::_hostInterruptsMasked = true; }
+static inline void __enable_irq() { Motate::_hostInterruptsMasked = false; Motate::_hostServiceInterrupts(); }
+static inline uint32_t __get_PRIMASK() { return (Motate::_hostInterruptsMasked ? 1 : 0); }
+static inline void __set_PRIMASK(uint32_t priMask) { if (priMask & 1) { __disable_irq(); } else { __enable_irq(); } }
+static inline void __NOP() { __asm__ __volatile__ ("nop"); }
+
+#endif /* end of include guard: HOSTCOMMON_H_ONCE */
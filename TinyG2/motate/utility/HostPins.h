@@ -0,0 +1,523 @@
+/*
+ utility/HostPins.h - Library for the Arduino-compatible Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HOSTPINS_H_ONCE
+#define HOSTPINS_H_ONCE
+
+#include <stdio.h>
+#include "HostCommon.h"
+
+#include <type_traits> // for std::enable_if
+
+/****************************************
+ Simulated pins. The pin numbering and port/bit assignments are the same as the SAM
+ boards (we use the same motate_pin_assignments.h), but each port is just a struct
+ in memory. Every output transition is counted per-bit and can optionally be traced
+ to a file with the virtual time it happened. Inputs can be driven from the outside
+ with hostSetInputValue(), which will fire pin change interrupts as the PIO would.
+****************************************/
+
+namespace Motate {
+    // Numbering is arbitrary:
+    enum PinMode {
+        kUnchanged      = 0,
+        kOutput         = 1,
+        kInput          = 2,
+        // These next two are NOT available on other platforms,
+        // but cannot be masked out since they are required for
+        // special pin functions. These should not be used in
+        // end-user (sketch) code.
+        kPeripheralA    = 3,
+        kPeripheralB    = 4,
+    };
+
+    // Numbering is arbitrary, but bit unique for bitwise operations (unlike other architectures):
+    enum PinOptions {
+        kNormal         = 0,
+        kTotem          = 0, // alias
+        kPullUp         = 1<<1,
+        kWiredAnd       = 1<<2,
+        kDriveLowOnly   = 1<<2, // alias
+        kWiredAndPull   = kWiredAnd|kPullUp,
+        kDriveLowPullUp = kDriveLowOnly|kPullUp, // alias
+        kDeglitch       = 1<<4,
+        kDebounce       = 1<<5,
+
+        // For use on PWM pins only!
+        kPWMPinInverted    = 1<<7,
+    };
+
+    enum PinInterruptOptions {
+        kPinInterruptsOff                = 0,
+
+        kPinInterruptOnChange            = 1,
+
+        kPinInterruptOnRisingEdge        = 1<<1,
+        kPinInterruptOnFallingEdge       = 2<<1,
+
+        kPinInterruptOnLowLevel          = 3<<1,
+        kPinInterruptOnHighLevel         = 4<<1,
+
+        kPinInterruptAdvancedMask        = ((1<<3)-1)<<1,
+
+        /* This turns the IRQ on, but doesn't set the timer to ever trigger it. */
+        kPinInterruptOnSoftwareTrigger   = 1<<4,
+
+        kPinInterruptTypeMask            = (1<<5)-1,
+
+        /* Set priority levels here as well: */
+        kPinInterruptPriorityHighest     = 1<<5,
+        kPinInterruptPriorityHigh        = 1<<6,
+        kPinInterruptPriorityMedium      = 1<<7,
+        kPinInterruptPriorityLow         = 1<<8,
+        kPinInterruptPriorityLowest      = 1<<9,
+
+        kPinInterruptPriorityMask        = ((1<<10) - (1<<5))
+    };
+
+    typedef uint32_t uintPort_t;
+
+    typedef const int8_t pin_number;
+
+    /*** Simulated PIO state ***/
+
+    static const uint8_t kHostPortCount = 4;   // A .. D
+
+    struct _hostPort {
+        uintPort_t output;          // ODSR - what we are driving
+        uintPort_t input;           // what the outside world is driving (pull-ups read as 1)
+        uintPort_t outputEnabled;   // OSR
+        uintPort_t pullUp;          // PUSR
+        uintPort_t options;         // bits that have any other options set (not modeled)
+        uintPort_t interruptEnabled;// IMR
+        uintPort_t risingOnly;      // edge select for "advanced" interrupts
+        uintPort_t fallingOnly;
+        uintPort_t interruptStatus; // ISR
+        uint32_t   edges[32];       // count of output transitions per bit
+    };
+
+    extern _hostPort _hostPorts[kHostPortCount];
+
+    static inline _hostPort &_hostPortFor(const uint8_t portLetter) {
+        return _hostPorts[(portLetter - 'A') & 0x03];
+    };
+
+    void _hostWriteOutputs(const uint8_t portLetter, const uintPort_t value, const uintPort_t mask);
+    void _hostSetPortInterrupts(const uint8_t portLetter, const uint32_t interrupts, const uintPort_t mask);
+
+    // Outside-world side of the pins
+    void hostSetInputValue(const uint8_t portLetter, const uintPort_t mask, const bool value);
+    uint32_t hostGetEdgeCount(const uint8_t portLetter, const uint8_t bit);
+    void hostCountSteps(const uint8_t stepPortLetter, const uint8_t stepBit, const uint8_t dirPortLetter, const uint8_t dirBit);
+    int32_t hostGetStepCount(const uint8_t stepPortLetter, const uint8_t stepBit);
+    void hostSetPinTraceFile(FILE *trace);
+
+    template <unsigned char portLetter>
+    struct Port32 {
+        static const uint8_t letter = 0; // NULL stub!
+
+        void setModes(const uintPort_t value, const uintPort_t mask = 0xffffffff) {
+            // stub
+        };
+        void setOptions(const uint16_t options, const uintPort_t mask) {
+            // stub
+        };
+        void getModes() {
+            // stub
+        };
+        void getOptions() {
+            // stub
+        };
+        void set(const uintPort_t value) {
+            // stub
+        };
+        void clear(const uintPort_t value) {
+            // stub
+        };
+        void write(const uintPort_t value) {
+            // stub
+        };
+        void write(const uintPort_t value, const uintPort_t mask) {
+            // stub
+        };
+        uintPort_t getInputValues(const uintPort_t mask = 0xffffffff) {
+            // stub
+            return 0;
+        };
+        uintPort_t getOutputValues(const uintPort_t mask = 0xffffffff) {
+            // stub
+            return 0;
+        };
+    };
+
+    template<int8_t pinNum>
+    struct Pin {
+        static const int8_t number = -1;
+        static const uint8_t portLetter = 0;
+        static const uint32_t mask = 0;
+
+        Pin() {};
+        Pin(const PinMode type, const PinOptions options = kNormal) {};
+        void operator=(const bool value) {};
+        operator bool() { return 0; };
+
+        void init(const PinMode type, const uint16_t options = kNormal, const bool fromConstructor=false) {};
+        void setMode(const PinMode type, const bool fromConstructor=false) {};
+        PinMode getMode() { return kUnchanged; };
+        void setOptions(const uint16_t options, const bool fromConstructor=false) {};
+        uint16_t getOptions() { return kNormal; };
+        void set() {};
+        void clear() {};
+        void write(const bool value) {};
+        void toggle() {};
+        uint8_t get() { return 0; };
+        uint8_t getInputValue() { return 0; };
+        uint8_t getOutputValue() { return 0; };
+        void setInterrupts(const uint32_t interrupts) {};
+        static uint32_t maskForPort(const uint8_t otherPortLetter) { return 0; };
+        bool isNull() { return true; };
+    };
+
+    template<uint8_t portChar, uint8_t portPin>
+    struct ReversePinLookup : Pin<-1> {
+        ReversePinLookup() {};
+        ReversePinLookup(const PinMode type, const PinOptions options = kNormal) : Pin<-1>(type, options) {};
+    };
+
+    template<int8_t pinNum>
+    struct InputPin : Pin<pinNum> {
+        InputPin() : Pin<pinNum>(kInput) {};
+        InputPin(const PinOptions options) : Pin<pinNum>(kInput, options) {};
+        void init(const PinOptions options = kNormal  ) {Pin<pinNum>::init(kInput, options);};
+        uint32_t get() {
+            return Pin<pinNum>::getInputValue();
+        };
+        /*Override these to pick up new methods */
+        operator bool() { return (get() != 0); };
+    private: /* Make these private to catch them early. These are intentionally not defined. */
+        void init(const PinMode type, const PinOptions options = kNormal);
+        void operator=(const bool value) { Pin<pinNum>::write(value); };
+        void write(const bool);
+    };
+
+    template<int8_t pinNum>
+    struct OutputPin : Pin<pinNum> {
+        OutputPin() : Pin<pinNum>(kOutput) {};
+        OutputPin(const PinOptions options) : Pin<pinNum>(kOutput, options) {};
+        void init(const PinOptions options = kNormal) {Pin<pinNum>::init(kOutput, options);};
+        uint32_t get() {
+            return Pin<pinNum>::getOutputValue();
+        };
+        void operator=(const bool value) { Pin<pinNum>::write(value); };
+        /*Override these to pick up new methods */
+        operator bool() { return (get() != 0); };
+    private: /* Make these private to catch them early. */
+        void init(const PinMode type, const PinOptions options = kNormal); /* Intentially not defined. */
+    };
+
+    // All of the pins on the SAM can be an interrupt pin, and so can all of ours.
+    template<int8_t pinNum>
+    struct IRQPin : Pin<pinNum> {
+        IRQPin() : Pin<pinNum>(kInput) {};
+        IRQPin(const PinOptions options) : Pin<pinNum>(kInput, options) {};
+        void init(const PinOptions options = kNormal  ) {Pin<pinNum>::init(kInput, options);};
+
+        static const bool is_real = true;
+        static void interrupt() __attribute__ (( weak ));
+    };
+
+    template<int8_t pinNum>
+    constexpr const bool IsIRQPin() { return IRQPin<pinNum>::is_real; };
+
+    template<pin_number gpioPinNumber>
+    using IsGPIOIRQOrNull = typename std::enable_if<true>::type;
+
+    template<uint8_t portChar, uint8_t portPin>
+    using LookupIRQPin = IRQPin< ReversePinLookup<portChar, portPin>::number >;
+
+
+    struct _pinChangeInterrupt {
+        const uint8_t portLetter;
+        const uint32_t mask;
+        void (&interrupt)();
+    };
+
+    // Same trick as the SAM: the trampolines are collected in a named section. Here the
+    // section name is a valid C identifier, so the (GNU) linker provides the
+    // __start_ and __stop_ symbols for us and we don't need a linker script.
+#define MOTATE_PIN_INTERRUPT_NAME_( x, y ) x##y
+#define MOTATE_PIN_INTERRUPT_NAME( x, y )\
+MOTATE_PIN_INTERRUPT_NAME_( x, y )
+
+#define MOTATE_PIN_INTERRUPT(number) \
+    Motate::_pinChangeInterrupt MOTATE_PIN_INTERRUPT_NAME( _Motate_PinChange_Interrupt_Trampoline, __COUNTER__ )\
+            __attribute__(( used, section("motate_pin_change_interrupts") )) {\
+        Motate::IRQPin<number>::portLetter,\
+        Motate::IRQPin<number>::mask,\
+        Motate::IRQPin<number>::interrupt\
+    };\
+    template<> void Motate::IRQPin<number>::interrupt()
+
+    #define _MAKE_MOTATE_PIN(pinNum, registerLetter, registerChar, registerPin)\
+        template<>\
+        struct Pin<pinNum> {\
+        private: /* Lock the copy contructor.*/\
+            Pin(const Pin<pinNum>&){};\
+        public:\
+            static const int8_t number = pinNum;\
+            static const uint8_t portLetter = (uint8_t) registerChar;\
+            static const uint32_t mask = (1u << registerPin);\
+            \
+            Pin() {};\
+            Pin(const PinMode type, const PinOptions options = kNormal) {\
+                init(type, options, /*fromConstructor=*/true);\
+            };\
+            void operator=(const bool value) { write(value); };\
+            operator bool() { return (get() != 0); };\
+            \
+            void init(const PinMode type, const uint16_t options = kNormal, const bool fromConstructor=false) {\
+                setMode(type, fromConstructor);\
+                setOptions(options, fromConstructor);\
+            };\
+            void setMode(const PinMode type, const bool fromConstructor=false) {\
+                switch (type) {\
+                    case kOutput:\
+                        _hostPortFor(portLetter).outputEnabled |= mask;\
+                        break;\
+                    case kInput:\
+                    case kPeripheralA:\
+                    case kPeripheralB:\
+                        _hostPortFor(portLetter).outputEnabled &= ~mask;\
+                        break;\
+                    default:\
+                        break;\
+                }\
+            };\
+            PinMode getMode() {\
+                return (_hostPortFor(portLetter).outputEnabled & mask) ? kOutput : kInput;\
+            };\
+            void setOptions(const uint16_t options, const bool fromConstructor=false) {\
+                if (kPullUp & options)\
+                    _hostPortFor(portLetter).pullUp |= mask;\
+                else\
+                    _hostPortFor(portLetter).pullUp &= ~mask;\
+                if (options & ~kPullUp)\
+                    _hostPortFor(portLetter).options |= mask;\
+                else\
+                    _hostPortFor(portLetter).options &= ~mask;\
+            };\
+            uint16_t getOptions() {\
+                return ((_hostPortFor(portLetter).pullUp & mask) ? kPullUp : 0);\
+            };\
+            void set() {\
+                _hostWriteOutputs(portLetter, mask, mask);\
+            };\
+            void clear() {\
+                _hostWriteOutputs(portLetter, 0, mask);\
+            };\
+            void write(const bool value) {\
+                if (!value)\
+                    clear();\
+                else\
+                    set();\
+            };\
+            void toggle()  {\
+                _hostWriteOutputs(portLetter, ~_hostPortFor(portLetter).output, mask);\
+            };\
+            uint32_t get() {\
+                return getInputValue();\
+            };\
+            uint32_t getInputValue() {\
+                const _hostPort &port = _hostPortFor(portLetter);\
+                return ((port.outputEnabled & mask) ? port.output : port.input) & mask;\
+            };\
+            uint32_t getOutputValue() {\
+                return _hostPortFor(portLetter).output & mask;\
+            };\
+            void setInterrupts(const uint32_t interrupts) {\
+                _hostSetPortInterrupts(portLetter, interrupts, mask);\
+            };\
+            bool isNull() { return false; };\
+            static uint32_t maskForPort(const uint8_t otherPortLetter) {\
+                return portLetter == otherPortLetter ? mask : 0x00u;\
+            };\
+            /* Placeholder for user code. */\
+            static void interrupt() __attribute__ ((weak));\
+        };\
+        typedef Pin<pinNum> Pin ## pinNum;\
+        static Pin ## pinNum pin ## pinNum;\
+        template<>\
+        struct ReversePinLookup<registerChar, registerPin> : Pin<pinNum> {\
+        ReversePinLookup() {};\
+        ReversePinLookup(const PinMode type, const PinOptions options = kNormal) : Pin<pinNum>(type, options) {};\
+        };\
+        template<> void Motate::IRQPin<pinNum>::interrupt();
+
+
+    static const uint32_t kDefaultPWMFrequency = 1000;
+    template<int8_t pinNum>
+    struct PWMOutputPin : Pin<pinNum> {
+        PWMOutputPin() : Pin<pinNum>(kOutput) {};
+        PWMOutputPin(const PinOptions options, const uint32_t freq = kDefaultPWMFrequency) : Pin<pinNum>(kOutput, options) {};
+        PWMOutputPin(const uint32_t freq) : Pin<pinNum>(kOutput, kNormal) {};
+        void setFrequency(const uint32_t freq) {};
+        void operator=(const float value) { write(value); };
+        void write(const float value) { Pin<pinNum>::write(value >= 0.5); };
+        bool canPWM() { return false; };
+
+        /*Override these to pick up new methods */
+
+    private: /* Make these private to catch them early. */
+        /* These are intentially not defined. */
+        void init(const PinMode type, const PinOptions options = kNormal);
+
+        /* WARNING: Covariant return types! */
+        bool get();
+        operator bool();
+    };
+
+    // A simulated PWM pin just remembers the frequency and duty cycle it was asked for.
+    // The timer named in the pin assignments is ignored -- it does not consume a Timer<>.
+    #define _MAKE_MOTATE_PWM_PIN(pinNum, timerOrPWM, channelAorB, peripheralAorB, invertedByDefault)\
+        template<>\
+        struct PWMOutputPin<pinNum> : Pin<pinNum> {\
+            uint32_t frequency;\
+            float duty_cycle;\
+            PWMOutputPin() : Pin<pinNum>(kPeripheral ## peripheralAorB), frequency(kDefaultPWMFrequency), duty_cycle(0) {};\
+            PWMOutputPin(const PinOptions options, const uint32_t freq = kDefaultPWMFrequency) :\
+                Pin<pinNum>(kPeripheral ## peripheralAorB, options), frequency(freq), duty_cycle(0) {};\
+            PWMOutputPin(const uint32_t freq) :\
+                Pin<pinNum>(kPeripheral ## peripheralAorB, kNormal), frequency(freq), duty_cycle(0) {};\
+            void setFrequency(const uint32_t freq) { frequency = freq; };\
+            void operator=(const float value) { write(value); };\
+            void write(const float value) { duty_cycle = value; };\
+            bool canPWM() { return true; };\
+            /*Override these to pick up new methods */\
+        private: /* Make these private to catch them early. */\
+            /* These are intentially not defined. */\
+            void init(const PinMode type, const PinOptions options = kNormal);\
+            /* WARNING: Covariant return types! */\
+            bool get();\
+            operator bool();\
+        };
+
+
+    template<int8_t pinNum>
+    struct SPIChipSelectPin {
+        SPIChipSelectPin() : Pin<pinNum>(kOutput) {};
+    private: /* Make these private to catch them early. */
+        /* WARNING: Covariant return types! */
+        bool get();
+        operator bool();
+    };
+
+    #define _MAKE_MOTATE_SPI_CS_PIN(pinNum, peripheralAorB, csNum)\
+        template<>\
+        struct SPIChipSelectPin<pinNum> : Pin<pinNum> {\
+            SPIChipSelectPin() : Pin<pinNum>(kPeripheral ## peripheralAorB) {};\
+            static const uint8_t moduleId = 0;\
+            static const uint8_t csOffset = csNum;\
+        private: /* Make these private to catch them early. */\
+            /* WARNING: Covariant return types! */\
+            bool get();\
+            operator bool();\
+        };
+
+
+    template<int8_t pinNum>
+    struct SPIOtherPin {
+        SPIOtherPin() : Pin<pinNum>(kOutput) {};
+    private: /* Make these private to catch them early. */
+        /* WARNING: Covariant return types! */
+        bool get();
+        operator bool();
+    };
+
+    #define _MAKE_MOTATE_SPI_OTHER_PIN(pinNum, peripheralAorB)\
+        template<>\
+        struct SPIOtherPin<pinNum> : Pin<pinNum> {\
+            SPIOtherPin() : Pin<pinNum>(kPeripheral ## peripheralAorB) {};\
+            static const uint16_t moduleId = 0;\
+        private: /* Make these private to catch them early. */\
+            /* WARNING: Covariant return types! */\
+            bool get();\
+            operator bool();\
+        };
+
+
+    #define _MAKE_MOTATE_PORT32(registerLetter, registerChar)\
+        template <>\
+        struct Port32<registerChar> {\
+            static const uint8_t letter = (uint8_t) registerChar;\
+            void setModes(const uintPort_t value, const uintPort_t mask) {\
+                _hostPortFor(letter).outputEnabled = (_hostPortFor(letter).outputEnabled & ~mask) | (value & mask);\
+            };\
+            void setOptions(const uint16_t options, const uintPort_t mask) {\
+                if (kPullUp & options)\
+                    _hostPortFor(letter).pullUp |= mask;\
+                else\
+                    _hostPortFor(letter).pullUp &= ~mask;\
+            };\
+            void set(const uintPort_t value) {\
+                _hostWriteOutputs(letter, value, value);\
+            };\
+            void clear(const uintPort_t value) {\
+                _hostWriteOutputs(letter, 0, value);\
+            };\
+            void write(const uintPort_t value) {\
+                _hostWriteOutputs(letter, value, 0xffffffff);\
+            };\
+            void write(const uintPort_t value, const uintPort_t mask) {\
+                _hostWriteOutputs(letter, value, mask);\
+            };\
+            uintPort_t getInputValues(const uintPort_t mask) {\
+                const _hostPort &port = _hostPortFor(letter);\
+                return ((port.output & port.outputEnabled) | (port.input & ~port.outputEnabled)) & mask;\
+            };\
+            uintPort_t getOutputValues(const uintPort_t mask) {\
+                return _hostPortFor(letter).output & mask;\
+            };\
+            void setInterrupts(const uint32_t interrupts, const uintPort_t mask) {\
+                _hostSetPortInterrupts(letter, interrupts, mask);\
+            };\
+        };\
+        typedef Port32<registerChar> Port ## registerLetter;\
+        static Port ## registerLetter port ## registerLetter __attribute__ ((unused));
+
+    typedef Pin<-1> NullPin;
+    static NullPin nullPin;
+
+} // end namespace Motate
+
+// Note: We end the namespace before including in case the included file need to include
+//   another Motate file. If it does include another Motate file, we end up with
+//   Motate::Motate::* definitions and weird compiler errors.
+#include <motate_pin_assignments.h>
+
+#endif /* end of include guard: HOSTPINS_H_ONCE */
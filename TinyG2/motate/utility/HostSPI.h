@@ -0,0 +1,101 @@
+/*
+ utility/HostSPI.h - Library for the Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HOSTSPI_H_ONCE
+#define HOSTSPI_H_ONCE
+
+#include "MotatePins.h"
+#include "HostCommon.h"
+
+namespace Motate {
+
+    // Nothing is connected to the host SPI bus: writes go nowhere and reads return zeros.
+
+    enum SPIMode {
+
+        kSPIPolarityNormal     = 0,
+        kSPIPolarityReversed   = 1<<0,
+
+        kSPIClockPhaseNormal   = 1<<1,
+        kSPIClockPhaseReversed = 0,
+
+        kSPIMode0              = kSPIPolarityNormal   | kSPIClockPhaseNormal,
+        kSPIMode1              = kSPIPolarityNormal   | kSPIClockPhaseReversed,
+        kSPIMode2              = kSPIPolarityReversed | kSPIClockPhaseNormal,
+        kSPIMode3              = kSPIPolarityReversed | kSPIClockPhaseReversed,
+
+        kSPI8Bit               = 0<<4,
+        kSPI9Bit               = 1<<4,
+        kSPI10Bit              = 2<<4,
+        kSPI11Bit              = 3<<4,
+        kSPI12Bit              = 4<<4,
+        kSPI13Bit              = 5<<4,
+        kSPI14Bit              = 6<<4,
+        kSPI15Bit              = 7<<4,
+        kSPI16Bit              = 8<<4
+	};
+
+    template<int8_t spiCSPinNumber, int8_t spiMISOPinNumber=kSPI_MISOPinNumber, int8_t spiMOSIPinNumber=kSPI_MOSIPinNumber, int8_t spiSCKSPinNumber=kSPI_SCKPinNumber>
+    struct SPI {
+        SPI(const uint32_t baud = 4000000, const uint16_t options = kSPI8Bit | kSPIMode0) : _options(options) {};
+
+        void init(const uint32_t baud, const uint16_t options, const bool fromConstructor=false) {
+            setOptions(baud, options, fromConstructor);
+        };
+
+        void setOptions(const uint32_t baud, const uint16_t options, const bool fromConstructor=false) {
+            _options = options;
+        };
+
+        bool setChannel() { return true; };
+
+        uint16_t getOptions() { return _options; };
+
+		int16_t read(const bool lastXfer = false, uint8_t toSendAsNoop = 0) { return 0; };
+
+		int16_t read(const uint8_t *buffer, const uint16_t length) { return length; };
+
+        int16_t write(uint16_t data, const bool lastXfer = false) { return 1; };
+
+        int16_t write(uint8_t data, int16_t &readValue, const bool lastXfer = false) {
+            readValue = 0;
+            return 1;
+        };
+
+        void flush() {};
+
+		int16_t write(const uint8_t *data, const uint16_t length, bool autoFlush = true) { return length; };
+
+    private:
+        uint16_t _options;
+    };
+
+}
+
+#endif /* end of include guard: HOSTSPI_H_ONCE */
@@ -0,0 +1,343 @@
+/*
+  utility/HostTimers.h - Library for the Arduino-compatible Motate system
+  http://tinkerin.gs/
+
+  Copyright (c) 2015 Robert Giseburt
+
+	This file is part of the Motate Library.
+
+	This file ("the software") is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License, version 2 as published by the
+	Free Software Foundation. You should have received a copy of the GNU General Public
+	License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+	As a special exception, you may use this file as part of a software library without
+	restriction. Specifically, if other files instantiate templates or use macros or
+	inline functions from this file, or you compile this file and link it with  other
+	files to produce an executable, this file does not by itself cause the resulting
+	executable to be covered by the GNU General Public License. This exception does not
+	however invalidate any other reasons why the executable file might be covered by the
+	GNU General Public License.
+
+	THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+	WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+	SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+	OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOSTTIMERS_H_ONCE
+#define HOSTTIMERS_H_ONCE
+
+#include "HostCommon.h"
+
+/* Host timers are simulations of the SAM TC channels, on the virtual clock.
+ *
+ * The interface is the same as SamTimers.h, and so is the math: the prescaler
+ * (2, 8, 32 or 128) and TOP are chosen exactly as the SAM would choose them, so
+ * the simulated interrupt rate has the same rounding as the real one.
+ *
+ * A running timer in kTimerUpToMatch raises Match A when the counter reaches RA
+ * and Overflow when it reaches TOP (RC), where it wraps. Other modes are treated
+ * as free-running up to TOP. Only the events that are enabled raise the IRQ, but
+ * all of them set the status, and getInterruptCause() reads-and-clears the status
+ * just as reading TC_SR does.
+ *
+ * PWMTimers are accepted but never run.
+ */
+
+namespace Motate {
+	enum TimerMode {
+		/* InputCapture mode (WAVE = 0) */
+		kTimerInputCapture         = 0,
+		/* InputCapture mode (WAVE = 0), counts up to RC */
+		kTimerInputCaptureToMatch  = 1,
+
+		/* Waveform select, Up to 0xFFFFFFFF */
+		kTimerUp            = 2,
+		/* Waveform select, Up to TOP (RC) */
+		kTimerUpToMatch     = 3,
+		/* For PWM, we'll alias kTimerUpToMatch as: */
+		kPWMLeftAligned     = kTimerUpToMatch,
+		/* Waveform select, Up to 0xFFFFFFFF, then Down */
+		kTimerUpDown        = 4,
+		/* Waveform select, Up to TOP (RC), then Down */
+		kTimerUpDownToMatch = 5,
+		/* For PWM, we'll alias kTimerUpDownToMatch as: */
+		kPWMCenterAligned     = kTimerUpDownToMatch,
+	};
+
+	/* The output options don't drive anything, but we keep the names. */
+	enum TimerChannelOutputOptions {
+		kOutputDisconnected = 0,
+
+		kToggleAOnCompareA  = 1<<0,
+		kClearAOnCompareA   = 1<<1,
+		kSetAOnCompareA     = 1<<2,
+
+		kToggleBOnCompareB  = 1<<3,
+		kClearBOnCompareB   = 1<<4,
+		kSetBOnCompareB     = 1<<5,
+
+		kToggleAOnMatch     = 1<<6,
+		kClearAOnMatch      = 1<<7,
+		kSetAOnMatch        = 1<<8,
+
+		kToggleBOnMatch     = 1<<9,
+		kClearBOnMatch      = 1<<10,
+		kSetBOnMatch        = 1<<11,
+
+		/* Aliases for use with PWM */
+		kPWMOnA             = kClearAOnCompareA | kSetAOnMatch,
+		kPWMOnAInverted     = kSetAOnCompareA | kClearAOnMatch,
+
+		kPWMOnB             = kClearBOnCompareB | kSetBOnMatch,
+		kPWMOnBInverted     = kSetBOnCompareB | kClearBOnMatch
+	};
+
+	enum TimerChannelInterruptOptions {
+		kInterruptsOff              = 0,
+        /* Alias for "off" to make more sense
+            when returned from setInterruptPending(). */
+		kInterruptUnknown           = 0,
+
+        kInterruptOnMatchA          = 1<<1,
+		kInterruptOnMatchB          = 1<<2,
+		/* Note: Interrupt on overflow could be a match C as well. */
+		kInterruptOnOverflow        = 1<<3,
+
+		/* This turns the IRQ on, but doesn't set the timer to ever trigger it. */
+		kInterruptOnSoftwareTrigger = 1<<4,
+
+		/* Set priority levels here as well: */
+		kInterruptPriorityHighest   = 1<<5,
+		kInterruptPriorityHigh      = 1<<6,
+		kInterruptPriorityMedium    = 1<<7,
+		kInterruptPriorityLow       = 1<<8,
+		kInterruptPriorityLowest    = 1<<9,
+	};
+
+	enum TimerErrorCodes {
+		kFrequencyUnattainable = -1,
+		kInvalidMode = -2,
+	};
+
+	enum PWMTimerClockOptions {
+		kPWMClockPrescalerOnly = 0,
+		kPWMClockPrescaleAndDivA = 1,
+		kPWMClockPrescaleAndDivB = 2,
+	};
+
+	typedef const uint8_t timer_number;
+
+	static const uint8_t kHostTimerCount = 9;
+
+	struct _hostTimer {
+		uint8_t mode;
+		uint32_t divisor;           // master clock ticks per count
+		uint32_t top;               // RC
+		uint32_t ra;
+		uint32_t rb;
+		uint32_t interrupts;        // enabled kInterruptOn* bits
+		uint32_t status;            // pending kInterruptOn* bits (TC_SR)
+		bool running;
+		host_ticks_t started;       // virtual time the counter was last at zero
+		host_ticks_t next_match_a;  // 0 = not scheduled
+		host_ticks_t next_overflow;
+	};
+
+	extern _hostTimer _hostTimers[kHostTimerCount];
+
+	// Implemented in HostTimers.cpp
+	int32_t _hostTimerSetModeAndFrequency(const uint8_t timerNum, const TimerMode mode, uint32_t freq);
+	void _hostTimerSetInterrupts(const uint8_t timerNum, const uint32_t interrupts);
+	void _hostTimerStart(const uint8_t timerNum);
+	void _hostTimerStop(const uint8_t timerNum);
+	void _hostTimerSetRA(const uint8_t timerNum, const uint32_t ra);
+	uint32_t _hostTimerGetValue(const uint8_t timerNum);
+
+	template <uint8_t timerNum>
+	struct Timer {
+
+		Timer() { init(); };
+		Timer(const TimerMode mode, const uint32_t freq) {
+			init();
+			setModeAndFrequency(mode, freq);
+		};
+
+		void init() {
+			_hostSetIRQHandler(kHostIRQ_TC0 + timerNum, interrupt);
+		}
+
+		void unlock() {};
+		void lock() {};
+
+		// Set the mode and frequency.
+		// Returns: The actual frequency that was used, or kFrequencyUnattainable
+		int32_t setModeAndFrequency(const TimerMode mode, uint32_t freq) {
+			return _hostTimerSetModeAndFrequency(timerNum, mode, freq);
+		};
+
+		// Set the TOP value for modes that use it.
+		void setTop(const uint32_t topValue) {
+			_hostTimers[timerNum].top = topValue;
+		};
+
+		uint32_t getTopValue() {
+			return _hostTimers[timerNum].top;
+		};
+
+		// Return the current value of the counter. This is a fleeting thing...
+		uint32_t getValue() {
+			return _hostTimerGetValue(timerNum);
+		}
+
+		void start() {
+			_hostTimerStart(timerNum);
+		};
+
+		void stop() {
+			_hostTimerStop(timerNum);
+		};
+
+		void stopOnMatch() {
+			// Not modeled.
+		};
+
+		// Specify the duty cycle as a value from 0.0 .. 1.0;
+		void setDutyCycleA(const float ratio) {
+			setExactDutyCycleA(getTopValue() * ratio);
+		};
+
+		void setDutyCycleB(const float ratio) {
+			setExactDutyCycleB(getTopValue() * ratio);
+		};
+
+		void setExactDutyCycleA(const uint32_t absolute) {
+			_hostTimerSetRA(timerNum, absolute);
+		};
+
+		void setExactDutyCycleB(const uint32_t absolute) {
+			_hostTimers[timerNum].rb = absolute;
+		};
+
+		void setOutputOptions(const uint32_t options) {};
+		void setOutputAOptions(const uint32_t options) {};
+		void setOutputBOptions(const uint32_t options) {};
+		void stopPWMOutputA() {};
+		void stopPWMOutputB() {};
+		void startPWMOutputA() {};
+		void startPWMOutputB() {};
+
+		void setInterrupts(const uint32_t interrupts) {
+			_hostTimerSetInterrupts(timerNum, interrupts);
+		}
+
+		void setInterruptPending() {
+			_hostSetPendingIRQ(kHostIRQ_TC0 + timerNum);
+		}
+
+		TimerChannelInterruptOptions getInterruptCause() {
+			uint32_t sr = _hostTimers[timerNum].status;
+			_hostTimers[timerNum].status = 0;
+
+			if (sr & kInterruptOnOverflow) {
+				return kInterruptOnOverflow;
+			}
+			else if (sr & kInterruptOnMatchA) {
+				return kInterruptOnMatchA;
+			}
+			else if (sr & kInterruptOnMatchB) {
+				return kInterruptOnMatchB;
+			}
+			return kInterruptUnknown;
+		}
+
+		// Placeholder for user code.
+		static void interrupt() __attribute__ ((weak));
+	};
+
+
+	template <uint8_t timerNum>
+	struct PWMTimer {
+
+		PWMTimer() {};
+		PWMTimer(const TimerMode mode, const uint32_t freq) : _top(0), _duty(0) {
+			setModeAndFrequency(mode, freq);
+		};
+
+		void init() {};
+		void unlock() {};
+		void lock() {};
+
+		int32_t setModeAndFrequency(const TimerMode mode, uint32_t frequency, const uint8_t clock = kPWMClockPrescalerOnly) {
+			if (mode == kTimerInputCapture || mode == kTimerInputCaptureToMatch)
+				return kFrequencyUnattainable;
+			_top = SystemCoreClock / frequency;
+			return SystemCoreClock / _top;
+		};
+
+		void setTop(const uint32_t topValue, bool setOnNext = true) { _top = topValue; };
+		uint32_t getTopValue() { return _top; };
+		uint32_t getValue() { return 0; }
+		void start() {};
+		void stop() {};
+		void setDutyCycleA(const float ratio, bool setOnNext = true) { _duty = _top * ratio; };
+		void setExactDutyCycleA(const uint32_t absolute, bool setOnNext = true) { _duty = absolute; };
+		void setOutputOptions(const uint32_t options) {};
+		void setOutputAOptions(const uint32_t options) {};
+		void stopPWMOutputA() {};
+		void startPWMOutputA() {};
+		void setInterrupts(const uint32_t interrupts) {};
+		void setInterruptPending() {};
+		TimerChannelInterruptOptions getInterruptCause() { return kInterruptUnknown; }
+
+		// Placeholder for user code.
+		static void interrupt() __attribute__ ((weak));
+
+	private:
+		uint32_t _top;
+		uint32_t _duty;
+	};
+
+	static const timer_number SysTickTimerNum = 0xFF;
+	template <>
+	struct Timer<SysTickTimerNum> {
+		static volatile uint32_t _motateTickCount;
+
+		Timer() { init(); };
+		Timer(const TimerMode mode, const uint32_t freq) {
+			init();
+		};
+
+		void init() {
+			_motateTickCount = 0;
+		};
+
+		// Return the current value of the counter. This is a fleeting thing...
+		uint32_t getValue() {
+			return _motateTickCount;
+		};
+
+		void _increment() {
+			_motateTickCount++;
+		};
+
+		// Placeholder for user code.
+		static void interrupt() __attribute__ ((weak));
+	};
+	extern Timer<SysTickTimerNum> SysTickTimer;
+
+	// Provide a Arduino-compatible blocking-delay function.
+	// There's nothing to wait for, so we just move the clock.
+	inline void delay( uint32_t milliseconds )
+	{
+		hostAdvanceTime((host_ticks_t)milliseconds * (SystemCoreClock / 1000));
+	}
+
+} // namespace Motate
+
+#define MOTATE_TIMER_INTERRUPT(number) template<> void Timer<number>::interrupt()
+
+#endif /* end of include guard: HOSTTIMERS_H_ONCE */
@@ -0,0 +1,292 @@
+/*
+ utility/HostUSB.h - Library for the Motate system
+ http://tinkerin.gs/
+
+ Copyright (c) 2015 Robert Giseburt
+
+ This file is part of the Motate Library.
+
+ This file ("the software") is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2 as published by the
+ Free Software Foundation. You should have received a copy of the GNU General Public
+ License, version 2 along with the software. If not, see <http://www.gnu.org/licenses/>.
+
+ As a special exception, you may use this file as part of a software library without
+ restriction. Specifically, if other files instantiate templates or use macros or
+ inline functions from this file, or you compile this file and link it with  other
+ files to produce an executable, this file does not by itself cause the resulting
+ executable to be covered by the GNU General Public License. This exception does not
+ however invalidate any other reasons why the executable file might be covered by the
+ GNU General Public License.
+
+ THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HOSTUSB_ONCE
+#define HOSTUSB_ONCE
+
+#include <stdio.h>
+#include "MotateUSBHelpers.h"
+#include "HostCommon.h"
+
+/* The host "USB" has no bus. The first CDC interface is connected to a pair of
+ * stdio streams: the read endpoint of interface 0 reads from the input stream
+ * (stdin by default) and its write endpoint writes to the output stream (stdout).
+ * Any other endpoints read nothing and swallow what is written to them.
+ *
+ * attach() enumerates at once, and the host "opens the port" by raising DTR on
+ * the first CDC interface -- exactly the request a real host would send.
+ */
+
+namespace Motate {
+
+	/*** ENDPOINT CONFIGURATION ***/
+
+	typedef uint32_t EndpointBufferSettings_t;
+
+	enum USBEndpointBufferSettingsFlags_t {
+		// null endpoint is all zeros
+		kEndpointBufferNull            = 0,
+
+		// endpoint direction
+		kEndpointBufferOutputFromHost  = 0,
+		kEndpointBufferInputToHost     = 1<<8,
+
+		// This mask is not part of the public interface:
+		kEndpointBufferDirectionMask   = 1<<8,
+
+		// buffer sizes
+		kEnpointBufferSizeUpTo8        = 0<<4,
+		kEnpointBufferSizeUpTo16       = 1<<4,
+		kEnpointBufferSizeUpTo32       = 2<<4,
+		kEnpointBufferSizeUpTo64       = 3<<4,
+		kEnpointBufferSizeUpTo128      = 4<<4,
+		kEnpointBufferSizeUpTo256      = 5<<4,
+		kEnpointBufferSizeUpTo512      = 6<<4,
+		kEnpointBufferSizeUpTo1024     = 7<<4,
+
+		// This mask is not part of the public interface:
+		kEnpointBufferSizeMask         = 7<<4,
+
+		// buffer "blocks" -- 2 == "ping pong"
+		// Note that there must be one, or this is a null endpoint.
+		kEndpointBufferBlocks1         = 0<<2,
+		kEndpointBufferBlocksUpTo2     = 1<<2,
+		kEndpointBufferBlocksUpTo3     = 2<<2,
+
+		// This mask is not part of the public interface:
+		kEndpointBufferBlocksMask      = 3<<2,
+
+		// endpoint types (mildly redundant from the config)
+		kEndpointBufferTypeControl     = 0<<11,
+		kEndpointBufferTypeIsochronous = 1<<11,
+		kEndpointBufferTypeBulk        = 2<<11,
+		kEndpointBufferTypeInterrupt   = 3<<11,
+
+		// This mask is not part of the public interface:
+		kEndpointBufferTypeMask        = 3<<11
+	};
+
+	// Convert from number to EndpointBufferSettings_t
+	// This should optimize out.
+	static const EndpointBufferSettings_t getBufferSizeFlags(const uint16_t size) {
+		if (size > 512) {
+			return kEnpointBufferSizeUpTo1024;
+		} else if (size > 128) {
+			return kEnpointBufferSizeUpTo512;
+		} else if (size > 64) {
+			return kEnpointBufferSizeUpTo128;
+		} else if (size > 32) {
+			return kEnpointBufferSizeUpTo64;
+		} else if (size > 16) {
+			return kEnpointBufferSizeUpTo32;
+		} else if (size > 8) {
+			return kEnpointBufferSizeUpTo16;
+		} else {
+			return kEnpointBufferSizeUpTo8;
+		}
+		return kEndpointBufferNull;
+	};
+
+	/*** PROXY ***/
+
+	struct USBProxy_t {
+		bool (*sendDescriptorOrConfig)(Setup_t &setup);
+		bool (*handleNonstandardRequest)(Setup_t &setup);
+		const uint8_t (*getEndpointCount)(uint8_t &firstEnpointNum);
+		uint16_t (*getEndpointSize)(const uint8_t &endpointNum, const bool otherSpeed);
+		const EndpointBufferSettings_t (*getEndpointConfig)(const uint8_t endpoint, const bool otherSpeed);
+	};
+	extern USBProxy_t USBProxy;
+
+
+	/*** STRINGS ***/
+
+	const uint16_t *getUSBVendorString(int16_t &length) ATTR_WEAK;
+	const uint16_t *getUSBProductString(int16_t &length) ATTR_WEAK;
+	const uint16_t *getUSBSerialNumberString(int16_t &length) ATTR_WEAK;
+
+#define MOTATE_SET_USB_VENDOR_STRING(...)\
+	const uint16_t MOTATE_USBVendorString[] = __VA_ARGS__;\
+	const uint16_t *Motate::getUSBVendorString(int16_t &length) {\
+		length = sizeof(MOTATE_USBVendorString);\
+		return MOTATE_USBVendorString;\
+	}
+
+#define MOTATE_SET_USB_PRODUCT_STRING(...)\
+	const uint16_t MOTATE_USBProductString[] = __VA_ARGS__;\
+	const uint16_t *Motate::getUSBProductString(int16_t &length) {\
+		length = sizeof(MOTATE_USBProductString);\
+		return MOTATE_USBProductString;\
+	}
+
+#define MOTATE_SET_USB_SERIAL_NUMBER_STRING(...)\
+    const uint16_t MOTATE_USBSerialNumberString[] = __VA_ARGS__;\
+    const uint16_t *Motate::getUSBSerialNumberString(int16_t &length) {\
+        length = sizeof(MOTATE_USBSerialNumberString);\
+        return MOTATE_USBSerialNumberString;\
+    }
+
+#define MOTATE_SET_USB_SERIAL_NUMBER_STRING_FROM_CHIPID()\
+    const uint16_t *Motate::getUSBSerialNumberString(int16_t &length) {\
+        const uint16_t *uuid = readUniqueIdString();\
+        length = UNIQUE_ID_STRING_LEN * sizeof(uint16_t);\
+        return uuid;\
+    }
+
+	const uint16_t *getUSBLanguageString(int16_t &length);
+
+
+	/*** Host side of the "bus" ***/
+
+	void hostSetUSBStreams(FILE *input, FILE *output);
+	bool hostUSBInputIsAtEnd();
+
+
+	/*** USBDeviceHardware ***/
+
+	extern int16_t _readByteFromEndpoint(const uint8_t endpoint);
+	extern int16_t _readFromEndpoint(const uint8_t endpoint, uint8_t* data, int16_t len);
+	extern int16_t _sendToEndpoint(const uint8_t endpoint, const uint8_t* data, int16_t length);
+	extern int32_t _getEndpointBufferCount(const uint8_t endpoint);
+	extern void _flushEndpoint(uint8_t endpoint);
+	extern void _flushReadEndpoint(uint8_t endpoint);
+	extern void _hostConnect();
+
+	extern uint32_t _inited;
+	extern uint32_t _configuration;
+
+	// USBDeviceHardware marshalls data between the interfaces and the stdio streams.
+	template< typename parent >
+	class USBDeviceHardware
+	{
+		parent* const parent_this;
+
+	public:
+
+		static const uint8_t master_control_endpoint = 0;
+
+		// Init
+		USBDeviceHardware() : parent_this(static_cast< parent* >(this))
+		{
+			USBProxy.sendDescriptorOrConfig   = parent::sendDescriptorOrConfig;
+			USBProxy.handleNonstandardRequest = parent::handleNonstandardRequest;
+			USBProxy.getEndpointConfig        = parent::getEndpointConfig;
+			USBProxy.getEndpointCount         = parent::getEndpointCount;
+			USBProxy.getEndpointSize          = parent::getEndpointSize;
+
+			_inited = 1UL;
+			_configuration = 0UL;
+		};
+
+		static bool attach() {
+			if (_inited) {
+				_configuration = 1;
+				_hostConnect();
+				return true;
+			}
+			return false;
+		};
+
+		static bool detach() {
+			if (_inited) {
+				_configuration = 0;
+				return true;
+			}
+			return false;
+		};
+
+		static int16_t availableToRead(const uint8_t endpoint) {
+			return _getEndpointBufferCount(endpoint);
+		}
+
+		static int16_t readByte(const uint8_t endpoint) {
+			return _readByteFromEndpoint(endpoint);
+		};
+
+		/* Data is const. The pointer to data is not. */
+		static int16_t read(const uint8_t endpoint, uint8_t *buffer, int16_t length) {
+			if (!_configuration || length < 0)
+				return -1;
+			return _readFromEndpoint(endpoint, buffer, length);
+		};
+
+		/* Data is const. The pointer to data is not. */
+		static int16_t write(const uint8_t endpoint, const uint8_t * buffer, int16_t length) {
+			if (!_configuration || length < 0)
+				return -1;
+
+			return _sendToEndpoint(endpoint, buffer, length);
+		};
+
+		static void flush(const uint8_t endpoint) {
+			_flushEndpoint(endpoint);
+		};
+
+        static void flushRead(const uint8_t endpoint) {
+            _flushReadEndpoint(endpoint);
+        }
+
+		// There's no control traffic beyond what _hostConnect() fakes, so there's never anything to read.
+		static int16_t readFromControl(const uint8_t endpoint, uint8_t *buffer, int16_t length) {
+			if (!_configuration || length < 0)
+				return -1;
+			return length;
+		};
+
+		static int16_t writeToControl(const uint8_t endpoint, const uint8_t *buffer, int16_t length) {
+            return length;
+		};
+
+		static void sendString(const uint8_t stringNum, int16_t maxLength) {};
+
+        static const USBDeviceSpeed_t getDeviceSpeed() {
+            return kUSBDeviceHighSpeed;
+        }
+
+		static uint16_t getEndpointSizeFromHardware(const uint8_t &endpoint, const bool otherSpeed) {
+			if (endpoint == 0) {
+				return 64;
+			}
+
+            // Indicate that we didn't set one...
+			return 0;
+		};
+
+		static const EndpointBufferSettings_t getEndpointConfigFromHardware(const uint8_t endpoint) {
+			if (endpoint == 0)
+			{
+				return getBufferSizeFlags(getEndpointSizeFromHardware(endpoint, false)) | kEndpointBufferBlocks1 | kEndpointBufferTypeControl;
+			}
+			return kEndpointBufferNull;
+		};
+	}; //class USBDeviceHardware
+}
+
+#endif
+//HOSTUSB_ONCE
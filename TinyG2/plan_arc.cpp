@@ -60,8 +60,11 @@ void cm_arc_init()
 /*
  * cm_arc_feed() - canonical machine entry point for arc
  *
- * Generates an arc by queuing line segments to the move buffer. The arc is
- * approximated by generating a large number of tiny, linear segments.
+ * Queues the arc as a single MOVE_TYPE_ARC planner block (see mp_arc()). The runtime
+ * interpolates it at segment rate, so a full circle takes one buffer.
+ *
+ * The fixed-point exec (__FIXED_POINT_EXEC) only runs straight lines, so there the arc
+ * is approximated by a large number of tiny, linear segments queued from the callback.
  */
 
 stat_t cm_arc_feed(const float target[], const float flags[],   // arc endpoints
@@ -181,9 +184,23 @@ stat_t cm_arc_feed(float target[], float flags[],   // arc endpoints
 	}
 
 	cm_cycle_start();						// if not already started
+#ifdef __FIXED_POINT_EXEC
+	mp_arc_rotation_init(&arc.rotation, arc.theta, arc.radius);
+	mp_arc_set_step(&arc.rotation, arc.segment_theta);
 	arc.run_state = MOVE_RUN;				// enable arc to be run from the callback
+#else
+	mpArcMove_t arc_move = { arc.center_0, arc.center_1, arc.radius, arc.theta, arc.angular_travel,
+							 arc.plane_axis_0, arc.plane_axis_1 };
+	copy_vector(arc.gm.target, cm.gm.target);	// _compute_arc() set up the linear axis for chords
+	arc.gm.move_time = arc.time;
+	status = mp_arc(&arc.gm, &arc_move);
+#endif
 	cm_finalize_move();
-	return (STAT_OK);
+	if (status == STAT_MINIMUM_LENGTH_MOVE && !mp_has_runnable_buffer()) {	// same as cm_straight_feed()
+		cm_cycle_end();
+		return (STAT_OK);
+	}
+	return (status);
 }
 
 /*
@@ -203,8 +220,13 @@ stat_t cm_arc_callback()
         return (STAT_EAGAIN);
     }
 	arc.theta += arc.segment_theta;
-	arc.gm.target[arc.plane_axis_0] = arc.center_0 + sin(arc.theta) * arc.radius;
-	arc.gm.target[arc.plane_axis_1] = arc.center_1 + cos(arc.theta) * arc.radius;
+	if (arc.segment_count > 1) {
+		mp_arc_rotate(&arc.rotation, arc.theta);
+	} else {
+		mp_arc_rotation_sync(&arc.rotation, arc.theta);	// the last chord ends exactly on the end angle
+	}
+	arc.gm.target[arc.plane_axis_0] = arc.center_0 + arc.rotation.sin_theta * arc.radius;
+	arc.gm.target[arc.plane_axis_1] = arc.center_1 + arc.rotation.cos_theta * arc.radius;
 	arc.gm.target[arc.linear_axis] += arc.segment_linear_travel;
 	mp_aline(&arc.gm);								// run the line
 	copy_vector(arc.position, arc.gm.target);		// update arc current position
@@ -216,6 +238,118 @@ stat_t cm_arc_callback()
 	return (STAT_OK);
 }
 
+/*
+ * mp_get_arc_point() - position a fraction of the way along a MOVE_TYPE_ARC block
+ * mp_set_arc_unit()  - set the plane axes of the unit vector there
+ *
+ *	The plane axes are on the circle at the angle that far round; all the others are the
+ *	same fraction of the way from start to end. mp_set_arc_unit() leaves the other axes of
+ *	unit[] alone - along a helix their part of the unit vector is the same all the way.
+ */
+
+static void _set_arc_point(const mpArcMove_t *arc_move, const float start[], const float end[], const float fraction,
+						   const float sin_theta, const float cos_theta, float point[])
+{
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		point[axis] = start[axis] + (end[axis] - start[axis]) * fraction;
+	}
+	point[arc_move->plane_axis_0] = arc_move->center_0 + sin_theta * arc_move->radius;
+	point[arc_move->plane_axis_1] = arc_move->center_1 + cos_theta * arc_move->radius;
+}
+
+void mp_get_arc_point(const mpArcMove_t *arc_move, const float start[], const float end[], const float fraction, float point[])
+{
+	float theta = arc_move->theta + arc_move->angular_travel * fraction;
+	_set_arc_point(arc_move, start, end, fraction, sin(theta), cos(theta), point);
+}
+
+/*
+ * mp_next_arc_point() - mp_get_arc_point() for the next of a run of points
+ *
+ *	rot is at the previous point, 'step' radians back round the arc from this one. It's
+ *	rotated on to this point rather than taking the sine and cosine all over again.
+ */
+
+void mp_next_arc_point(const mpArcMove_t *arc_move, mpArcRotation_t *rot, const float start[], const float end[],
+					   const float fraction, const float step, float point[])
+{
+	mp_arc_set_step(rot, step);					// the step changes with the segment velocity anyway
+	mp_arc_rotate(rot, arc_move->theta + arc_move->angular_travel * fraction);
+	_set_arc_point(arc_move, start, end, fraction, rot->sin_theta, rot->cos_theta, point);
+	BENCH(bench_arc_point(arc_move, start, end, fraction, point));
+}
+
+/*
+ * mp_arc_rotation_init() - start walking an arc of this radius from angle theta
+ * mp_arc_set_step()	  - set the angle each rotation turns through
+ * mp_arc_rotate()		  - rotate one step on, to angle theta
+ * mp_arc_rotation_sync() - take the sine and cosine of theta exactly
+ *
+ *	Each point round an arc is the previous one rotated through the step angle:
+ *
+ *		sin(theta + step) = sin(theta) * cos(step) + cos(theta) * sin(step)
+ *		cos(theta + step) = cos(theta) * cos(step) - sin(theta) * sin(step)
+ *
+ *	That's four multiplies, where sin() and cos() are long runs of soft float on the ARM.
+ *	A step's own sine and cosine come from the first terms of their series when it's small
+ *	(the error there is under step^7/5040), so a step that changes every time costs a few
+ *	multiplies more. The caller still passes the angle each point is really at.
+ *
+ *	Each rotation rounds, and the rounding adds up - up to ARC_ROTATION_DRIFT of the radius
+ *	each time. So every 'resync' rotations the sine and cosine are taken exactly from that
+ *	angle, as often as it takes to keep the drift inside the chordal tolerance, and never
+ *	less often than ARC_RESYNC_MAX. The drift is over by then; it doesn't carry on.
+ */
+
+void mp_arc_rotation_init(mpArcRotation_t *rot, const float theta, const float radius)
+{
+	float resync = cm.chordal_tolerance / (radius * ARC_ROTATION_DRIFT);
+	rot->resync = (resync < 1) ? 1 : ((resync > ARC_RESYNC_MAX) ? ARC_RESYNC_MAX : (uint16_t)resync);
+	rot->step = 0;
+	rot->sin_step = 0;
+	rot->cos_step = 1;
+	mp_arc_rotation_sync(rot, theta);
+}
+
+void mp_arc_set_step(mpArcRotation_t *rot, const float step)
+{
+	rot->step = step;
+	if (fabs(step) < ARC_SERIES_ANGLE) {
+		float step_2 = step * step;
+		rot->sin_step = step * (1 - step_2/6 * (1 - step_2/20));
+		rot->cos_step = 1 - step_2/2 * (1 - step_2/12 * (1 - step_2/30));
+	} else {
+		rot->sin_step = sin(step);
+		rot->cos_step = cos(step);
+	}
+}
+
+void mp_arc_rotate(mpArcRotation_t *rot, const float theta)
+{
+	if (--rot->count == 0) {
+		mp_arc_rotation_sync(rot, theta);
+		return;
+	}
+	float sin_theta = rot->sin_theta * rot->cos_step + rot->cos_theta * rot->sin_step;
+	rot->cos_theta = rot->cos_theta * rot->cos_step - rot->sin_theta * rot->sin_step;
+	rot->sin_theta = sin_theta;
+}
+
+void mp_arc_rotation_sync(mpArcRotation_t *rot, const float theta)
+{
+	rot->sin_theta = sin(theta);
+	rot->cos_theta = cos(theta);
+	rot->count = rot->resync;
+}
+
+void mp_set_arc_unit(const mpArcMove_t *arc_move, const float length, const float fraction, float unit[])
+{
+	float theta = arc_move->theta + arc_move->angular_travel * fraction;
+	float scale = arc_move->angular_travel * arc_move->radius / length;	// planar travel per unit length
+	unit[arc_move->plane_axis_0] = cos(theta) * scale;
+	unit[arc_move->plane_axis_1] = -sin(theta) * scale;
+}
+
 /*
  * cm_abort_arc() - stop arc movement without maintaining position
  *
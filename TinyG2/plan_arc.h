@@ -20,6 +20,8 @@
 #ifndef PLAN_ARC_H_ONCE
 #define PLAN_ARC_H_ONCE
 
+#include "planner.h"	// used for mpArcRotation_t
+
 #define MIN_ARC_RADIUS          ((float)0.1)
 #define MIN_ARC_SEGMENT_LENGTH  ((float)0.1)		// Arc segment size (mm).(0.03)
 #define MIN_ARC_SEGMENT_USEC	((float)10000)		// minimum arc segment time
@@ -52,6 +54,7 @@ typedef struct arArcSingleton {	// persistent planner and runtime variables
 	float segment_linear_travel;// linear motion per segment
 	float center_0;				// center of circle at plane axis 0 (e.g. X for G17)
 	float center_1;				// center of circle at plane axis 1 (e.g. Y for G17)
+	mpArcRotation_t rotation;	// sine and cosine of theta, rotated on a segment at a time
 
 	GCodeState_t gm;			// Gcode state struct is passed for each arc segment.
 //	Usage:
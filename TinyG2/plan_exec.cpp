@@ -33,6 +33,7 @@
 #include "kinematics.h"
 #include "stepper.h"
 #include "encoder.h"
+#include "hardware.h"
 #include "report.h"
 #include "util.h"
 #include "spindle.h"
@@ -44,6 +45,14 @@ static stat_t _exec_aline_tail(void);
 static stat_t _exec_aline_segment(void);
 
 static void _init_forward_diffs(float Vi, float Vt);
+static void _next_segment_velocity(void);
+static void _next_forward_diffs(void);
+static void _init_waypoints(void);
+#ifdef __FIXED_POINT_EXEC
+static void _fx_init_section(float Vi, float Vt);
+static void _fx_end_section(bool at_waypoint);
+#endif
+static bool _exec_aline_override(mpBuf_t *bf, const float velocity, const float length);
 
 using namespace Motate;
 //OutputPin<kDebug1_PinNumber> exec_debug_pin1;
@@ -67,7 +76,7 @@ stat_t mp_exec_move()
 		return (STAT_NOOP);
 	}
 	// Manage cycle and motion state transitions
-	if (bf->move_type == MOVE_TYPE_ALINE) { 			// cycle auto-start for lines only
+	if (mp_is_motion(bf)) { 							// cycle auto-start for lines and arcs only
         if (cm.motion_state == MOTION_STOP) {
             cm_set_motion_state(MOTION_RUN);
         }
@@ -211,7 +220,7 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         // ++++ to here
 */
         // Start a new move by setting up the runtime singleton (mr)
-        memcpy(&mr.gm, &(bf->gm), sizeof(GCodeState_t)); // copy in the gcode model state
+        memcpy(&mr.gm, mp_get_buffer_gm(bf), sizeof(GCodeState_t)); // copy in the gcode model state
         bf->replannable = false;                         // signal the planner that this buffer is not replnnalbe
         bf->move_state = MOVE_RUN;                       // note that this buffer is running -- note the planner doesn't look at move_state
         mr.move_state = MOVE_NEW;
@@ -228,20 +237,32 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         mr.exit_velocity = bf->exit_velocity;
 
         copy_vector(mr.unit, bf->unit);
-        copy_vector(mr.target, bf->gm.target);			// save the final target of the move
-
-        // generate the waypoints for position correction at section ends
-        for (uint8_t axis=0; axis<AXES; axis++) {
-            mr.waypoint[SECTION_HEAD][axis] = mr.position[axis] + mr.unit[axis] * mr.head_length;
-            mr.waypoint[SECTION_BODY][axis] = mr.position[axis] + mr.unit[axis] * (mr.head_length + mr.body_length);
-            mr.waypoint[SECTION_TAIL][axis] = mr.position[axis] + mr.unit[axis] * (mr.head_length + mr.body_length + mr.tail_length);
+        copy_vector(mr.target, mp_get_buffer_gm(bf)->target);			// save the final target of the move
+        mr.move_type = bf->move_type;
+        copy_vector(mr.start, mr.position);
+        mr.length = bf->length;
+        mr.distance = 0;
+        mr.distance_error = 0;
+        if (mr.move_type == MOVE_TYPE_ARC) {
+            mr.arc = mp_get_buffer_curve(bf)->arc;
+            mp_arc_rotation_init(&mr.rotation, mr.arc.theta, mr.arc.radius);
+        } else if (mr.move_type == MOVE_TYPE_SPLINE) {
+            mr.spline = mp_get_buffer_curve(bf)->spline;
+            mp_spline_walk_init(&mr.walk, &mr.spline);
         }
 
+        _init_waypoints();                              // generate the waypoints for position correction at section ends
+
         // Update the planner buffer times --
         // We can "guess" quite accurately but we still need a full re-accounting to handle the locking.
 //        mb.needs_time_accounting = true;
         //mb.time_in_planner -= bf->real_move_time;
         mb.time_in_run = bf->real_move_time;    // initialize the time_in_run
+
+        // A move that was locked when the override changed gets it here
+        if (cm.motion_state != MOTION_HOLD) {
+            _exec_aline_override(bf, mr.entry_velocity, bf->length);
+        }
     }
 
     // Feedhold Processing - We need to handle the following cases (listed in rough sequence order):
@@ -295,7 +316,9 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         if (cm.hold_state == FEEDHOLD_DECEL_END) {
             mr.move_state = MOVE_OFF;	                                // invalidate mr buffer to reset the new move
             bf->move_state = MOVE_NEW;                                  // tell _exec to re-use the bf buffer
-            bf->length = get_axis_vector_length(mr.target, mr.position);// reset length
+            if (mr.move_type == MOVE_TYPE_ALINE) {                      // (a curve was cut down when the deceleration ended)
+                bf->length = get_axis_vector_length(mr.target, mr.position);// reset length
+            }
             bf->delta_vmax = mp_get_target_velocity(0, bf->length, bf); // reset cruise velocity
             bf->entry_vmax = 0;                                         // set bp+0 as hold point
             mp_reset_replannable_list();                                // make it replan all the blocks
@@ -315,6 +338,10 @@ stat_t mp_exec_aline(mpBuf_t *bf)
                     cm.hold_state = FEEDHOLD_DECEL_CONTINUE;
                 }
             } else {
+#ifdef __FIXED_POINT_EXEC
+                _fx_end_section(false);             // bring mr.position up to the last segment
+                mr.forward_diff_5 = mr.fx[FX_PATH].forward_diff_5 * ldexpf(mr.fx_velocity_scale, mr.fx_point[0] - mr.fx_point[5]);
+#endif
                 mr.entry_velocity = mr.segment_velocity;
                 if (mr.section == SECTION_HEAD) {
                     mr.entry_velocity += mr.forward_diff_5; // compute velocity for next segment (this new one)
@@ -327,7 +354,8 @@ stat_t mp_exec_aline(mpBuf_t *bf)
                 mr.head_length = 0;
                 mr.body_length = 0;
 
-                float available_length = get_axis_vector_length(mr.target, mr.position);
+                float available_length = (mr.move_type != MOVE_TYPE_ALINE) ? (mr.length - mr.distance) :
+                                                         get_axis_vector_length(mr.target, mr.position);
                 mr.tail_length = mp_get_target_length(mr.cruise_velocity, 0, bf);   // braking length
 
 
@@ -348,6 +376,11 @@ stat_t mp_exec_aline(mpBuf_t *bf)
     }
     mr.move_state = MOVE_RUN;
 
+    // The running move picks up an override change at the end of its head
+    if ((mr.section == SECTION_BODY) && (mr.section_state == SECTION_NEW) && (cm.motion_state != MOTION_HOLD)) {
+        _exec_aline_override(bf, mr.cruise_velocity, mr.body_length + mr.tail_length);
+    }
+
     // NB: from this point on the contents of the bf buffer do not affect execution
 
 	//**** main dispatcher to process segments ***
@@ -362,6 +395,19 @@ stat_t mp_exec_aline(mpBuf_t *bf)
     if ((cm.hold_state == FEEDHOLD_DECEL_TO_ZERO) && (status == STAT_OK)) {
         cm.hold_state = FEEDHOLD_DECEL_END;
         bf->move_state = MOVE_NEW;                      // reset bf so it can restart the rest of the move
+        if (mr.move_type == MOVE_TYPE_ARC) {            // cut an arc down to the rest of it now - mr is set up
+            float fraction = mr.distance / mr.length;   // from bf again (distance 0) before Case (5) runs
+            mpArcMove_t *arc = &mp_get_buffer_curve(bf)->arc;
+            arc->theta += arc->angular_travel * fraction;
+            arc->angular_travel *= (1 - fraction);
+            bf->length = mr.length - mr.distance;
+            mp_set_arc_unit(arc, bf->length, 0, bf->unit);
+        } else if (mr.move_type == MOVE_TYPE_SPLINE) {  // ...and a spline
+            mpSplineMove_t *spline = &mp_get_buffer_curve(bf)->spline;
+            mp_split_spline(spline, mr.walk.u, mr.distance / mr.length, mr.position);
+            bf->length = mr.length - mr.distance;
+            mp_set_spline_unit(spline, bf->length, false, bf->unit);
+        }
     }
 
 	// There are 4 things that can happen here depending on return conditions:
@@ -544,6 +590,154 @@ static void _init_forward_diffs(float Vi, float Vt)
 	float half_Bh_4 = B * half_h * half_h * half_h * half_h;
 	float half_Ah_5 = A * half_h * half_h * half_h * half_h * half_h;
 	mr.segment_velocity = half_Ah_5 + half_Bh_4 + half_Ch_3 + Vi;
+#ifdef __FIXED_POINT_EXEC
+	_fx_init_section(Vi, Vt);
+#endif
+}
+
+/*
+ * _next_segment_velocity() - advance the velocity to the next segment
+ * _next_forward_diffs()	- advance the differences behind it
+ */
+
+#ifdef __FIXED_POINT_EXEC
+static void _next_segment_velocity()
+{
+	uint8_t shift = mr.fx_point[5] - mr.fx_point[0];
+	for (uint8_t c=0; c<FX_CHANNELS; c++) {
+		mr.fx[c].velocity += mr.fx[c].forward_diff_5 >> shift;
+	}
+	mr.segment_velocity = mr.fx[FX_PATH].velocity * mr.fx_velocity_scale;	// for reporting
+}
+
+static void _next_forward_diffs()
+{
+	uint8_t shift_5 = mr.fx_point[4] - mr.fx_point[5];
+	uint8_t shift_4 = mr.fx_point[3] - mr.fx_point[4];
+	uint8_t shift_3 = mr.fx_point[2] - mr.fx_point[3];
+	uint8_t shift_2 = mr.fx_point[1] - mr.fx_point[2];
+	for (uint8_t c=0; c<FX_CHANNELS; c++) {
+		mr.fx[c].forward_diff_5 += mr.fx[c].forward_diff_4 >> shift_5;
+		mr.fx[c].forward_diff_4 += mr.fx[c].forward_diff_3 >> shift_4;
+		mr.fx[c].forward_diff_3 += mr.fx[c].forward_diff_2 >> shift_3;
+		mr.fx[c].forward_diff_2 += mr.fx[c].forward_diff_1 >> shift_2;
+	}
+}
+
+#else // __FIXED_POINT_EXEC
+
+static void _next_segment_velocity()
+{
+	mr.segment_velocity += mr.forward_diff_5;
+}
+
+static void _next_forward_diffs()
+{
+	mr.forward_diff_5 += mr.forward_diff_4;
+	mr.forward_diff_4 += mr.forward_diff_3;
+	mr.forward_diff_3 += mr.forward_diff_2;
+	mr.forward_diff_2 += mr.forward_diff_1;
+}
+#endif // __FIXED_POINT_EXEC
+
+/*
+ * _init_waypoints() - set the section end positions of the mr move from where it is now
+ *
+ *	An arc's waypoints are the points on the arc that far along it. The last one is the
+ *	arc's target, so the rounding in the angles doesn't end up in the next move. A spline
+ *	only has its target - the points between are found by walking to them.
+ */
+
+static void _init_waypoints()
+{
+    if (mr.move_type != MOVE_TYPE_ALINE) {
+        mr.waypoint_distance[SECTION_HEAD] = mr.distance + mr.head_length;
+        mr.waypoint_distance[SECTION_BODY] = mr.waypoint_distance[SECTION_HEAD] + mr.body_length;
+        mr.waypoint_distance[SECTION_TAIL] = mr.waypoint_distance[SECTION_BODY] + mr.tail_length;
+        for (uint8_t section=SECTION_HEAD; section<=SECTION_TAIL; section++) {
+            if (mr.waypoint_distance[section] >= mr.length * (1 - ARC_END_TOLERANCE)) {
+                copy_vector(mr.waypoint[section], mr.target);
+            } else if (mr.move_type == MOVE_TYPE_ARC) {
+                mp_get_arc_point(&mr.arc, mr.start, mr.target, mr.waypoint_distance[section] / mr.length, mr.waypoint[section]);
+            }
+        }
+        return;
+    }
+    for (uint8_t axis=0; axis<AXES; axis++) {
+        mr.waypoint[SECTION_HEAD][axis] = mr.position[axis] + mr.unit[axis] * mr.head_length;
+        mr.waypoint[SECTION_BODY][axis] = mr.position[axis] + mr.unit[axis] * (mr.head_length + mr.body_length);
+        mr.waypoint[SECTION_TAIL][axis] = mr.position[axis] + mr.unit[axis] * (mr.head_length + mr.body_length + mr.tail_length);
+    }
+}
+
+/*********************************************************************************************
+ * _exec_aline_override() - re-target the cruise velocity of the move in mr to the override
+ *
+ *	Called at a section boundary - the start of the move or the end of the head - where
+ *	the runtime is at 'velocity' with 'length' left to go. The exit velocity is fixed
+ *	(the next move was planned to enter at it), so the rest of the move is re-planned as
+ *	a new head from 'velocity' to the new cruise, a body, and a tail to the same exit. The
+ *	head may decelerate. The cruise can't go below the exit velocity.
+ *
+ *	If the new trapezoid doesn't fit in what's left, or would make a section shorter than
+ *	a segment, the move is left as it was and finishes at its old cruise velocity.
+ *	Returns true if the move was changed.
+ */
+
+static bool _exec_aline_override(mpBuf_t *bf, const float velocity, const float length)
+{
+    float target = mp_get_override_vmax(bf);
+    if (fp_EQ(target, bf->cruise_vmax)) {
+        return (false);
+    }
+    if ((target < bf->cruise_vmax) && (target >= mr.cruise_velocity)) {
+        bf->cruise_vmax = target;                   // a lower cap the move never reaches anyway
+        return (false);
+    }
+    float cruise = max(target, mr.exit_velocity);
+    float head_length = 0;
+    float tail_length = 0;
+
+    if (fabs(cruise - velocity) >= TRAPEZOID_VELOCITY_TOLERANCE) {
+        head_length = mp_get_target_length(velocity, cruise, bf);
+        if ((2 * head_length / (velocity + cruise)) < MIN_SEGMENT_TIME_PLUS_MARGIN) {
+            return (false);
+        }
+    }
+    if ((cruise - mr.exit_velocity) >= TRAPEZOID_VELOCITY_TOLERANCE) {
+        tail_length = mp_get_target_length(cruise, mr.exit_velocity, bf);
+        if ((2 * tail_length / (cruise + mr.exit_velocity)) < MIN_SEGMENT_TIME_PLUS_MARGIN) {
+            return (false);
+        }
+    }
+    float body_length = length - head_length - tail_length;
+    if (body_length < 0) {
+        return (false);
+    }
+    if ((body_length / cruise) < MIN_SEGMENT_TIME_PLUS_MARGIN) {   // fold a sliver of body into a ramp
+        if (head_length > 0) {
+            head_length += body_length;
+        } else if (tail_length > 0) {
+            tail_length += body_length;
+        } else {
+            return (false);
+        }
+        body_length = 0;
+    }
+
+    mr.entry_velocity = velocity;
+    mr.cruise_velocity = cruise;
+    mr.head_length = head_length;
+    mr.body_length = body_length;
+    mr.tail_length = tail_length;
+    mr.section = SECTION_HEAD;
+    mr.section_state = SECTION_NEW;
+    _init_waypoints();
+
+    mb.time_in_run = (2 * head_length / (velocity + cruise)) + (body_length / cruise) +
+                     (2 * tail_length / (cruise + mr.exit_velocity));
+    bf->cruise_vmax = target;
+    return (true);
 }
 
 /*********************************************************************************************
@@ -578,16 +772,13 @@ static stat_t _exec_aline_head()
 		return(STAT_EAGAIN);
 	}
 	if (mr.section_state == SECTION_2nd_HALF) {						// SECOND HALF (convex part of accel curve)
-		mr.segment_velocity += mr.forward_diff_5;
+		_next_segment_velocity();
 		if (_exec_aline_segment() == STAT_OK) { 					// set up for body
 			if ((fp_ZERO(mr.body_length)) && (fp_ZERO(mr.tail_length))) return(STAT_OK); // ends the move
 			mr.section = SECTION_BODY;
 			mr.section_state = SECTION_NEW;
 		} else {
-			mr.forward_diff_5 += mr.forward_diff_4;
-			mr.forward_diff_4 += mr.forward_diff_3;
-			mr.forward_diff_3 += mr.forward_diff_2;
-			mr.forward_diff_2 += mr.forward_diff_1;
+			_next_forward_diffs();
 		}
 	}
 	return(STAT_EAGAIN);
@@ -596,9 +787,13 @@ static stat_t _exec_aline_head()
 /*********************************************************************************************
  * _exec_aline_body()
  *
- *	The body is broken into little segments even though it is a straight line so that
- *	feedholds can happen in the middle of a line with a minimum of latency
+ *	The body is broken into segments even though it is a straight line so that feedholds
+ *	can happen in the middle of a line with bounded latency. With linear kinematics the
+ *	segments can be as long as that bound allows (MAX_SEGMENT_USEC) - nothing along a
+ *	straight line at constant velocity is gained by slicing it finer. Non-linear kinematics
+ *	need NOM_SEGMENT_USEC slices to follow the curve the line makes in joint space ($kin).
  */
+
 static stat_t _exec_aline_body()
 {
 	if (mr.section_state == SECTION_NEW) {
@@ -607,9 +802,9 @@ static stat_t _exec_aline_body()
 			return(_exec_aline_tail());						// skip ahead to tail periods
 		}
 		mr.gm.move_time = mr.body_length / mr.cruise_velocity;
-		mr.segments = ceil(uSec(mr.gm.move_time) / NOM_SEGMENT_USEC);
+		mr.segments = ceil(uSec(mr.gm.move_time) / (((mr.move_type == MOVE_TYPE_ALINE) && ik_is_linear()) ? MAX_SEGMENT_USEC : NOM_SEGMENT_USEC));
 		mr.segment_time = mr.gm.move_time / mr.segments;
-		mr.segment_velocity = mr.cruise_velocity;
+		_init_forward_diffs(mr.cruise_velocity, mr.cruise_velocity);	// constant velocity, differences are zero
 		mr.segment_count = (uint32_t)mr.segments;
 		if (mr.segment_time < MIN_SEGMENT_TIME) return(STAT_MINIMUM_TIME_MOVE); // exit without advancing position
 		mr.section = SECTION_BODY;
@@ -655,14 +850,11 @@ static stat_t _exec_aline_tail()
 		return(STAT_EAGAIN);
 	}
 	if (mr.section_state == SECTION_2nd_HALF) {						// SECOND HALF - concave part (period 5)
-		mr.segment_velocity += mr.forward_diff_5;
+		_next_segment_velocity();
 		if (_exec_aline_segment() == STAT_OK) {
 			return(STAT_OK);                                        // STAT_OK completes the move
 		} else {
-			mr.forward_diff_5 += mr.forward_diff_4;
-			mr.forward_diff_4 += mr.forward_diff_3;
-			mr.forward_diff_3 += mr.forward_diff_2;
-			mr.forward_diff_2 += mr.forward_diff_1;
+			_next_forward_diffs();
 		}
 	}
 	return(STAT_EAGAIN);
@@ -673,8 +865,10 @@ static stat_t _exec_aline_tail()
  *
  * NOTES ON STEP ERROR CORRECTION:
  *
- *	The commanded_steps are the target_steps delayed by one more segment.
- *	This lines them up in time with the encoder readings so a following error can be generated
+ *	The commanded_steps are where the segment the steppers are running started from. The
+ *	encoder readings are taken at the same point, so a following error can be generated.
+ *	The prep ring can hold several segments so this isn't a fixed number of segments behind
+ *	the target - st_sample_encoders() reads both together.
  *
  *	The following_error term is positive if the encoder reading is greater than (ahead of)
  *	the commanded steps, and negative (behind) if the encoder reading is less than the
@@ -688,6 +882,169 @@ static stat_t _exec_aline_tail()
  *	     -100	    -90	       -10		encoder is 10 steps behind commanded steps
  */
 
+#ifdef __FIXED_POINT_EXEC
+static stat_t _exec_aline_segment()
+{
+	uint8_t i;
+	fxsteps_t travel_steps[MOTORS];
+	uint8_t shift = mr.fx_point[0] - FXSTEPS_BITS;		// channels to steps, rounded
+	int64_t half = (int64_t)1 << (shift - 1);
+
+	bool at_waypoint = ((--mr.segment_count == 0) && (mr.section_state == SECTION_2nd_HALF) &&
+						(cm.motion_state != MOTION_HOLD));
+
+	st_sample_encoders(mr.fx_commanded_steps, mr.fx_encoder_steps);
+	for (i=0; i<MOTORS; i++) {
+		mr.fx_position_steps[i] = mr.fx_target_steps[i];
+		mr.fx_following_error[i] = mr.fx_encoder_steps[i] - mr.fx_commanded_steps[i];
+		if (at_waypoint) {
+			mr.fx_target_steps[i] = mr.fx_waypoint_steps[i];
+		} else {
+			mr.fx_target_steps[i] += (mr.fx[i].velocity + half) >> shift;
+		}
+		travel_steps[i] = mr.fx_target_steps[i] - mr.fx_position_steps[i];
+	}
+
+    mb.time_in_run -= mr.segment_time;
+    if (mb.time_in_run < 0) {
+        mb.time_in_run = 0.0;
+    }
+
+	ritorno(st_prep_line(travel_steps, mr.fx_position_steps, mr.fx_following_error, mr.fx_dda_ticks));
+	mr.fx_distance += (mr.fx[FX_PATH].velocity + half) >> shift;
+	mr.fx_length = fx_to_steps(mr.fx_distance);			// same Q.32, in length units
+	if (mr.segment_count == 0) {
+		_fx_end_section(at_waypoint);
+        return (STAT_OK);			                        // this section has run all its segments
+	}
+	return (STAT_EAGAIN);									// this section still has more segments to run
+}
+
+/*
+ * _fx_init_section() - set up the integer forward differences for a section
+ *
+ *	Runs after the float differences are set up, once per section, and converts them to
+ *	one channel per motor and one for the path length (FX_PATH). With linear kinematics
+ *	a motor's travel is the path travel times its steps per unit along the move, so each
+ *	channel is a scaled copy of the float differences and the segments need nothing but
+ *	int64 adds and shifts. The velocity is carried as travel per segment.
+ *
+ *	Each order of difference gets its own binary point (fx_point[]), set per section as far
+ *	left as the largest value that order can reach allows. An error in the last place of
+ *	forward_diff_1 grows with the fifth power of the segment count, and forward_diff_1 is
+ *	tiny next to the velocity in a long section, so one binary point for all of them
+ *	loses the position within a few thousand segments. A difference is shifted down to
+ *	the next order's point as it's added in. The points only ever move right going from
+ *	the velocity to forward_diff_1, which keeps the shifts positive; the bounds below are
+ *	the largest derivatives of the velocity curve, plus the starting values for sections
+ *	of only a few segments. FX_HEADROOM bits are left over on top of all of that.
+ */
+
+#ifndef FX_HEADROOM
+#define FX_HEADROOM 4					// spare bits above the largest value of each order
+#endif
+
+static int64_t _fx_round(float x)
+{
+	return ((int64_t)((x < 0) ? (x - (float)0.5) : (x + (float)0.5)));
+}
+
+static void _fx_init_section(float Vi, float Vt)
+{
+	float steps_per_unit[FX_CHANNELS];
+	float waypoint_steps[MOTORS];
+
+	for (uint8_t c=0; c<FX_CHANNELS; c++) {
+		steps_per_unit[c] = 0;						// ik leaves unmapped motors alone
+	}
+	ik_kinematics(mr.unit, steps_per_unit);			// steps for a unit length of the move
+	steps_per_unit[FX_PATH] = 1;
+
+	float steps_max = 1;
+	for (uint8_t c=0; c<MOTORS; c++) {
+		steps_max = max(steps_max, (float)fabs(steps_per_unit[c]));
+	}
+	float h = 1 / mr.segments;
+	float dV = fabs(Vt - Vi);
+	float largest[6] = { max(fabs(Vi), fabs(Vt)),
+						 fabs(mr.forward_diff_1) + 720*dV*h*h*h*h*h,
+						 fabs(mr.forward_diff_2) + 360*dV*h*h*h*h,
+						 fabs(mr.forward_diff_3) + 60*dV*h*h*h,
+						 fabs(mr.forward_diff_4) + 6*dV*h*h,
+						 fabs(mr.forward_diff_5) + 2*dV*h };
+	uint8_t point[6];
+	for (uint8_t d=0; d<6; d++) {
+		int exponent;
+		frexpf(largest[d] * mr.segment_time * steps_max, &exponent);
+		int p = 63 - FX_HEADROOM - exponent;			// zero or tiny orders would go off the float range
+		point[d] = (p < FXSTEPS_BITS + 1) ? FXSTEPS_BITS + 1 : ((p > 100) ? 100 : p);
+	}
+	mr.fx_point[1] = point[1];
+	for (uint8_t d=2; d<6; d++) {						// forward_diff_1 down to forward_diff_5
+		mr.fx_point[d] = min(point[d], mr.fx_point[d-1]);
+	}
+	mr.fx_point[0] = min(point[0], mr.fx_point[5]);
+	for (uint8_t d=5; d>0; d--) {						// nothing below 2^-62 of the next order matters
+		uint8_t next = (d == 5) ? mr.fx_point[0] : mr.fx_point[d+1];
+		if (mr.fx_point[d] > next + 62) {
+			mr.fx_point[d] = next + 62;
+		}
+	}
+
+	float scale[6];
+	for (uint8_t d=0; d<6; d++) {
+		scale[d] = ldexpf(mr.segment_time, mr.fx_point[d]);	// per minute to fixed-point per segment
+	}
+	for (uint8_t c=0; c<FX_CHANNELS; c++) {
+		float k = steps_per_unit[c];
+		mr.fx[c].velocity = _fx_round(mr.segment_velocity * k * scale[0]);
+		mr.fx[c].forward_diff_1 = _fx_round(mr.forward_diff_1 * k * scale[1]);
+		mr.fx[c].forward_diff_2 = _fx_round(mr.forward_diff_2 * k * scale[2]);
+		mr.fx[c].forward_diff_3 = _fx_round(mr.forward_diff_3 * k * scale[3]);
+		mr.fx[c].forward_diff_4 = _fx_round(mr.forward_diff_4 * k * scale[4]);
+		mr.fx[c].forward_diff_5 = _fx_round(mr.forward_diff_5 * k * scale[5]);
+	}
+	mr.fx_velocity_scale = ldexpf(1 / mr.segment_time, -mr.fx_point[0]);
+
+	ik_kinematics(mr.waypoint[mr.section], waypoint_steps);
+	for (uint8_t m=0; m<MOTORS; m++) {				// a motor that isn't in the move stays exactly where it is
+		mr.fx_waypoint_steps[m] = (fp_ZERO(steps_per_unit[m])) ? mr.fx_target_steps[m] : fx_from_steps(waypoint_steps[m]);
+	}
+	mr.fx_dda_ticks = (uint32_t)(mr.segment_time * 60 * FREQUENCY_DDA);	// NB: converts minutes to seconds
+}
+
+/*
+ * _fx_end_section() - catch the float runtime state up with the integer segments
+ *
+ *	mr.position is left at the section start while the segments run (reports add
+ *	fx_length, see mp_get_runtime_absolute_position()), and moves here when a section ends,
+ *	or when a feedhold cuts one short. The steps vectors are refreshed for the diagnostics.
+ */
+
+static void _fx_end_section(bool at_waypoint)
+{
+	if (at_waypoint) {
+		copy_vector(mr.gm.target, mr.waypoint[mr.section]);
+	} else {
+		for (uint8_t axis=0; axis<AXES; axis++) {
+			mr.gm.target[axis] = mr.position[axis] + mr.unit[axis] * mr.fx_length;
+		}
+	}
+	mr.fx_distance = 0;
+	mr.fx_length = 0;										// a report in between sees the old position
+	copy_vector(mr.position, mr.gm.target);
+
+	for (uint8_t m=0; m<MOTORS; m++) {
+		mr.target_steps[m] = fx_to_steps(mr.fx_target_steps[m]);
+		mr.position_steps[m] = fx_to_steps(mr.fx_position_steps[m]);
+		mr.commanded_steps[m] = fx_to_steps(mr.fx_commanded_steps[m]);
+		mr.encoder_steps[m] = fx_to_steps(mr.fx_encoder_steps[m]);
+		mr.following_error[m] = fx_to_steps(mr.fx_following_error[m]);
+	}
+}
+
+#else // __FIXED_POINT_EXEC
+
 static stat_t _exec_aline_segment()
 {
 	uint8_t i;
@@ -697,14 +1054,42 @@ static stat_t _exec_aline_segment()
 	// If the segment ends on a section waypoint synchronize to the head, body or tail end
 	// Otherwise if not at a section waypoint compute target from segment time and velocity
 	// Don't do waypoint correction if you are going into a hold.
+	// An arc's or spline's target is found from the distance run along it rather than from the unit vector.
 
-	if ((--mr.segment_count == 0) && (mr.section_state == SECTION_2nd_HALF) &&
-		(cm.motion_state != MOTION_HOLD)) {
+	bool at_waypoint = ((--mr.segment_count == 0) && (mr.section_state == SECTION_2nd_HALF) &&
+						(cm.motion_state != MOTION_HOLD));
+	if ((at_waypoint) && ((mr.move_type != MOVE_TYPE_SPLINE) ||
+						  (mr.waypoint_distance[mr.section] >= mr.length * (1 - ARC_END_TOLERANCE)))) {
 		copy_vector(mr.gm.target, mr.waypoint[mr.section]);
+		if (mr.move_type != MOVE_TYPE_ALINE) {
+			mr.distance = mr.waypoint_distance[mr.section];
+			mr.distance_error = 0;
+		}
+		if (mr.move_type == MOVE_TYPE_ARC) {
+			mp_arc_rotation_sync(&mr.rotation, mr.arc.theta + mr.arc.angular_travel * (mr.distance / mr.length));
+		}
 	} else {
 		float segment_length = mr.segment_velocity * mr.segment_time;
-		for (i=0; i<AXES; i++) {
-			mr.gm.target[i] = mr.position[i] + (mr.unit[i] * segment_length);
+		if (at_waypoint) {							// a spline walks to a waypoint short of its end
+			segment_length = mr.waypoint_distance[mr.section] - mr.distance;
+			mr.distance = mr.waypoint_distance[mr.section];
+			mr.distance_error = 0;
+		} else if (mr.move_type != MOVE_TYPE_ALINE) {	// Kahan sum - a long arc is thousands of segments
+			float addend = segment_length - mr.distance_error;
+			float distance = mr.distance + addend;
+			mr.distance_error = (distance - mr.distance) - addend;
+			mr.distance = distance;
+		}
+		if (mr.move_type == MOVE_TYPE_ARC) {
+			mp_next_arc_point(&mr.arc, &mr.rotation, mr.start, mr.target, mr.distance / mr.length,
+							  mr.arc.angular_travel * (segment_length / mr.length), mr.gm.target);
+		} else if (mr.move_type == MOVE_TYPE_SPLINE) {
+			mp_next_spline_point(&mr.spline, &mr.walk, mr.start, mr.target, mr.distance / mr.length,
+								 mr.spline.planar_length * (segment_length / mr.length), mr.gm.target);
+		} else {
+			for (i=0; i<AXES; i++) {
+				mr.gm.target[i] = mr.position[i] + (mr.unit[i] * segment_length);
+			}
 		}
 	}
 
@@ -714,10 +1099,9 @@ static stat_t _exec_aline_segment()
 	// NB: The direct manipulation of steps to compute travel_steps only works for Cartesian kinematics.
 	//	   Other kinematics may require transforming travel distance as opposed to simply subtracting steps.
 
+	st_sample_encoders(mr.commanded_steps, mr.encoder_steps);	// get current encoder position and where it should be
 	for (i=0; i<MOTORS; i++) {
-		mr.commanded_steps[i] = mr.position_steps[i];		// previous segment's position, delayed by 1 segment
 		mr.position_steps[i] = mr.target_steps[i];			// previous segment's target becomes position
-		mr.encoder_steps[i] = en_read_encoder(i);			// get current encoder position (time aligns to commanded_steps)
 		mr.following_error[i] = mr.encoder_steps[i] - mr.commanded_steps[i];
 	}
 	ik_kinematics(mr.gm.target, mr.target_steps);			// now determine the target steps...
@@ -733,10 +1117,10 @@ static stat_t _exec_aline_segment()
 
 	// Call the stepper prep function
 
-	ritorno(st_prep_line(travel_steps, mr.following_error, mr.segment_time));
+	ritorno(st_prep_line(travel_steps, mr.position_steps, mr.following_error, mr.segment_time));
 	copy_vector(mr.position, mr.gm.target); 				// update position from target
 	if (mr.segment_count == 0)
         return (STAT_OK);			                        // this section has run all its segments
 	return (STAT_EAGAIN);									// this section still has more segments to run
 }
-
+#endif // __FIXED_POINT_EXEC
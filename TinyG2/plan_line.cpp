@@ -48,10 +48,18 @@ OutputPin<-1> plan_debug_pin3;
 //OutputPin<-1> plan_debug_pin4;
 
 // planner helper functions
+static stat_t _aline(GCodeState_t *gm_in, const float vmax);
+static stat_t _queue_move(mpBuf_t *bf, GCodeState_t *gm_in, const float jerk_unit[], const float vmax, const moveType move_type);
+static void _blend_corner(GCodeState_t *gm_in);
+static bool _coalesce_line(GCodeState_t *gm_in);
+static bool _claim_for_planning(mpBuf_t *bp);
+static bool _carry_line(GCodeState_t *gm_in);
 static void _calculate_move_times(GCodeState_t *gms, const float axis_length[], const float axis_square[]);
-static void _calculate_jerk(mpBuf_t *bf);
+static void _calculate_jerk(mpBuf_t *bf, const float unit[]);
 //static float _calculate_junction_vmax(const float a_unit[], const float b_unit[]);
-static float _calculate_junction_vmax(const float vmax, const float a_unit[], const float b_unit[]);
+static float _calculate_junction_vmax(mpBuf_t *bf);
+static float _calculate_centripetal_junction_vmax(const float vmax, const float a_unit[], const float b_unit[]);
+static float _calculate_axis_junction_vmax(mpBuf_t *bf, const float a_unit[]);
 
 //static void _reset_replannable_list(void);
 
@@ -67,9 +75,13 @@ static float _calculate_junction_vmax(const float vmax, const float a_unit[], co
 
 void mp_zero_segment_velocity() { mr.segment_velocity = 0;}
 float mp_get_runtime_velocity(void) { return (mr.segment_velocity);}
+#ifdef __FIXED_POINT_EXEC	// mr.position only moves at section ends (see _fx_end_section())
+float mp_get_runtime_absolute_position(uint8_t axis) { return (mr.position[axis] + mr.unit[axis] * mr.fx_length);}
+#else
 float mp_get_runtime_absolute_position(uint8_t axis) { return (mr.position[axis]);}
+#endif
 void mp_set_runtime_work_offset(float offset[]) { copy_vector(mr.gm.work_offset, offset);}
-float mp_get_runtime_work_position(uint8_t axis) { return (mr.position[axis] - mr.gm.work_offset[axis]);}
+float mp_get_runtime_work_position(uint8_t axis) { return (mp_get_runtime_absolute_position(axis) - mr.gm.work_offset[axis]);}
 
 /*
  * mp_get_runtime_busy() - return TRUE if motion control busy (i.e. robot is moving)
@@ -108,9 +120,38 @@ uint8_t mp_get_runtime_busy()
  *	Note: Returning a status that is not STAT_OK means the endpoint is NOT advanced. So lines
  *	that are too short to move will accumulate and get executed once the accumulated error
  *	exceeds the minimums.
+ *
+ *	Lines that are too short to run in one minimum segment at their feed rate are carried the
+ *	same way - the planner position stays put and the next line starts from it, so it takes
+ *	in the short line's displacement. See _carry_line() and mp_commit_carry().
+ *
+ *	In G64 P<tolerance> mode the corner with the previous line may be blended first, which
+ *	queues a few more buffers ahead of this line (see _blend_corner()).
+ *
+ *	With coalescing on ($clt) a line that continues the previous one in a straight line is
+ *	merged into it instead of taking a buffer of its own (see _coalesce_line()).
  */
 
 stat_t mp_aline(GCodeState_t *gm_in)
+{
+	if (_coalesce_line(gm_in)) {
+		mm.carry = false;							// the merged line runs any carried line too
+		return (STAT_OK);
+	}
+	if (_carry_line(gm_in)) {
+		return (STAT_OK);
+	}
+	_blend_corner(gm_in);
+	return (_aline(gm_in, 0));
+}
+
+/*
+ * _aline() - queue a line from the planner position to gm_in->target
+ *
+ *	vmax is an extra velocity limit for the line, or 0 for none.
+ */
+
+static stat_t _aline(GCodeState_t *gm_in, const float vmax)
 {
     plan_debug_pin1 = 1;
 	mpBuf_t *bf; 						// current move pointer
@@ -135,6 +176,7 @@ stat_t mp_aline(GCodeState_t *gm_in)
 		return (STAT_MINIMUM_LENGTH_MOVE);
 	}
 
+    BENCH(bench_aline_begin());
     _calculate_move_times(gm_in, axis_length, axis_square);         // set move time and minimum time in the state
 
     // get a cleared buffer and setup move variables
@@ -149,10 +191,30 @@ stat_t mp_aline(GCodeState_t *gm_in)
             bf->unit_flags[axis] = true;
         }
     }
-	memcpy(&bf->gm, gm_in, sizeof(GCodeState_t));                   // copy model state into planner buffer
+	stat_t status = _queue_move(bf, gm_in, bf->unit, vmax, MOVE_TYPE_ALINE);
+    BENCH(bench_aline_end());
+    plan_debug_pin1 = 0;
+	return (status);
+}
 
-    _calculate_jerk(bf);                                            // get initial value for bf->jerk
-	bf->cruise_vmax = bf->length / bf->gm.move_time;                // target velocity requested
+/*
+ * _queue_move() - set up the velocities of a line or arc in bf and commit it
+ *
+ *	bf has its length and (starting) unit vector. The jerk is taken along jerk_unit, which
+ *	for an arc is the most each axis takes part anywhere along it. vmax is as for _aline().
+ */
+
+static stat_t _queue_move(mpBuf_t *bf, GCodeState_t *gm_in, const float jerk_unit[], const float vmax, const moveType move_type)
+{
+	memcpy(mp_get_buffer_gm(bf), gm_in, sizeof(GCodeState_t));      // copy model state into planner buffer
+
+    _calculate_jerk(bf, jerk_unit);                                 // get initial value for bf->jerk
+	bf->cruise_vset = bf->length / gm_in->move_time;                // target velocity requested
+	bf->absolute_vmax = bf->length / gm_in->minimum_time;           // velocity of the rate-limiting axis
+	if (vmax > 0) {
+		bf->absolute_vmax = min(bf->absolute_vmax, vmax);
+	}
+	bf->cruise_vmax = mp_get_override_vmax(bf);                     // ...with the feed or traverse override applied
 	bf->delta_vmax = mp_get_target_velocity(0, bf->length, bf);
 	bf->braking_velocity = bf->delta_vmax;
 
@@ -161,7 +223,7 @@ stat_t mp_aline(GCodeState_t *gm_in)
         bf->exit_vmax = 0;
         bf->replannable = false;                                     // ++++ Possible problem here --- for reference. This is already set to zero by the clear.
     } else {
-        bf->entry_vmax = _calculate_junction_vmax(bf->cruise_vmax, bf->pv->unit, bf->unit);
+        bf->entry_vmax = _calculate_junction_vmax(bf);
         bf->exit_vmax = min(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax));
         bf->replannable = true;
 	}
@@ -169,12 +231,167 @@ stat_t mp_aline(GCodeState_t *gm_in)
 
 	// Note: these next lines must remain in exact order. Position must update before committing the buffer.
 //	mp_plan_block_list(bf, false);				// replan block list
-	copy_vector(mm.position, bf->gm.target);	// set the planner position
-	mp_commit_write_buffer(MOVE_TYPE_ALINE); 	// commit current block (must follow the position update)
-    plan_debug_pin1 = 0;
+	copy_vector(mm.position, gm_in->target);	// set the planner position
+	mp_commit_write_buffer(move_type); 			// commit current block (must follow the position update)
 	return (STAT_OK);
 }
 
+/*
+ * mp_arc() - plan an arc as a single block
+ *
+ *	The arc is planned like a line of the arc's length (the helix length if other axes move
+ *	too) and the exec follows the curve (see _init_waypoints() in plan_exec.cpp). The planner
+ *	sees the tangent at the start as the unit vector, and the tangent at the end for the
+ *	corner with whatever follows. gm_in->move_time is the arc's time at the requested feed rate.
+ *
+ *	Jerk and the rate-limiting axis are taken from the most each axis takes part anywhere
+ *	along the arc, and the velocity is capped so the centripetal acceleration stays under
+ *	the junction acceleration - the same limit the chords of an arc would have met at their
+ *	corners. An arc too short to make a segment is run as a line (and may be carried).
+ *
+ *	The arc ends where its angle says, which is off the target if the target wasn't on the
+ *	circle. The planner position goes there too, as it did at the end of the chords.
+ *
+ *	That leaves the gcode model at the target and the planner off it, so the next arc's
+ *	center - worked out from the model position - can put its start off the circle from
+ *	where the planner is. The chords took up the difference in their first segment. Here
+ *	a line to the start of the arc is queued first, at the arc's feed rate, so the exec
+ *	doesn't jump onto the circle with no planned motion.
+ */
+
+stat_t mp_arc(GCodeState_t *gm_in, const mpArcMove_t *arc_move)
+{
+	mp_commit_carry();							// a carried line runs first - it left mm.position where it was
+
+	float start[AXES];
+	mp_get_arc_point(arc_move, mm.position, gm_in->target, 0, start);
+	mp_get_arc_point(arc_move, mm.position, gm_in->target, 1, gm_in->target);
+
+	float planar_length = fabs(arc_move->angular_travel * arc_move->radius);
+	if (fp_ZERO(planar_length)) {
+		return (mp_aline(gm_in));
+	}
+	float envelope[AXES];						// largest part of each axis in the unit vector
+	float length_square = square(planar_length);
+	float travel[AXES];
+
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		travel[axis] = gm_in->target[axis] - mm.position[axis];
+		if ((axis != arc_move->plane_axis_0) && (axis != arc_move->plane_axis_1)) {
+			length_square += square(travel[axis]);
+		}
+	}
+	float length = sqrt(length_square);
+
+	gm_in->minimum_time = 0;
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		if ((axis == arc_move->plane_axis_0) || (axis == arc_move->plane_axis_1)) {
+			envelope[axis] = planar_length / length;
+		} else {
+			envelope[axis] = fabs(travel[axis]) / length;
+		}
+		gm_in->minimum_time = max(gm_in->minimum_time, envelope[axis] * length / cm.a[axis].feedrate_max);
+	}
+	gm_in->move_time = max(gm_in->move_time, gm_in->minimum_time);
+	if (gm_in->move_time < MIN_SEGMENT_TIME_PLUS_MARGIN) {
+		return (mp_aline(gm_in));				// straight from the planner position, on or off the circle
+	}
+	if (hypot(start[arc_move->plane_axis_0] - mm.position[arc_move->plane_axis_0],
+			  start[arc_move->plane_axis_1] - mm.position[arc_move->plane_axis_1]) > ARC_START_TOLERANCE) {
+		GCodeState_t gm;						// the line onto the circle
+		memcpy(&gm, gm_in, sizeof(GCodeState_t));
+		copy_vector(gm.target, start);
+		gm.motion_mode = MOTION_MODE_STRAIGHT_FEED;
+		gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
+		gm.feed_rate = length / gm_in->move_time;
+		ritorno(_aline(&gm, 0));
+	}
+
+    mpBuf_t *bf;
+    if ((bf = mp_get_write_buffer()) == NULL) {
+        return(cm_panic(STAT_BUFFER_FULL_FATAL, "no write buffer in arc"));
+    }
+    bf->bf_func = mp_exec_aline;
+    bf->length = length;
+    mp_get_buffer_curve(bf)->arc = *arc_move;
+    for (uint8_t axis=0; axis<AXES; axis++) {
+        bf->unit[axis] = travel[axis] / length;	// overwritten for the plane axes
+        bf->unit_flags[axis] = (envelope[axis] > 0);
+    }
+    mp_set_arc_unit(arc_move, length, 0, bf->unit);
+
+    float vmax = sqrt(arc_move->radius * cm.junction_acceleration) * length / planar_length;
+	return (_queue_move(bf, gm_in, envelope, vmax, MOVE_TYPE_ARC));
+}
+
+/*
+ * mp_spline() - plan a spline as a single block
+ *
+ *	Planned the same way as an arc (see mp_arc()): as a line of the curve's length, with
+ *	the tangents at the ends as the unit vectors for the corners, and the exec following
+ *	the curve. The velocity is capped so the centripetal acceleration stays under the
+ *	junction acceleration at the tightest point sampled (see mp_measure_spline()).
+ *
+ *	The move time is worked out here from the length (or taken from the inverse time
+ *	feed rate), as _calculate_move_times() does for lines. A spline that doesn't go
+ *	anywhere in the plane or is too short to make a segment is run as a line.
+ */
+
+stat_t mp_spline(GCodeState_t *gm_in, const mpSplineMove_t *spline)
+{
+	mp_commit_carry();							// a carried line runs first - it left mm.position where it was
+
+	mpSplineMove_t curve = *spline;
+	float curvature = mp_measure_spline(&curve);
+	if (fp_ZERO(curve.planar_length)) {
+		return (mp_aline(gm_in));
+	}
+	float envelope[AXES];						// largest part of each axis in the unit vector
+	float length_square = square(curve.planar_length);
+	float travel[AXES];
+
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		travel[axis] = gm_in->target[axis] - mm.position[axis];
+		if ((axis != curve.plane_axis_0) && (axis != curve.plane_axis_1)) {
+			length_square += square(travel[axis]);
+		}
+	}
+	float length = sqrt(length_square);
+
+	float move_time = (gm_in->feed_rate_mode == INVERSE_TIME_MODE) ? gm_in->feed_rate : length / gm_in->feed_rate;
+	gm_in->minimum_time = 0;
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		if ((axis == curve.plane_axis_0) || (axis == curve.plane_axis_1)) {
+			envelope[axis] = curve.planar_length / length;
+		} else {
+			envelope[axis] = fabs(travel[axis]) / length;
+		}
+		gm_in->minimum_time = max(gm_in->minimum_time, envelope[axis] * length / cm.a[axis].feedrate_max);
+	}
+	move_time = max(move_time, gm_in->minimum_time);
+	if (move_time < MIN_SEGMENT_TIME_PLUS_MARGIN) {
+		return (mp_aline(gm_in));
+	}
+	gm_in->move_time = move_time;
+	gm_in->feed_rate_mode = UNITS_PER_MINUTE_MODE;	// inverse time is for this block only (as for lines)
+
+    mpBuf_t *bf;
+    if ((bf = mp_get_write_buffer()) == NULL) {
+        return(cm_panic(STAT_BUFFER_FULL_FATAL, "no write buffer in spline"));
+    }
+    bf->bf_func = mp_exec_aline;
+    bf->length = length;
+    mp_get_buffer_curve(bf)->spline = curve;
+    for (uint8_t axis=0; axis<AXES; axis++) {
+        bf->unit[axis] = travel[axis] / length;	// overwritten for the plane axes
+        bf->unit_flags[axis] = (envelope[axis] > 0);
+    }
+    mp_set_spline_unit(&curve, length, false, bf->unit);
+
+    float vmax = (curvature > 0) ? sqrt(cm.junction_acceleration / curvature) * length / curve.planar_length : 0;
+	return (_queue_move(bf, gm_in, envelope, vmax, MOVE_TYPE_SPLINE));
+}
+
 /*
  * mp_plan_block_list() - plans the entire block list
  *
@@ -194,7 +411,7 @@ stat_t mp_aline(GCodeState_t *gm_in)
  *
  *	  bf (function arg)		- end of block list (last block in time)
  *	  bf->replannable		- start of block list set by last FALSE value [Note 1]
- *	  bf->move_type			- typically MOVE_TYPE_ALINE. Other move_types should be set to
+ *	  bf->move_type			- typically MOVE_TYPE_ALINE, _ARC or _SPLINE. Other move_types should be set to
  *							  length=0, entry_vmax=0 and exit_vmax=0 and are treated
  *							  as a momentary stop (plan to zero and from zero).
  *
@@ -206,6 +423,7 @@ stat_t mp_aline(GCodeState_t *gm_in)
  *
  *	  bf->recip_jerk		- used during trapezoid generation
  *	  bf->cbrt_jerk			- used during trapezoid generation
+ *	  bf->sqrt_jerk			- used during trapezoid generation
  *
  *	Variables that will be set during processing:
  *
@@ -240,10 +458,25 @@ stat_t mp_aline(GCodeState_t *gm_in)
  *		These routines also set all blocks in the list to be replannable so the
  *		list can be recomputed regardless of exact stops and previous replanning
  *		optimizations.
+ *
+ *	[2]	The braking velocity of a block depends only on the blocks after it, and the
+ *		velocities of a block only on its braking velocity and the blocks before it.
+ *		So when a new block is added the backward pass only has to go back until the
+ *		braking velocities stop changing - usually a few blocks, where a junction or the
+ *		cruise velocity caps it. The block where that happens is replanned (its next
+ *		block changed), everything before it is left alone. Only planned (QUEUED) lines
+ *		can be the frontier - a line that has never been through the forward pass still
+ *		carries the braking velocity mp_aline() gave it. mp_reset_replannable_list()
+ *		puts every block back in PLANNING, which forces a walk of the whole list.
+ *
+ *	[3]	mp_calculate_trapezoid() is a function of the block and its requested entry,
+ *		cruise (always cruise_vmax) and exit velocities. It may lower the exit velocity
+ *		it was given, so the request is kept in requested_exit_velocity for comparison.
  */
 void mp_plan_block_list(mpBuf_t *bf)
 {
     plan_debug_pin2 = 1;
+    BENCH(bench_plan_begin(mb.time_in_run + mb.time_in_planner));
 
 #ifdef DEBUG
     volatile uint32_t start_time = SysTickTimer.getValue();
@@ -256,18 +489,26 @@ void mp_plan_block_list(mpBuf_t *bf)
 
 	// Backward planning pass. Find first block and update the braking velocities.
 	// At the end *bp points to the buffer before the first block.
+	// Stop early at the planned frontier: a planned line whose braking velocity comes out
+	// the same as last time. Nothing before it can change, so it becomes the first block. [Note 2]
 	while ((bp = mp_get_prev_buffer(bp)) != bf) {
 		if (bp->replannable == false || bp->locked == true) {
             break;
         }
-		bp->braking_velocity = min(bp->nx->entry_vmax, bp->nx->braking_velocity) + bp->delta_vmax;
+        float braking_velocity = min(bp->nx->entry_vmax, bp->nx->braking_velocity) + bp->delta_vmax;
+        if (mp_is_motion(bp) && (bp->buffer_state == MP_BUFFER_QUEUED) &&
+            fp_EQ(braking_velocity, bp->braking_velocity)) {
+            bp = mp_get_prev_buffer(bp);
+            break;
+        }
+		bp->braking_velocity = braking_velocity;
 	}
 
 	// forward planning pass - recomputes trapezoids in the list from the first block to the bf block.
 	while ((bp = mp_get_next_buffer(bp)) != bf) {
 
         // plan dwells, commands and other move types
-        if (bp->move_type != MOVE_TYPE_ALINE) {
+        if (!mp_is_motion(bp)) {
             bp->replannable = false;
             if (bp->buffer_state == MP_BUFFER_PLANNING) {
                 bp->buffer_state = MP_BUFFER_QUEUED;
@@ -280,26 +521,36 @@ void mp_plan_block_list(mpBuf_t *bf)
         }
 
         // plan lines
+        float entry_velocity;
 		if (bp->pv == bf)  {
-			bp->entry_velocity = bp->entry_vmax;		// first block in the list
+			entry_velocity = bp->entry_vmax;			// first block in the list
 		} else {
-			bp->entry_velocity = bp->pv->exit_velocity;	// other blocks in the list
+			entry_velocity = bp->pv->exit_velocity;		// other blocks in the list
 		}
-		bp->cruise_velocity = bp->cruise_vmax;
-		bp->exit_velocity = min4( bp->exit_vmax, bp->nx->entry_vmax, bp->nx->braking_velocity,
-								 (bp->entry_velocity + bp->delta_vmax) );
+		float exit_velocity = min4( bp->exit_vmax, bp->nx->entry_vmax, bp->nx->braking_velocity,
+								   (entry_velocity + bp->delta_vmax) );
 
-        plan_debug_pin3 = 1;
-        mp_calculate_trapezoid(bp);
-        plan_debug_pin3 = 0;
+        // A planned line asked for the same entry and exit velocities gets the same trapezoid [Note 3]
+        if ((bp->buffer_state != MP_BUFFER_QUEUED) ||
+            (fp_NE(entry_velocity, bp->entry_velocity)) || (fp_NE(exit_velocity, bp->requested_exit_velocity))) {
 
-        if (fp_ZERO(bp->cruise_velocity)) { // ++++ Diagnostic - can be removed
-            rpt_exception(STAT_PLANNER_ASSERTION_FAILURE, "zero velocity in mp_plan_block_list");
-            _debug_trap();
-        }
+            bp->entry_velocity = entry_velocity;
+            bp->cruise_velocity = bp->cruise_vmax;
+            bp->exit_velocity = exit_velocity;
+            bp->requested_exit_velocity = exit_velocity;
 
-        // Force a calculation of this here
-        bp->real_move_time = ((bp->head_length*2)/(bp->entry_velocity + bp->cruise_velocity)) + (bp->body_length/bp->cruise_velocity) + ((bp->tail_length*2)/(bp->exit_velocity + bp->cruise_velocity));
+            plan_debug_pin3 = 1;
+            mp_calculate_trapezoid(bp);
+            plan_debug_pin3 = 0;
+
+            if (fp_ZERO(bp->cruise_velocity)) { // ++++ Diagnostic - can be removed
+                rpt_exception(STAT_PLANNER_ASSERTION_FAILURE, "zero velocity in mp_plan_block_list");
+                _debug_trap();
+            }
+
+            // Force a calculation of this here
+            bp->real_move_time = ((bp->head_length*2)/(bp->entry_velocity + bp->cruise_velocity)) + (bp->body_length/bp->cruise_velocity) + ((bp->tail_length*2)/(bp->exit_velocity + bp->cruise_velocity));
+        }
 
 		// Test for optimally planned trapezoids - only need to check various exit conditions
         if  ( ((fp_EQ(bp->exit_velocity, bp->exit_vmax)) ||
@@ -319,7 +570,7 @@ void mp_plan_block_list(mpBuf_t *bf)
         }
 	}
 
-    if (bp->move_type == MOVE_TYPE_ALINE) {
+    if (mp_is_motion(bp)) {
         // finish up the last block move
         bp->entry_velocity = bp->pv->exit_velocity; // WARNING: bp->pv might not be initied
         bp->cruise_velocity = bp->cruise_vmax;
@@ -357,14 +608,343 @@ void mp_plan_block_list(mpBuf_t *bf)
     mb.planning = false;
     mb.needs_time_accounting = true;
 
+    BENCH(bench_plan_end());
     plan_debug_pin2 = 0;
 }
 
+/*
+ * _blend_corner() - round off the corner between the previous line and a new one (G64 P)
+ *
+ *	Rather than take the corner at whatever the junction velocity allows, the path is cut
+ *	short by a distance d on both lines and joined by a circular arc tangent to both. The
+ *	arc is run as 1 to BLEND_SEGMENTS_MAX chords, each turning a fraction of the corner,
+ *	so the junctions along it are shallow and are taken at near the feed rate. The arc
+ *	radius R is set so no part of the chords is further than the P tolerance from the
+ *	corner. With phi the turn at the corner and n chords, the chord midpoints are
+ *	R*cos(phi/2n) from the center, which is R/cos(phi/2) from the corner, so:
+ *
+ *		R = P / (1/cos(phi/2) - cos(phi/2n))		d = R * tan(phi/2)
+ *
+ *	d is capped at half of either line, leaving the other half for the next corner.
+ *	The chords are limited to the centripetal velocity sqrt(R * junction_acceleration).
+ *
+ *	The previous line must be a straight feed or traverse that is still queued and not
+ *	locked - it's shortened to end where the blend starts. Anything else (arcs, exact stop,
+ *	inverse time, homing and probing, near-straight or reversing corners, chords too short
+ *	to be worth a buffer) leaves the corner to the junction velocity as before.
+ */
+
+static bool _straight_motion(const uint8_t motion_mode)
+{
+	return ((motion_mode == MOTION_MODE_STRAIGHT_FEED) || (motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE));
+}
+
+/*
+ * _claim_for_planning() - put a queued line back in PLANNING before rewriting it
+ *
+ *	The exec only starts QUEUED buffers, and _planner_time_accounting() only locks QUEUED
+ *	ones, both from the exec interrupt. So the line is checked and put in PLANNING with
+ *	interrupts off, the way mp_feed_rate_override() does it. Returns false if the exec has
+ *	started or locked it since it was looked at - leave it alone then.
+ */
+
+static bool _claim_for_planning(mpBuf_t *bp)
+{
+	__disable_irq();
+	if ((bp == mb.r) || (bp->locked) ||
+		((bp->buffer_state != MP_BUFFER_PLANNING) && (bp->buffer_state != MP_BUFFER_QUEUED))) {
+		__enable_irq();
+		return (false);
+	}
+	bp->buffer_state = MP_BUFFER_PLANNING;
+	__enable_irq();
+	return (true);
+}
+
+static void _blend_corner(GCodeState_t *gm_in)
+{
+	if ((gm_in->path_control != PATH_CONTINUOUS) || (cm.gmx.path_tolerance <= 0) ||
+		(gm_in->feed_rate_mode == INVERSE_TIME_MODE) || (!_straight_motion(gm_in->motion_mode)) ||
+		((cm.cycle_state != CYCLE_OFF) && (cm.cycle_state != CYCLE_MACHINING))) {
+		return;
+	}
+	mpBuf_t *bp = mp_get_prev_buffer(mb.q);			// the last line queued ends at the corner
+	GCodeState_t *gp = mp_get_buffer_gm(bp);
+	if ((bp == mb.r) || (bp->locked) || (bp->move_type != MOVE_TYPE_ALINE) ||
+		((bp->buffer_state != MP_BUFFER_PLANNING) && (bp->buffer_state != MP_BUFFER_QUEUED)) ||
+		(gp->path_control == PATH_EXACT_STOP) || (!_straight_motion(gp->motion_mode))) {
+		return;
+	}
+
+	float corner[AXES];
+	float unit[AXES];
+	float length = 0;
+	float costheta = 0;
+
+	copy_vector(corner, mm.position);
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		unit[axis] = gm_in->target[axis] - corner[axis];
+		length += square(unit[axis]);
+	}
+	length = sqrt(length);
+	if (fp_ZERO(length)) {
+		return;
+	}
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		unit[axis] /= length;
+		costheta += bp->unit[axis] * unit[axis];
+	}
+	if ((costheta > 0.99) || (costheta < -0.99)) {	// straight line and reversal cases
+		return;
+	}
+
+	float angle = acos(costheta);
+	uint8_t segments = min((uint8_t)ceil(angle / BLEND_SEGMENT_ANGLE), (uint8_t)BLEND_SEGMENTS_MAX);
+	if (mp_get_planner_buffers_available() <= segments) {	// leave one for the line
+		return;
+	}
+	float cos_half = cos(angle/2);
+	float tan_half = tan(angle/2);
+	float radius = cm.gmx.path_tolerance / (1/cos_half - cos(angle / (2*segments)));
+	float d = radius * tan_half;
+	float d_max = min(bp->length, length) / 2;
+	if (d > d_max) {
+		d = d_max;
+		radius = d / tan_half;
+	}
+	if ((2 * radius * sin(angle / (2*segments))) < BLEND_MIN_SEGMENT_LENGTH) {
+		return;
+	}
+
+	// the arc starts d back along the previous line. Its center is on the bisector of the corner
+	float bisector = 2 * sin(angle/2);				// length of (unit - bp->unit)
+	float start[AXES];
+	float center[AXES];
+	float radial[AXES];
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		start[axis] = corner[axis] - bp->unit[axis] * d;
+		center[axis] = corner[axis] + (unit[axis] - bp->unit[axis]) / bisector * (radius / cos_half);
+		radial[axis] = start[axis] - center[axis];
+	}
+
+	// put the previous line back in planning, and shorten it to end at the start of the arc
+	mb.planning = true;
+	if (!_claim_for_planning(bp)) {
+		mb.planning = false;
+		return;
+	}
+	bp->length -= d;
+	copy_vector(gp->target, start);
+	bp->delta_vmax = mp_get_target_velocity(0, bp->length, bp);
+	bp->braking_velocity = bp->delta_vmax;
+	bp->exit_vmax = min(bp->cruise_vmax, (bp->entry_vmax + bp->delta_vmax));
+	bp->replannable = true;
+	mb.planning = false;
+	copy_vector(mm.position, start);
+
+	// queue the chords. The last one ends d along the new line
+	GCodeState_t chord;
+	memcpy(&chord, gm_in, sizeof(GCodeState_t));
+	float vmax = sqrt(radius * cm.junction_acceleration);
+	for (uint8_t i=1; i<=segments; i++) {
+		float theta = angle * i / segments;
+		for (uint8_t axis=0; axis<AXES; axis++) {
+			if (i == segments) {
+				chord.target[axis] = corner[axis] + unit[axis] * d;
+			} else {
+				chord.target[axis] = center[axis] + radial[axis] * cos(theta) + bp->unit[axis] * radius * sin(theta);
+			}
+		}
+		_aline(&chord, vmax);
+	}
+}
+
+/*
+ * _coalesce_line() - merge a new line into the previous one if it carries straight on
+ *
+ *	CAM output often breaks a straight cut into many short collinear lines. Each one would
+ *	take a buffer, a trapezoid, and at least MIN_SEGMENT_USEC in the runtime. Instead the
+ *	previous line is extended to end at the new target, as long as:
+ *
+ *	  -	the new line turns less than $cla degrees from it, and the corner that's dropped (and
+ *		any dropped before it) stays within $clt of the extended line
+ *	  -	both are straight feeds or traverses with the same feed rate, units, coordinate
+ *		system, offsets and tool, and neither is exact stop or inverse time
+ *	  -	the previous line and the one before it are still free to be replanned (queued, not
+ *		locked or running), since the junction between them moves a little
+ *
+ *	The extended line reports the line number of the last line merged into it.
+ *	Returns true if the line was merged, in which case the planner position is its target.
+ *
+ *	The error bound: the dropped corner C is e from the new line S->T. Points on the old
+ *	line S->C are no further than e, as they go from 0 at S to e at C. A corner dropped
+ *	earlier was within coalesce_error of S->C, so it's within coalesce_error + e of S->T.
+ */
+
+static bool _coalesce_line(GCodeState_t *gm_in)
+{
+	if ((cm.coalesce_tolerance <= 0) || (gm_in->path_control == PATH_EXACT_STOP) ||
+		(gm_in->feed_rate_mode == INVERSE_TIME_MODE) || (!_straight_motion(gm_in->motion_mode)) ||
+		((cm.cycle_state != CYCLE_OFF) && (cm.cycle_state != CYCLE_MACHINING))) {
+		return (false);
+	}
+	mpBuf_t *bp = mp_get_prev_buffer(mb.q);			// the last line queued
+	GCodeState_t *gp = mp_get_buffer_gm(bp);
+	if ((bp == mb.r) || (bp->locked) || (bp->move_type != MOVE_TYPE_ALINE) ||
+		((bp->buffer_state != MP_BUFFER_PLANNING) && (bp->buffer_state != MP_BUFFER_QUEUED)) ||
+		(mp_is_motion(bp->pv) && ((bp->pv == mb.r) || (bp->pv->locked)))) {
+		return (false);
+	}
+	if ((gp->motion_mode != gm_in->motion_mode) || (gp->path_control != gm_in->path_control) ||
+		(gp->feed_rate_mode != gm_in->feed_rate_mode) || (fp_NE(gp->feed_rate, gm_in->feed_rate)) ||
+		(gp->units_mode != gm_in->units_mode) || (gp->coord_system != gm_in->coord_system) ||
+		(gp->absolute_override != gm_in->absolute_override) || (gp->tool != gm_in->tool)) {
+		return (false);
+	}
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		if (fp_NE(gp->work_offset[axis], gm_in->work_offset[axis])) {
+			return (false);
+		}
+	}
+
+	// test the turn at the corner
+	float length = 0;
+	float costheta = 0;
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		float step = gm_in->target[axis] - mm.position[axis];
+		length += square(step);
+		costheta += bp->unit[axis] * step;
+	}
+	length = sqrt(length);
+	if (fp_ZERO(length)) {
+		return (false);								// _aline() rejects it
+	}
+	costheta /= length;
+	if ((costheta <= 0) || (costheta < cos(cm.coalesce_angle / RADIAN))) {
+		return (false);
+	}
+
+	// test the corner's distance from the extended line
+	float axis_length[AXES];
+	float axis_square[AXES];
+	float length_square = 0;
+	float along = 0;								// C-S projected on T-S, times |T-S|
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		float start = mm.position[axis] - bp->unit[axis] * bp->length;
+		axis_length[axis] = gm_in->target[axis] - start;
+		axis_square[axis] = square(axis_length[axis]);
+		length_square += axis_square[axis];
+		along += (mm.position[axis] - start) * axis_length[axis];
+	}
+	length = sqrt(length_square);
+	along /= length;
+	float error = sqrt(max(square(bp->length) - square(along), (float)0)) + bp->coalesce_error;
+	if (error > cm.coalesce_tolerance) {
+		return (false);
+	}
+
+	// put the previous line and the one before it back in planning, and extend it to the new target
+	mb.planning = true;
+	if (!_claim_for_planning(bp)) {
+		mb.planning = false;
+		return (false);
+	}
+	memcpy(gp, gm_in, sizeof(GCodeState_t));
+	_calculate_move_times(gp, axis_length, axis_square);
+	bp->length = length;
+	bp->coalesce_error = error;
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		bp->unit[axis] = axis_length[axis] / length;
+		bp->unit_flags[axis] = (fabs(bp->unit[axis]) > 0);
+	}
+	_calculate_jerk(bp, bp->unit);
+	bp->cruise_vset = bp->length / gp->move_time;
+	bp->absolute_vmax = bp->length / gp->minimum_time;
+	bp->cruise_vmax = mp_get_override_vmax(bp);
+	bp->delta_vmax = mp_get_target_velocity(0, bp->length, bp);
+	bp->braking_velocity = bp->delta_vmax;
+	bp->entry_vmax = _calculate_junction_vmax(bp);
+	bp->exit_vmax = min(bp->cruise_vmax, (bp->entry_vmax + bp->delta_vmax));
+	bp->replannable = true;
+	if (mp_is_motion(bp->pv)) {
+		bp->pv->replannable = true;
+	}
+	mb.planning = false;
+	copy_vector(mm.position, gm_in->target);
+	mb.needs_replanned = true;
+	return (true);
+}
+
+/*
+ * _carry_line()	   - hold back a line that is too short to run
+ * mp_commit_carry()   - queue a carried line on its own
+ *
+ *	A line that would take less than a minimum segment at its feed rate can't be run as it
+ *	is - the trapezoid generator would stretch it to a minimum segment, and that slows the
+ *	lines on either side of it down to the crawl it runs at. Instead the line isn't queued
+ *	and the planner position isn't advanced, so the next line starts where the short one
+ *	did and runs its displacement as part of a normal line. Nothing is lost, and a string of
+ *	micro-moves carries along until it adds up to a runnable line.
+ *
+ *	A carried line is run on its own (at the reduced velocity) if anything else is queued
+ *	after it, if the planner position is set, or if no line follows within PLANNER_TIMEOUT_MS.
+ *	A queue flush drops it with the rest of the planner.
+ *
+ *	G93 lines and the moves of homing, probing and the other cycles are neither carried nor
+ *	take a carried line in - a G93 line's time is set by its F word, and a cycle move has to
+ *	go exactly where it's sent. A line carried before one of them is run on its own first.
+ *	The move time is worked out on a copy, as _calculate_move_times() can rewrite the state.
+ */
+
+static bool _carry_line(GCodeState_t *gm_in)
+{
+	float axis_length[AXES];
+	float axis_square[AXES];
+	float length_square = 0;
+
+	if ((gm_in->feed_rate_mode == INVERSE_TIME_MODE) ||
+		((cm.cycle_state != CYCLE_OFF) && (cm.cycle_state != CYCLE_MACHINING))) {
+		mp_commit_carry();
+		return (false);
+	}
+	mm.carry = false;								// this line takes in any line carried so far
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		axis_length[axis] = gm_in->target[axis] - mm.position[axis];
+		axis_square[axis] = square(axis_length[axis]);
+		length_square += axis_square[axis];
+	}
+	if (fp_ZERO(length_square)) {					// _aline() rejects it
+		return (false);
+	}
+	GCodeState_t gm;
+	memcpy(&gm, gm_in, sizeof(GCodeState_t));
+	_calculate_move_times(&gm, axis_length, axis_square);
+	if (gm.move_time >= MIN_SEGMENT_TIME_PLUS_MARGIN) {
+		return (false);
+	}
+	memcpy(&mm.carry_gm, gm_in, sizeof(GCodeState_t));
+	mm.carry_timer = SysTickTimer.getValue() + PLANNER_TIMEOUT_MS;
+	mm.carry = true;
+	return (true);
+}
+
+void mp_commit_carry()
+{
+	if (mm.carry) {
+		mm.carry = false;
+		_aline(&mm.carry_gm, 0);
+	}
+}
+
 /***** ALINE HELPERS *****
  * _calc_move_times()
  * _calculate_jerk()
  * _calculate_junction_vmax()
+ * _calculate_centripetal_junction_vmax()
+ * _calculate_axis_junction_vmax()
  * mp_reset_replannable_list()
+ * mp_get_override_vmax()
+ * mp_feed_rate_override()
  */
 
 /*
@@ -432,7 +1012,6 @@ static void _calculate_move_times(GCodeState_t *gms, const float axis_length[],
 	float abc_time=0;				// coordinated move rotary part at requested feed rate
 	float max_time=0;				// time required for the rate-limiting axis
 	float tmp_time=0;				// used in computation
-	gms->minimum_time = 8675309;	// arbitrarily large number
 
 	// compute times for feed motion
 	if (gms->motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE) {
@@ -456,11 +1035,8 @@ static void _calculate_move_times(GCodeState_t *gms, const float axis_length[],
 			tmp_time = fabs(axis_length[axis]) / cm.a[axis].feedrate_max;
 		}
 		max_time = max(max_time, tmp_time);
-
-		if (tmp_time > 0) { 	// collect minimum time if this axis is not zero
-			gms->minimum_time = min(gms->minimum_time, tmp_time);
-		}
 	}
+	gms->minimum_time = max_time;
 	gms->move_time = max4(inv_time, max_time, xyz_time, abc_time);
 }
 
@@ -549,7 +1125,7 @@ static void _calculate_move_times(GCodeState_t *gms, const float axis_length[],
 //#define __OLD_JERK
 #define __REVISED_JERK
 
-static void _calculate_jerk(mpBuf_t *bf)
+static void _calculate_jerk(mpBuf_t *bf, const float unit[])
 {
 
 #ifdef __FIXED_JERK
@@ -603,8 +1179,8 @@ static void _calculate_jerk(mpBuf_t *bf)
 	float jerk=0;
 
 	for (uint8_t axis=0; axis<AXES; axis++) {
-		if (fabs(bf->unit[axis]) > 0) {						// if this axis is participating in the move
-			jerk = cm.a[axis].jerk_max / fabs(bf->unit[axis]);
+		if (fabs(unit[axis]) > 0) {							// if this axis is participating in the move
+			jerk = cm.a[axis].jerk_max / fabs(unit[axis]);
 			//float j_peak = (1.64224*(800000)^2)/(v_end-v_start);
 //			jerk = cm.a[axis].jerk_max / (bf->unit[axis] * bf->unit[axis]);
 			if (jerk < bf->jerk) {
@@ -630,13 +1206,16 @@ static void _calculate_jerk(mpBuf_t *bf)
 		mm.jerk = bf->jerk;
 		mm.recip_jerk = 1/bf->jerk;							// compute cached jerk terms used by planning
 		mm.cbrt_jerk = cbrt(bf->jerk);
+		mm.sqrt_jerk = sqrt(bf->jerk);
 	}
 	bf->recip_jerk = mm.recip_jerk;
 	bf->cbrt_jerk = mm.cbrt_jerk;
+	bf->sqrt_jerk = mm.sqrt_jerk;
 
 /*	// use this form if you don't want the caching
 	bf->recip_jerk = 1/bf->jerk;
 	bf->cbrt_jerk = cbrt(bf->jerk);
+	bf->sqrt_jerk = sqrt(bf->jerk);
 */
 }
 
@@ -670,7 +1249,36 @@ static void _scale_jerk_to_acceleration(const float Vi, const float Vt, mpBuf_t
 }
 */
 /*
- * _calculate_junction_vmax() - Sonny's algorithm - simple
+ * _calculate_junction_vmax() - max velocity through the corner at the start of bf
+ *
+ *	The corner is between the previous move's direction and this one's. How it's limited
+ *	depends on the junction model ($jt): the centripetal model fits one radius to the corner
+ *	and limits the velocity through it by the junction acceleration, the per-axis model
+ *	limits the velocity step each axis has to take at the corner (see below).
+ */
+
+static float _calculate_junction_vmax(mpBuf_t *bf)
+{
+	const float *a_unit = bf->pv->unit;
+	float exit_unit[AXES];
+
+	if (bf->pv->move_type == MOVE_TYPE_ARC) {			// an arc leaves along its tangent at the end
+		copy_vector(exit_unit, bf->pv->unit);
+		mp_set_arc_unit(&mp_get_buffer_curve(bf->pv)->arc, bf->pv->length, 1, exit_unit);
+		a_unit = exit_unit;
+	} else if (bf->pv->move_type == MOVE_TYPE_SPLINE) {	// ...and so does a spline
+		copy_vector(exit_unit, bf->pv->unit);
+		mp_set_spline_unit(&mp_get_buffer_curve(bf->pv)->spline, bf->pv->length, true, exit_unit);
+		a_unit = exit_unit;
+	}
+	if (cm.junction_model == JUNCTION_PER_AXIS) {
+		return (_calculate_axis_junction_vmax(bf, a_unit));
+	}
+	return (_calculate_centripetal_junction_vmax(bf->cruise_vmax, a_unit, bf->unit));
+}
+
+/*
+ * _calculate_centripetal_junction_vmax() - Sonny's algorithm - simple
  *
  *  Computes the maximum allowable junction speed by finding the velocity that will yield
  *	the centripetal acceleration in the corner_acceleration value. The value of delta sets
@@ -728,7 +1336,7 @@ static void _scale_jerk_to_acceleration(const float Vi, const float Vt, mpBuf_t
  */
 
 //static float _calculate_junction_vmax(const float a_unit[], const float b_unit[])
-static float _calculate_junction_vmax(const float vmax, const float a_unit[], const float b_unit[])
+static float _calculate_centripetal_junction_vmax(const float vmax, const float a_unit[], const float b_unit[])
 {
 	float costheta = - (a_unit[AXIS_X] * b_unit[AXIS_X])
 					 - (a_unit[AXIS_Y] * b_unit[AXIS_Y])
@@ -776,6 +1384,59 @@ static float _calculate_junction_vmax(const float vmax, const float a_unit[], co
 //    return((radius * cm.junction_acceleration) / delta);
 }
 
+/*
+ * _calculate_axis_junction_vmax() - per-axis junction model
+ *
+ *	At a corner taken at velocity V each axis's velocity steps by V * |b[n] - a[n]|, where
+ *	a and b are the unit vectors of the moves on either side. The segments run that step
+ *	as it comes, so it's the axis's drive that smooths it out, and an axis with low jerk
+ *	(a heavy gantry, a screw driven Z) falls further behind the path doing that than a
+ *	light one. The axis junction deviation is taken as the most it may fall behind.
+ *
+ *	Following a step dV symmetrically with jerk J, the axis is furthest from the path
+ *	halfway through the change, by the distance covered in the first half:
+ *
+ *		e = dV^(3/2) / (6*sqrt(J))			so	dV = cbrt(36 * delta^2 * J)
+ *
+ *	That's as long as the peak acceleration sqrt(dV*J) stays under the junction
+ *	acceleration A. Past that the change is ramped at A and the same working gives
+ *
+ *		dV = 2*sqrt(2*A*delta - (A^2/J)^2 / 12)
+ *
+ *	The two agree where the peak acceleration reaches A (dV = A^2/J). Each axis that
+ *	changes direction allows V = dV[n] / |b[n] - a[n]|; the slowest of them is the binding
+ *	axis and sets the junction velocity. A corner is only held down by the axes it
+ *	actually turns, each against its own limits, rather than by one blended radius.
+ */
+
+static float _axis_junction_step(const uint8_t axis)
+{
+	float delta = cm.a[axis].junction_dev;
+	float jerk = cm.a[axis].jerk_max * JERK_MULTIPLIER;
+	float accel = cm.junction_acceleration;
+
+	float step = cbrt(36 * delta * delta * jerk);
+	if (step * jerk > accel * accel) {					// acceleration limited
+		float a2_over_j = accel * accel / jerk;
+		step = 2 * sqrt(2 * accel * delta - a2_over_j * a2_over_j / 12);
+	}
+	return (step);
+}
+
+static float _calculate_axis_junction_vmax(mpBuf_t *bf, const float a_unit[])
+{
+	float velocity = bf->cruise_vmax;
+
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		float change = fabs(bf->unit[axis] - a_unit[axis]);
+		if (change * velocity > EPSILON) {				// otherwise the axis hardly turns at this corner
+			float axis_velocity = _axis_junction_step(axis) / change;
+			velocity = min(velocity, axis_velocity);
+		}
+	}
+	return (velocity);
+}
+
 /*
  *	mp_reset_replannable_list() - resets all blocks in the planning list to be replannable
  */
@@ -793,3 +1454,86 @@ void mp_reset_replannable_list()
     mb.needs_replanned = true;
     mb.needs_time_accounting = true;
 }
+
+/*
+ * mp_get_override_vmax() - cruise velocity of a line with the current override applied
+ *
+ *	Feeds (and arcs) take the feed rate override, traverses take the traverse override.
+ *	Overrides only apply to machining cycles - homing, probing and jogging run at the
+ *	velocities they ask for. Nothing goes faster than the rate-limiting axis allows.
+ */
+float mp_get_override_vmax(const mpBuf_t *bf)
+{
+	float factor = 1.0;
+
+	if ((cm.cycle_state == CYCLE_OFF) || (cm.cycle_state == CYCLE_MACHINING)) {
+		if (mp_get_buffer_gm(bf)->motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
+			if (cm.gmx.traverse_override_enable) { factor = cm.gmx.traverse_override_factor; }
+		} else {
+			if (cm.gmx.feed_rate_override_enable) { factor = cm.gmx.feed_rate_override_factor; }
+		}
+	}
+	return (min(bf->cruise_vset * factor, bf->absolute_vmax));
+}
+
+/*
+ * mp_feed_rate_override() - apply a new feed or traverse override to the queued moves
+ *
+ *	Called when an override factor or enable changes. Every line that is not yet locked
+ *	gets a new cruise_vmax (and the junction and exit limits that follow from it) and is
+ *	put back into PLANNING, and a replan is forced. Nothing is flushed - the replan is
+ *	bounded by the unlocked part of the queue, the same as adding a block to a full queue.
+ *
+ *	The running move and the locked moves are planned into the runtime's future and
+ *	can't be changed here. The exec picks up the new override for those at their next
+ *	section boundary - see _exec_aline_override() in plan_exec.cpp. Their exit velocities
+ *	stand, so a lower override can't take the first unlocked lines below what they can
+ *	decelerate from: 'carry' is that velocity, less delta_vmax for each line it crosses.
+ *
+ *	This runs from the main loop while the exec interrupt is taking buffers, so it works
+ *	the way the replanner does: mb.planning is set for the duration, and each line is put
+ *	in PLANNING before any of it is rewritten, as the exec only starts QUEUED buffers. The
+ *	walk stops at the buffer the exec is running. The check and the state change are done
+ *	with interrupts off so the exec can't start the line in between.
+ */
+
+void mp_feed_rate_override()
+{
+	mpBuf_t *bf = mp_get_first_buffer();
+	if (bf == NULL) return;
+	mpBuf_t *bp = bf;
+	float carry = (mp_is_motion(bf)) ? bf->exit_velocity : 0;
+
+	mb.planning = true;
+	while (((bp = mp_get_next_buffer(bp)) != bf) && (bp != mb.q)) {
+		if ((bp->buffer_state == MP_BUFFER_EMPTY) || (bp == mb.r)) {
+			break;
+		}
+		if (bp->locked) {
+			carry = (mp_is_motion(bp)) ? bp->exit_velocity : 0;
+			continue;
+		}
+		bp->replannable = true;							// commands too, so the backward pass goes through them
+		if (!mp_is_motion(bp)) {
+			carry = 0;
+			continue;
+		}
+		__disable_irq();
+		if ((bp == mb.r) || (bp->buffer_state == MP_BUFFER_RUNNING)) {
+			__enable_irq();
+			break;										// the exec has got this far
+		}
+		bp->buffer_state = MP_BUFFER_PLANNING;
+		__enable_irq();
+		bp->cruise_vmax = min(max(mp_get_override_vmax(bp), carry), bp->absolute_vmax);
+		carry = max(carry - bp->delta_vmax, (float)0);
+		if (mp_get_buffer_gm(bp)->path_control != PATH_EXACT_STOP) {
+			bp->entry_vmax = _calculate_junction_vmax(bp);
+			bp->exit_vmax = min(bp->cruise_vmax, (bp->entry_vmax + bp->delta_vmax));
+		}
+	}
+	mb.planning = false;
+	mb.needs_replanned = true;
+	mb.force_replan = true;
+	mb.needs_time_accounting = true;
+}
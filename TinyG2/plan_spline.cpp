@@ -0,0 +1,362 @@
+/*
+ * plan_spline.cpp - spline planning and motion execution
+ * This file is part of the TinyG project
+ *
+ * Copyright (c) 2010 - 2015 Alden S. Hart, Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/* Like plan_arc.cpp this has the canonical machine entry point for G5 and G5.1 and the
+ * spline geometry the planner and runtime use, all treated as part of the motion planner.
+ */
+
+#include "tinyg2.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "util.h"
+
+#ifndef __FIXED_POINT_EXEC				// cm_spline_feed() is a stub there
+static float _end_offset[2];			// P and Q of the last G5 - the next one's I and J default to minus these
+#endif
+
+// Local functions
+static void _get_spline_coefficients(const mpSplineMove_t *spline, float coeff[3][2]);
+#ifndef __FIXED_POINT_EXEC
+static void _get_spline_point(const mpSplineMove_t *spline, const float u, float point[2]);
+#endif
+static void _walk_sync(mpSplineWalk_t *walk);
+
+/*****************************************************************************
+ * cm_spline_feed() - canonical machine entry point for G5 and G5.1
+ *
+ *	G5 X Y I J P Q is a cubic Bezier curve from the current point to X Y. I J is the first
+ *	control point's offset from the start, P Q the second's offset from the end. I and J may
+ *	be left off a G5 that follows a G5, and then continue the previous curve smoothly - the
+ *	first control point is the previous second one reflected through the start.
+ *
+ *	G5.1 X Y I J is a quadratic curve with its one control point at I J from the start. It's
+ *	raised to the cubic with the same shape: control points 2/3 of the way from each end to I J.
+ *
+ *	Splines are G17 (XY) only. Any other axes move linearly along them, as along a helix.
+ *	The curve is queued as a single MOVE_TYPE_SPLINE planner block (see mp_spline()).
+ *
+ *	The fixed-point exec (__FIXED_POINT_EXEC) only runs straight lines and arcs, so
+ *	splines are unsupported there.
+ */
+
+stat_t cm_spline_feed(const float target[], const float flags[],   // spline endpoints
+					  const float i, const float j,                // first control point offset from the start
+					  const float p, const float q,                // second control point offset from the end (G5)
+					  const uint8_t motion_mode)                   // G5 or G5.1
+{
+#ifdef __FIXED_POINT_EXEC
+	return (STAT_GCODE_COMMAND_UNSUPPORTED);
+#else
+	// trap missing feed rate
+	if ((cm.gm.feed_rate_mode != INVERSE_TIME_MODE) && (fp_ZERO(cm.gm.feed_rate))) {
+		return (STAT_GCODE_FEEDRATE_NOT_SPECIFIED);
+	}
+	if (cm.gm.select_plane != CANON_PLANE_XY) {
+		return (STAT_GCODE_ACTIVE_PLANE_IS_INVALID);
+	}
+	bool offset_i = fp_NOT_ZERO(cm.gf.arc_offset[0]);			// set true if offset I has been specified
+	bool offset_j = fp_NOT_ZERO(cm.gf.arc_offset[1]);			// J
+	if (fp_NOT_ZERO(cm.gf.arc_offset[2])) {						// K is an error in G17
+		return (STAT_SPLINE_SPECIFICATION_ERROR);
+	}
+
+	float start_offset[2];
+	start_offset[0] = _to_millimeters(i);
+	start_offset[1] = _to_millimeters(j);
+	if (motion_mode == MOTION_MODE_CUBIC_SPLINE) {
+		if (fp_ZERO(cm.gf.parameter)) {
+			return (STAT_P_WORD_IS_MISSING);
+		}
+		if (fp_ZERO(cm.gf.Q_word)) {
+			return (STAT_Q_WORD_IS_MISSING);
+		}
+		if (offset_i != offset_j) {								// both or neither
+			return (STAT_SPLINE_SPECIFICATION_ERROR);
+		}
+		if (!offset_i) {
+			if (cm.gm.motion_mode != MOTION_MODE_CUBIC_SPLINE) {	// only a G5 can follow on from a G5
+				return (STAT_SPLINE_SPECIFICATION_ERROR);
+			}
+			start_offset[0] = -_end_offset[0];
+			start_offset[1] = -_end_offset[1];
+		}
+	} else if (!(offset_i || offset_j)) {						// G5.1 needs at least one of them
+		return (STAT_SPLINE_SPECIFICATION_ERROR);
+	}
+
+	// set values in the Gcode model state (linenum was already captured)
+	cm_set_model_target(target, flags);
+
+	mpSplineMove_t spline;
+	spline.plane_axis_0 = AXIS_X;
+	spline.plane_axis_1 = AXIS_Y;
+	for (uint8_t k=0; k<2; k++) {
+		uint8_t axis = (k == 0) ? AXIS_X : AXIS_Y;
+		spline.point[0][k] = cm.gmx.position[axis];
+		spline.point[3][k] = cm.gm.target[axis];
+		if (motion_mode == MOTION_MODE_CUBIC_SPLINE) {
+			spline.point[1][k] = spline.point[0][k] + start_offset[k];
+			spline.point[2][k] = spline.point[3][k] + ((k == 0) ? _to_millimeters(p) : _to_millimeters(q));
+		} else {
+			float control = spline.point[0][k] + start_offset[k];
+			spline.point[1][k] = spline.point[0][k] + (control - spline.point[0][k]) * 2/3;
+			spline.point[2][k] = spline.point[3][k] + (control - spline.point[3][k]) * 2/3;
+		}
+	}
+
+	// test soft limits along the curve - the ends and points between (the other axes can't bulge)
+	float point[AXES];
+	float plane_point[2];
+	copy_vector(point, cm.gm.target);
+	for (uint8_t n=1; n<=SPLINE_INTERVALS; n++) {
+		_get_spline_point(&spline, (float)n / SPLINE_INTERVALS, plane_point);
+		point[AXIS_X] = plane_point[0];
+		point[AXIS_Y] = plane_point[1];
+		stat_t status = cm_test_soft_limits(point);
+		if (status != STAT_OK) {
+			copy_vector(cm.gm.target, cm.gmx.position);			// reset model position
+			return (status);
+		}
+	}
+	if (motion_mode == MOTION_MODE_CUBIC_SPLINE) {
+		_end_offset[0] = spline.point[2][0] - spline.point[3][0];
+		_end_offset[1] = spline.point[2][1] - spline.point[3][1];
+	}
+
+	cm.gm.motion_mode = motion_mode;
+	cm_set_work_offsets(&cm.gm);					// capture the fully resolved offsets to the state
+	cm_cycle_start();								// if not already started
+	stat_t status = mp_spline(&cm.gm, &spline);
+	cm_finalize_move();
+	if (status == STAT_MINIMUM_LENGTH_MOVE && !mp_has_runnable_buffer()) {	// same as cm_straight_feed()
+		cm_cycle_end();
+		return (STAT_OK);
+	}
+	return (status);
+#endif
+}
+
+/*
+ * _get_spline_coefficients() - the spline as a polynomial in u, less its start point
+ * _get_spline_point()		  - the point on the plane a fraction u of the way along the curve
+ *
+ *	B(u) = a*u^3 + b*u^2 + c*u + P0, coeff[] is { a, b, c }
+ */
+
+static void _get_spline_coefficients(const mpSplineMove_t *spline, float coeff[3][2])
+{
+	for (uint8_t k=0; k<2; k++) {
+		float p0 = spline->point[0][k];
+		float p1 = spline->point[1][k];
+		float p2 = spline->point[2][k];
+		float p3 = spline->point[3][k];
+		coeff[0][k] = p3 - 3*p2 + 3*p1 - p0;
+		coeff[1][k] = 3 * (p2 - 2*p1 + p0);
+		coeff[2][k] = 3 * (p1 - p0);
+	}
+}
+
+#ifndef __FIXED_POINT_EXEC
+static void _get_spline_point(const mpSplineMove_t *spline, const float u, float point[2])
+{
+	float coeff[3][2];
+	_get_spline_coefficients(spline, coeff);
+	for (uint8_t k=0; k<2; k++) {
+		point[k] = ((coeff[0][k] * u + coeff[1][k]) * u + coeff[2][k]) * u + spline->point[0][k];
+	}
+}
+#endif
+
+/*
+ * mp_measure_spline() - set the spline's planar length and return its largest curvature
+ *
+ *	The length is Simpson's rule over SPLINE_INTERVALS of |B'(u)|. The curvature
+ *
+ *		k(u) = |B'(u) x B''(u)| / |B'(u)|^3
+ *
+ *	is taken at the same points. Where B' is zero the curve has no tangent; that point is
+ *	left out and its neighbours stand in for it.
+ */
+
+float mp_measure_spline(mpSplineMove_t *spline)
+{
+	float coeff[3][2];
+	float length = 0;
+	float curvature = 0;
+
+	_get_spline_coefficients(spline, coeff);
+	for (uint8_t n=0; n<=SPLINE_INTERVALS; n++) {
+		float u = (float)n / SPLINE_INTERVALS;
+		float d1[2], d2[2];
+		for (uint8_t k=0; k<2; k++) {
+			d1[k] = (3*coeff[0][k] * u + 2*coeff[1][k]) * u + coeff[2][k];
+			d2[k] = 6*coeff[0][k] * u + 2*coeff[1][k];
+		}
+		float speed = sqrt(square(d1[0]) + square(d1[1]));
+		length += speed * (((n == 0) || (n == SPLINE_INTERVALS)) ? 1 : ((n & 1) ? 4 : 2));
+		if (fp_NOT_ZERO(speed)) {
+			curvature = max(curvature, (float)fabs(d1[0]*d2[1] - d1[1]*d2[0]) / (speed * speed * speed));
+		}
+	}
+	spline->planar_length = length / (3 * SPLINE_INTERVALS);
+	return (curvature);
+}
+
+/*
+ * mp_spline_walk_init() - start walking a spline from its start
+ * mp_next_spline_point() - walk on to the next point, 'step' further along the curve in the plane
+ *
+ *	The runtime only knows how far along the curve each segment ends, so it has to find the
+ *	u that's that far on. du is the step over |B'(u)|, taken at the midpoint of the step
+ *	(a second-order Runge-Kutta step along du/ds = 1/|B'|). Where B' is near zero the
+ *	curve leaves by B'' alone and du is limited to sqrt(2 * step / |B''|).
+ *
+ *	The point and its derivatives are then carried on by du with the forward differences
+ *	of the cubic - for a step h:
+ *
+ *		B   += B' * h + B'' * h^2/2 + B''' * h^3/6
+ *		B'  += B'' * h + B''' * h^2/2
+ *		B'' += B''' * h
+ *
+ *	which is exact for a cubic, and gives the midpoint tangent for the next step for the
+ *	cost of a few adds. The steps vary, so it's carried as derivatives rather than as fixed
+ *	step differences. The rounding adds up over the steps, so every SPLINE_RESYNC_MAX
+ *	steps they are evaluated from the polynomial again.
+ *
+ *	The other axes go the fraction of the way from start to end, as for an arc.
+ */
+
+void mp_spline_walk_init(mpSplineWalk_t *walk, const mpSplineMove_t *spline)
+{
+	_get_spline_coefficients(spline, walk->coeff);
+	for (uint8_t k=0; k<2; k++) {
+		walk->origin[k] = spline->point[0][k];
+		walk->d3[k] = 6 * walk->coeff[0][k];
+	}
+	walk->u = 0;
+	_walk_sync(walk);
+}
+
+static void _walk_sync(mpSplineWalk_t *walk)
+{
+	float u = walk->u;
+	for (uint8_t k=0; k<2; k++) {
+		float a = walk->coeff[0][k];
+		float b = walk->coeff[1][k];
+		float c = walk->coeff[2][k];
+		walk->point[k] = ((a * u + b) * u + c) * u + walk->origin[k];
+		walk->d1[k] = (3*a * u + 2*b) * u + c;
+		walk->d2[k] = 6*a * u + 2*b;
+	}
+	walk->count = SPLINE_RESYNC_MAX;
+}
+
+void mp_next_spline_point(const mpSplineMove_t *spline, mpSplineWalk_t *walk, const float start[], const float end[],
+						  const float fraction, const float step, float point[])
+{
+	float du = 1 - walk->u;
+	float speed = sqrt(square(walk->d1[0]) + square(walk->d1[1]));
+	float bend = sqrt(square(walk->d2[0]) + square(walk->d2[1]));
+	if (speed > 0) {
+		du = min(du, step / speed);
+	}
+	if (bend > 0) {
+		du = min(du, (float)sqrt(2 * step / bend));
+	}
+	float half = du / 2;
+	float mid[2];
+	for (uint8_t k=0; k<2; k++) {
+		mid[k] = walk->d1[k] + (walk->d2[k] + walk->d3[k] * half / 2) * half;
+	}
+	speed = sqrt(square(mid[0]) + square(mid[1]));
+	if (speed > 0) {
+		du = min(1 - walk->u, step / speed);
+	}
+
+	walk->u += du;
+	if (--walk->count == 0) {
+		_walk_sync(walk);
+	} else {
+		float du_2 = du * du / 2;
+		float du_3 = du_2 * du / 3;
+		for (uint8_t k=0; k<2; k++) {
+			walk->point[k] += walk->d1[k] * du + walk->d2[k] * du_2 + walk->d3[k] * du_3;
+			walk->d1[k] += walk->d2[k] * du + walk->d3[k] * du_2;
+			walk->d2[k] += walk->d3[k] * du;
+		}
+	}
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		point[axis] = start[axis] + (end[axis] - start[axis]) * fraction;
+	}
+	point[spline->plane_axis_0] = walk->point[0];
+	point[spline->plane_axis_1] = walk->point[1];
+}
+
+/*
+ * mp_split_spline() - cut the spline down to the part after u (de Casteljau)
+ *
+ *	'fraction' of the spline's length has been run to get to u, and 'start' is where that
+ *	was. The rest starts there rather than at the curve's own B(u) - they differ only by the
+ *	walk's rounding - so the next move picks up where the machine is.
+ */
+
+void mp_split_spline(mpSplineMove_t *spline, const float u, const float fraction, const float start[])
+{
+	for (uint8_t k=0; k<2; k++) {
+		float p12 = spline->point[1][k] + (spline->point[2][k] - spline->point[1][k]) * u;
+		float p23 = spline->point[2][k] + (spline->point[3][k] - spline->point[2][k]) * u;
+		float p123 = p12 + (p23 - p12) * u;
+		spline->point[2][k] = p23;
+		spline->point[1][k] = p123;
+	}
+	spline->point[0][0] = start[spline->plane_axis_0];
+	spline->point[0][1] = start[spline->plane_axis_1];
+	spline->planar_length *= (1 - fraction);
+}
+
+/*
+ * mp_set_spline_unit() - set the plane axes of the unit vector at the start or end
+ *
+ *	The tangent is B' there. If that's zero (a control point on the end point) the curve
+ *	leaves the start along B'', or arrives at the end against it, and failing that along B'''.
+ *	Like mp_set_arc_unit() the other axes of unit[] are left alone.
+ */
+
+void mp_set_spline_unit(const mpSplineMove_t *spline, const float length, const bool at_end, float unit[])
+{
+	const float (*p)[2] = spline->point;
+	float tangent[2];
+	float size = 0;
+
+	for (uint8_t order=1; (order<=3) && (fp_ZERO(size)); order++) {
+		for (uint8_t k=0; k<2; k++) {
+			if (order == 1) {
+				tangent[k] = (at_end) ? (p[3][k] - p[2][k]) : (p[1][k] - p[0][k]);
+			} else if (order == 2) {
+				tangent[k] = (at_end) ? (2*p[2][k] - p[1][k] - p[3][k]) : (p[2][k] - 2*p[1][k] + p[0][k]);
+			} else {
+				tangent[k] = p[3][k] - 3*p[2][k] + 3*p[1][k] - p[0][k];
+			}
+		}
+		size = sqrt(square(tangent[0]) + square(tangent[1]));
+	}
+	float scale = (fp_ZERO(size)) ? 0 : spline->planar_length / (length * size);
+	unit[spline->plane_axis_0] = tangent[0] * scale;
+	unit[spline->plane_axis_1] = tangent[1] * scale;
+}
@@ -146,6 +146,7 @@ void mp_calculate_trapezoid(mpBuf_t *bf)
 	//********************************************
 	//********************************************
 
+    BENCH(bench_trapezoid());
 	bf->head_length = 0;
 	bf->tail_length = 0;
 
@@ -432,9 +433,15 @@ void mp_calculate_trapezoid(mpBuf_t *bf)
  *
  *      TODO: fill in this section with Linear-Pop maths.
  *
+ *	mp_get_meet_velocity() and mp_get_target_velocity() come in two versions. The _ref()
+ *	versions are the original closed-form / Newton-Raphson solvers. The fast versions
+ *	(FAST_VELOCITY_SOLVERS, below) solve the same equations to a bounded error and are
+ *	used unless FAST_VELOCITY_SOLVERS is commented out. The _ref() versions are always
+ *	compiled so the host build can check one against the other.
  */
 
 #define LINEAR_SNAP_MATH
+#define FAST_VELOCITY_SOLVERS			// comment out to plan with the _ref() solvers
 
 #ifdef LINEAR_SNAP_MATH
 
@@ -474,7 +481,7 @@ float mp_get_target_length(const float v_0, const float v_1, const mpBuf_t *bf)
 // sqrt(5) / (2 sqrt(2) nroot(3,4)) = 0.60070285354
 const float mv_constant = 0.60070285354;
 
-float mp_get_meet_velocity(const float v_0, const float v_2, const float L, const mpBuf_t *bf) {
+float mp_get_meet_velocity_ref(const float v_0, const float v_2, const float L, const mpBuf_t *bf) {
     //L_d(v_0, v_1, j) = (sqrt(5) abs(v_0 - v_1) (v_0 - 3v_1)) / (2sqrt(2) 3^(1 / 4) sqrt(j abs(v_0 - v_1)) (v_0 - v_1))
     //                    sqrt(5) / (2 sqrt(2) nroot(3,4)) ( v_0 - 3 v_1) / ( sqrt(j abs(v_0 - v_1)))
     //                    sqrt(5) / (2 sqrt(2) nroot(3,4)) = 0.60070285354
@@ -492,7 +499,7 @@ float mp_get_meet_velocity(const float v_0, const float v_2, const float L, cons
 
     // v_1 is our estimated return value.
     // We estimate with the speed obtained by L/2 traveled from the highest speed of v_0 or v_2.
-    float v_1 = mp_get_target_velocity(max(v_0, v_2), L/2, bf);
+    float v_1 = mp_get_target_velocity_ref(max(v_0, v_2), L/2, bf);
     float last_v_1 = 0;
 
     // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
@@ -552,7 +559,7 @@ static const float f4_thirds_x_cbrt_5 = 2.279967928902263;
 static const float f1_15th_x_2_3_rt_5 = 0.194934515880858;
 
 
-float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t *bf)
+float mp_get_target_velocity_ref(const float v_0, const float L, const mpBuf_t *bf)
 {
     // Why const? So that the compiler knows it'll never change once it's computed.
     // Also, we ensure that it doesn't accidentally change once computed.
@@ -600,6 +607,135 @@ float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t *bf)
     return v_1;
 }
 
+#ifdef FAST_VELOCITY_SOLVERS
+
+/*
+ * Fast velocity solvers
+ *
+ *	Both solvers work in s = sqrt(v_1 - v_0) instead of v_1. With K = L * sqrt(j) / tl_constant
+ *	the length equation from mp_get_target_length() becomes
+ *
+ *		s * (v_0 + v_1) = K		where v_1 = v_0 + s^2, so
+ *		s^3 + 2*v_0*s - K = 0	a depressed cubic with exactly one positive root
+ *
+ *	_solve_cubic() seeds s from a cheap cube root (frexp/ldexp and a 3 entry table, about
+ *	1.4% error), takes the larger of the large-K guess cbrt(K) - 2*v_0/(3*cbrt(K)) and the
+ *	small-K guess K/(2*v_0 + cbrt(K)^2), then runs a fixed number of Newton steps. There is
+ *	no sqrt, no pow, no cbrt and no loop to escape from.
+ *
+ *	mp_get_meet_velocity() uses the same substitution on the higher of the two velocities
+ *	and Newton-steps the sum of the head and tail lengths. The seed is the velocity reached
+ *	from the higher velocity in L/2, which is always an upper bound. The length function is
+ *	convex in s so the Newton steps converge from above and never overshoot. Each step
+ *	costs one sqrt.
+ *
+ *	Error bounds, measured against a double precision root for K/v_0^1.5 from 1e-15 to 1e15
+ *	(target) and for every v_2/v_0 ratio and fit from touching to 1e8 times longer (meet):
+ *
+ *		iterations					1			2			3
+ *		mp_get_target_velocity()	3e-2		1e-4		3e-7
+ *		mp_get_meet_velocity()		1e-2		2e-4		3e-7
+ *
+ *	Errors are relative to (v_1 - v_0) for target velocity and to v_1 for meet velocity,
+ *	on top of the float rounding of v_1 itself (which the _ref() solvers share).
+ *	The results are never low by more than float rounding, so a solved velocity can't
+ *	leave a head or tail short of the length it needs.
+ *
+ *	On the host build each call is checked against the _ref() solver and an exact root
+ *	(see platform/host/Benchmark.h).
+ */
+
+#define TARGET_VELOCITY_ITERATIONS 2	// see table above for error vs. iterations
+#define MEET_VELOCITY_ITERATIONS 2
+
+// 1/tl_constant
+static const float recip_tl_constant = 0.8323582900575628;
+
+// cube roots of 1, 2 and 4
+static const float cbrt_pow2[3] = { 1.0, 1.259921049894873, 1.587401051968199 };
+
+static float _fast_cbrt(const float x)
+{
+    int e;
+    const float m = frexpf(x, &e);          // x = m * 2^e, m in [0.5, 1)
+    int k = (e >= 0) ? (e / 3) : -((2 - e) / 3);
+    const float c = 0.4302 + m * (0.9083 - 0.3395 * m); // quadratic fit of cbrt(m) over [0.5, 1)
+    return (ldexpf(c * cbrt_pow2[e - 3*k], k));
+}
+
+// positive root of s^3 + p*s - q, p >= 0
+static float _solve_cubic(const float p, const float q)
+{
+    if (q <= 0) {
+        return (0);
+    }
+    const float c = _fast_cbrt(q);
+    float s = c - p / (3 * c);
+    const float s_small = q / (p + c*c);
+    if (s < s_small) {
+        s = s_small;
+    }
+    for (uint8_t i=0; i<TARGET_VELOCITY_ITERATIONS; i++) {
+        const float s_sq = s*s;
+        s -= (s_sq*s + p*s - q) / (3*s_sq + p);
+    }
+    return (s);
+}
+
+float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t *bf)
+{
+    const float s = _solve_cubic(2*v_0, L * bf->sqrt_jerk * recip_tl_constant);
+    const float v_1 = v_0 + s*s;
+
+    BENCH(bench_target_velocity(v_0, L, bf, v_1));
+    return (v_1);
+}
+
+float mp_get_meet_velocity(const float v_0, const float v_2, const float L, const mpBuf_t *bf)
+{
+    const float v_hi = max(v_0, v_2);
+    const float v_lo = min(v_0, v_2);
+    const float delta_v = v_hi - v_lo;
+    const float K = L * bf->sqrt_jerk * recip_tl_constant;
+
+    // s = sqrt(v_1 - v_hi), r = sqrt(v_1 - v_lo)
+    // length(s) = s * (v_hi + v_1) + r * (v_lo + v_1) - K
+    float s = _solve_cubic(2*v_hi, K/2);
+    for (uint8_t i=0; i<MEET_VELOCITY_ITERATIONS; i++) {
+        const float s_sq = s*s;
+        const float v_1 = v_hi + s_sq;
+        const float r = sqrt(s_sq + delta_v);
+        if (fp_ZERO(r)) {
+            break;
+        }
+        const float length = s * (v_hi + v_1) + r * (v_lo + v_1) - K;
+        const float length_d = 2*v_hi + 3*s_sq + s * (v_lo + v_1) / r + 2*r*s;
+        s -= length / length_d;
+        if (s < 0) {
+            s = 0;
+            break;
+        }
+    }
+    const float v_1 = v_hi + s*s;
+
+    BENCH(bench_meet_velocity(v_0, v_2, L, bf, v_1));
+    return (v_1);
+}
+
+#else
+
+float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t *bf)
+{
+    return (mp_get_target_velocity_ref(v_0, L, bf));
+}
+
+float mp_get_meet_velocity(const float v_0, const float v_2, const float L, const mpBuf_t *bf)
+{
+    return (mp_get_meet_velocity_ref(v_0, v_2, L, bf));
+}
+
+#endif // FAST_VELOCITY_SOLVERS
+
 #else
 // Non LINEAR_SNAP_MATH math:
 
@@ -85,7 +85,7 @@ mpMoveRuntimeSingleton_t mr;	// context for line runtime
  */
 #define _bump(a) ((a<PLANNER_BUFFER_POOL_SIZE-1)?(a+1):0) // buffer incr & wrap
 #define spindle_speed move_time	// local alias for spindle_speed to the time variable
-#define value_vector gm.target	// alias for vector of values
+#define value_vector(b) mp_get_buffer_gm(b)->target	// alias for vector of values
 #define flag_vector unit		// alias for vector of flags
 
 static void _planner_time_accounting();
@@ -156,6 +156,7 @@ void mp_flush_planner()
 {
 	cm_abort_arc();
 	mp_init_buffers();
+	mm.carry = false;			// a carried line goes with the rest
     mr.move_state = MOVE_OFF;   // invalidate mr buffer to prevent subsequent motion
 }
 
@@ -184,7 +185,11 @@ void mp_flush_planner()
  *	still close to the starting point.
  */
 
-void mp_set_planner_position(uint8_t axis, const float position) { mm.position[axis] = position; }
+void mp_set_planner_position(uint8_t axis, const float position)
+{
+	mp_commit_carry();			// the carried line ends at the old position
+	mm.position[axis] = position;
+}
 void mp_set_runtime_position(uint8_t axis, const float position) { mr.position[axis] = position; }
 
 void mp_set_steps_to_runtime_position()
@@ -195,6 +200,12 @@ void mp_set_steps_to_runtime_position()
         mr.target_steps[motor] = step_position[motor];
         mr.position_steps[motor] = step_position[motor];
         mr.commanded_steps[motor] = step_position[motor];
+#ifdef __FIXED_POINT_EXEC
+        mr.fx_target_steps[motor] = fx_from_steps(step_position[motor]);
+        st_pre.mot[motor].commanded_steps = mr.fx_target_steps[motor];
+#else
+        st_pre.mot[motor].commanded_steps = step_position[motor];
+#endif
         en_set_encoder_steps(motor, step_position[motor]);  // write steps to encoder register
 
         // These must be zero:
@@ -228,6 +239,7 @@ void mp_queue_command(void(*cm_exec)(float[], float[]), float *value, float *fla
 {
 	mpBuf_t *bf;
 
+	mp_commit_carry();									// any carried line runs before the command
 	// Never supposed to fail as buffer availability was checked upstream in the controller
 	if ((bf = mp_get_write_buffer()) == NULL) {
 		cm_panic(STAT_BUFFER_FULL_FATAL, "no write buffer in mp_queue_command");
@@ -240,7 +252,7 @@ void mp_queue_command(void(*cm_exec)(float[], float[]), float *value, float *fla
     bf->replannable = true;           // allow the normal planning to go backward past this zero-speed and zero-length "move"
 
 	for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-		bf->value_vector[axis] = value[axis];
+		value_vector(bf)[axis] = value[axis];
 		bf->flag_vector[axis] = flag[axis];
 	}
 	mp_commit_write_buffer(MOVE_TYPE_COMMAND);			// must be final operation before exit
@@ -254,7 +266,7 @@ static stat_t _exec_command(mpBuf_t *bf)
 
 stat_t mp_runtime_command(mpBuf_t *bf)
 {
-	bf->cm_func(bf->value_vector, bf->flag_vector);		// 2 vectors used by callbacks
+	bf->cm_func(value_vector(bf), bf->flag_vector);		// 2 vectors used by callbacks
 	if (mp_free_run_buffer()) {
 		cm_cycle_end();									// free buffer & perform cycle_end if planner is empty
     }    
@@ -273,12 +285,13 @@ stat_t mp_dwell(float seconds)
 {
 	mpBuf_t *bf;
 
+	mp_commit_carry();									// any carried line runs before the dwell
 	if ((bf = mp_get_write_buffer()) == NULL) {			// get write buffer or fail
 		return(cm_panic(STAT_BUFFER_FULL_FATAL, "no write buffer in mp_dwell")); // not ever supposed to fail
 	}
 	bf->bf_func = _exec_dwell;							// register callback to dwell start
     bf->replannable = true;  // +++ TEST allow the normal planning to go backward past this zero-speed and zero-length "move"
-	bf->gm.move_time = seconds;							// in seconds, not minutes
+	mp_get_buffer_gm(bf)->move_time = seconds;			// in seconds, not minutes
 	bf->move_state = MOVE_NEW;
 	mp_commit_write_buffer(MOVE_TYPE_DWELL);			// must be final operation before exit
 	return (STAT_OK);
@@ -286,7 +299,7 @@ stat_t mp_dwell(float seconds)
 
 static stat_t _exec_dwell(mpBuf_t *bf)
 {
-	st_prep_dwell((uint32_t)(bf->gm.move_time * 1000000.0));// convert seconds to uSec
+	st_prep_dwell((uint32_t)(mp_get_buffer_gm(bf)->move_time * 1000000.0));// convert seconds to uSec
 	if (mp_free_run_buffer()) {
         cm_cycle_end();			     // free buffer & perform cycle_end if planner is empty
     }    
@@ -372,6 +385,7 @@ static inline void _clear_buffer(mpBuf_t *bf)
 	// Note: bf->bf_func is the first address we wish to clear as
     // we must preserve the integrity of the pointers during interrupts
 	memset((void *)(&bf->bf_func), 0, sizeof(mpBuf_t) - (sizeof(void *) * 2));
+	memset((void *)mp_get_buffer_gm(bf), 0, sizeof(GCodeState_t));
 }
 
 void mp_init_buffers(void)
@@ -423,7 +437,7 @@ void mp_commit_write_buffer(const moveType move_type)
     mb.q->move_type = move_type;
     mb.q->move_state = MOVE_NEW;
 //    mb.q->replannable = true;                   // ++++ TEST
-    if (MOVE_TYPE_ALINE != move_type) {
+    if (!mp_is_motion(mb.q)) {
         mb.q->buffer_state = MP_BUFFER_QUEUED;
         mb.q = mb.q->nx;
         if (!mb.needs_replanned) {
@@ -545,6 +559,12 @@ stat_t mp_plan_buffer()
 {
 //    plan_debug_pin1 = 1;
 
+    // A carried line that nothing has followed is queued on its own (see mp_commit_carry())
+    if (mm.carry && (mm.carry_timer < SysTickTimer.getValue()) &&
+        (mp_get_planner_buffers_available() > 0)) {
+        mp_commit_carry();
+    }
+
     // Criteria to replan:
     // 0) There are items in the buffer that need replanning.
     // 1) Planner timer has "timed out"
@@ -30,6 +30,7 @@
 #define PLANNER_H_ONCE
 
 #include "canonical_machine.h"	// used for GCodeState_t
+#include "settings.h"			// the settings file may size the planner pool
 
 /*
  * Enums and other type definitions
@@ -47,6 +48,8 @@ typedef enum {                      // bf->buffer_state values
 typedef enum {				        // bf->move_type values
     MOVE_TYPE_NULL = 0,		        // null move - does a no-op
     MOVE_TYPE_ALINE,		        // acceleration planned line
+    MOVE_TYPE_ARC,                  // acceleration planned arc or helix (see mp_arc())
+    MOVE_TYPE_SPLINE,               // acceleration planned cubic spline (see mp_spline())
     MOVE_TYPE_DWELL,                // delay with no movement
     MOVE_TYPE_COMMAND,              // general command
     MOVE_TYPE_TOOL,                 // T command
@@ -55,6 +58,9 @@ typedef enum {				        // bf->move_type values
     MOVE_TYPE_END                   // program end
 } moveType;
 
+#define mp_is_motion(bf) (((bf)->move_type == MOVE_TYPE_ALINE) || ((bf)->move_type == MOVE_TYPE_ARC) || \
+						  ((bf)->move_type == MOVE_TYPE_SPLINE))
+
 typedef enum {
     MOVE_OFF = 0,                   // move inactive (MUST BE ZERO)
     MOVE_NEW,                       // general value if you need an initialization
@@ -84,6 +90,18 @@ typedef enum {
 #define MIN_SEGMENT_USEC 		((float)750)		// minimum segment time (also minimum move time)
 #define NOM_SEGMENT_USEC 		((float)1500)		// nominal segment time
 
+/* MAX_SEGMENT_USEC
+ *	Longest segment. Constant velocity bodies are run in segments up to this long when
+ *	the kinematics are linear (see _exec_aline_body()); everything else uses NOM_SEGMENT_USEC.
+ *	A feedhold can't start decelerating until the segments already prepped have run, so
+ *	this bounds the hold latency to about (PREP_BUFFER_DEPTH+1) * MAX_SEGMENT_USEC. It also
+ *	sets the DDA substep precision (see DDA_SUBSTEPS in stepper.h). A settings file may
+ *	override it - setting it to NOM_SEGMENT_USEC gives the old fixed segmenting.
+ */
+#ifndef MAX_SEGMENT_USEC
+#define MAX_SEGMENT_USEC		((float)5000)
+#endif
+
 #define MIN_PLANNED_USEC		((float)20000)		// minimum time in the planner below which we must replan immediately
 #define PHAT_CITY_USEC			((float)80000)		// if you have at least this much time in the planner,
 
@@ -95,6 +113,7 @@ typedef enum {
 // derived definitions - do not change
 #define MIN_SEGMENT_TIME 		(MIN_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
 #define NOM_SEGMENT_TIME 		(NOM_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
+#define MAX_SEGMENT_TIME 		(MAX_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
 #define MIN_PLANNED_TIME        (MIN_PLANNED_USEC / MICROSECONDS_PER_MINUTE)
 #define PHAT_CITY_TIME          (PHAT_CITY_USEC / MICROSECONDS_PER_MINUTE)
 #define MIN_SEGMENT_TIME_PLUS_MARGIN ((MIN_SEGMENT_USEC+1) / MICROSECONDS_PER_MINUTE)
@@ -103,10 +122,53 @@ typedef enum {
  *	Should be at least the number of buffers requires to support optimal
  *	planning in the case of very short lines or arc segments.
  *	Suggest 12 min. Limit is 255
+ *
+ *	A settings file may define it to get more look-ahead. Each buffer costs
+ *	sizeof(mpBuf_t) + sizeof(GCodeState_t) of RAM.
  */
+#ifndef PLANNER_BUFFER_POOL_SIZE
 #define PLANNER_BUFFER_POOL_SIZE 28
+#endif
+#if (PLANNER_BUFFER_POOL_SIZE > 255)
+#error PLANNER_BUFFER_POOL_SIZE is limited to 255
+#endif
 #define PLANNER_BUFFER_HEADROOM 4			// buffers to reserve in planner before processing new input line
 
+/* Corner blending in G64 P<tolerance> mode - see _blend_corner() in plan_line.cpp
+ * BLEND_SEGMENTS_MAX			Most chords in one blend. The blend and the line after it are
+ *								queued by one mp_aline() call, so this has to leave a buffer
+ *								for the line inside PLANNER_BUFFER_HEADROOM.
+ * BLEND_SEGMENT_ANGLE			Turn per chord (radians) the chord count aims for
+ * BLEND_MIN_SEGMENT_LENGTH		Blends with shorter chords than this aren't worth the buffers
+ */
+#define BLEND_SEGMENTS_MAX			(PLANNER_BUFFER_HEADROOM - 1)
+#define BLEND_SEGMENT_ANGLE			((float)0.5236)		// 30 degrees
+#define BLEND_MIN_SEGMENT_LENGTH	((float)0.05)		// mm
+
+/* Collinear line coalescing - see _coalesce_line() in plan_line.cpp
+ *	Defaults for the $clt and $cla settings, for settings files that don't have them
+ */
+#ifndef COALESCE_TOLERANCE
+#define COALESCE_TOLERANCE			0					// mm. 0 disables coalescing
+#endif
+#ifndef COALESCE_ANGLE
+#define COALESCE_ANGLE				1					// degrees
+#endif
+
+/* Junction velocity model - the $jt setting, see _calculate_junction_vmax() in plan_line.cpp
+ * JUNCTION_CENTRIPETAL		One radius for the corner, from the axis junction deviations, and
+ *							the centripetal velocity sqrt(R * junction_acceleration) through it
+ * JUNCTION_PER_AXIS		Each axis takes the velocity step the corner asks of it within its
+ *							own jerk, junction deviation and the junction acceleration
+ */
+enum junctionModel {
+	JUNCTION_CENTRIPETAL = 0,
+	JUNCTION_PER_AXIS
+};
+#ifndef JUNCTION_MODEL
+#define JUNCTION_MODEL				JUNCTION_CENTRIPETAL
+#endif
+
 # if 0
 // THESE ARE NO LONGER USED -- but the code that uses them is still conditional in plan_zoid.cpp
 /* Some parameters for _generate_trapezoid()
@@ -122,12 +184,100 @@ typedef enum {
 
 #define TRAPEZOID_VELOCITY_TOLERANCE		(max(2.0,bf->entry_velocity/100.0))
 
+/* BENCH() - planner timing probes
+ *	On the host build these feed the planner benchmark (platform/host/Benchmark.h).
+ *	Everywhere else they compile to nothing.
+ */
+#ifdef __HOST__
+#include "Benchmark.h"
+#define BENCH(probe) probe
+#else
+#define BENCH(probe)
+#endif
+
 /*
  *	Planner structures
  */
 
 // All the enums that equal zero must be zero. Don't change this
 
+// The planner buffer holds what the planner works on: the linkage, the state, and the
+// velocity planning terms. The Gcode model state that rides along with each move, and the
+// geometry of an arc or spline, are only needed by the runtime and when the move is queued,
+// so they are kept in side tables (mb.gm[] and mb.curve[]) indexed the same as mb.bf[]. Use
+// mp_get_buffer_gm(bf) and mp_get_buffer_curve(bf) to get at them.
+
+// The geometry of a MOVE_TYPE_ARC block. The plane axes go round the center, every other
+// axis moves linearly from the start to the target (the helix axis among them). The angles
+// are measured the same way as in plan_arc.cpp - from plane axis 1, toward plane axis 0.
+
+typedef struct mpArcMove {
+	float center_0;					// center on plane axis 0 (e.g. X for G17)
+	float center_1;					// center on plane axis 1 (e.g. Y for G17)
+	float radius;
+	float theta;					// angle of the start point
+	float angular_travel;			// signed angle swept to the end point
+	uint8_t plane_axis_0;
+	uint8_t plane_axis_1;
+} mpArcMove_t;
+
+#define ARC_END_TOLERANCE ((float)1e-5)	// fraction of an arc's length that counts as its end
+#define ARC_START_TOLERANCE ((float)0.001)	// mm an arc can start off its circle before a line is run to it
+
+// Walks the sine and cosine of an angle round an arc by rotating them a step at a time,
+// going back to sin() and cos() every so often (see mp_arc_rotate() in plan_arc.cpp).
+
+#ifndef ARC_RESYNC_MAX
+#define ARC_RESYNC_MAX 64				// most rotations between exact sines and cosines
+#endif
+#define ARC_ROTATION_DRIFT ((float)5e-7)	// worst drift of one rotation, relative to the radius (~4 ulp)
+#define ARC_SERIES_ANGLE ((float)0.25)	// largest step taken from the series rather than sin() and cos()
+
+typedef struct mpArcRotation {
+	float sin_theta;				// sine and cosine of the angle reached
+	float cos_theta;
+	float step;						// the angle rotated by each step
+	float sin_step;
+	float cos_step;
+	uint16_t count;					// rotations left until the next exact sine and cosine
+	uint16_t resync;				// rotations between them
+} mpArcRotation_t;
+
+// The geometry of a MOVE_TYPE_SPLINE block - a cubic Bezier curve in the plane, given by its
+// start, two control points and end on plane axes 0 and 1. Every other axis moves linearly
+// from the start to the target by the fraction of the length run, as along a helix.
+
+#define SPLINE_INTERVALS 16				// Simpson intervals for the length (even), also the curvature samples
+#ifndef SPLINE_RESYNC_MAX
+#define SPLINE_RESYNC_MAX 16			// most segments walked before the point is re-evaluated from the polynomial
+#endif
+
+typedef struct mpSplineMove {
+	float point[4][2];				// start, control 1, control 2, end on plane axes 0 and 1
+	float planar_length;			// length of the curve in the plane
+	uint8_t plane_axis_0;
+	uint8_t plane_axis_1;
+} mpSplineMove_t;
+
+// Walks a spline by its parameter u, carrying the point and its derivatives from segment to
+// segment (see mp_next_spline_point() in plan_spline.cpp).
+
+typedef struct mpSplineWalk {
+	float u;						// curve parameter reached, 0 to 1
+	float point[2];					// B(u) on plane axes 0 and 1
+	float d1[2];					// B'(u)
+	float d2[2];					// B''(u)
+	float d3[2];					// B''' - constant for a cubic
+	float coeff[3][2];				// B(u) = ((coeff[0]*u + coeff[1])*u + coeff[2])*u + origin
+	float origin[2];				// start of the spline
+	uint16_t count;					// segments left until the next re-evaluation
+} mpSplineWalk_t;
+
+typedef union mpCurveMove {			// a buffer's entry in mb.curve[]
+	mpArcMove_t arc;				// arc geometry - MOVE_TYPE_ARC only
+	mpSplineMove_t spline;			// spline geometry - MOVE_TYPE_SPLINE only
+} mpCurveMove_t;
+
 typedef struct mpBuffer {           // See Planning Velocity Notes for variable usage
 	struct mpBuffer *pv;            // static pointer to previous buffer
 	struct mpBuffer *nx;            // static pointer to next buffer
@@ -143,10 +293,11 @@ typedef struct mpBuffer {           // See Planning Velocity Notes for variable
 	bool replannable;               // TRUE if move can be re-planned
     bool locked;                    // TRUE if the move is locked from replanning
 
-	float unit[AXES];				// unit vector for axis scaling & planning
+	float unit[AXES];				// unit vector for axis scaling & planning (an arc's is at its start)
     bool unit_flags[AXES];          // set true for axes participating in the move
 
 	float length;					// total length of line or helix in mm
+	float coalesce_error;			// furthest the lines merged into this one can be from it (mm)
 	float head_length;
 	float body_length;
 	float tail_length;
@@ -154,9 +305,12 @@ typedef struct mpBuffer {           // See Planning Velocity Notes for variable
 	float entry_velocity;			// entry velocity requested for the move
 	float cruise_velocity;			// cruise velocity requested & achieved
 	float exit_velocity;			// exit velocity requested for the move
+	float requested_exit_velocity;	// exit velocity last given to mp_calculate_trapezoid()
 
 	float entry_vmax;				// max junction velocity at entry of this move
-	float cruise_vmax;				// max cruise velocity requested for move
+	float cruise_vmax;				// max cruise velocity requested for move (with overrides)
+	float cruise_vset;				// cruise velocity requested by the gcode, before overrides
+	float absolute_vmax;			// fastest the rate-limiting axis allows (overrides can't exceed)
 	float exit_vmax;				// max exit velocity possible (redundant)
 	float delta_vmax;				// max velocity difference for this move
 	float braking_velocity;			// current value for braking velocity
@@ -165,13 +319,17 @@ typedef struct mpBuffer {           // See Planning Velocity Notes for variable
 	float jerk;						// maximum linear jerk term for this move
 	float recip_jerk;				// 1/Jm used for planning (computed and cached)
 	float cbrt_jerk;				// cube root of Jm used for planning (computed and cached)
+	float sqrt_jerk;				// square root of Jm used for planning (computed and cached)
 
     float real_move_time;          // amount of time it'll take for the move, in us
 
-	GCodeState_t gm;				// Gcode model state - passed from model, used by planner and runtime
-
 } mpBuf_t;
 
+// The planner walks mpBuf_t back and forth on every replan, so keep it small. Anything
+// that only the runtime needs goes in a side table (see above), not here.
+#define MP_BUF_SIZE_MAX (4*sizeof(void *) + 160)
+static_assert(sizeof(mpBuf_t) <= MP_BUF_SIZE_MAX, "mpBuf_t has grown - move the new fields to a side table");
+
 typedef struct mpBufferPool {		// ring buffer for sub-moves
 	magic_t magic_start;			// magic number to test memory integrity
 	uint8_t buffers_available;		// running count of available buffers
@@ -189,6 +347,8 @@ typedef struct mpBufferPool {		// ring buffer for sub-moves
     uint32_t planner_timer;         // timout to compare against SysTickTimer.getValue() to know when to force planning
 
 	mpBuf_t bf[PLANNER_BUFFER_POOL_SIZE];// buffer storage
+	GCodeState_t gm[PLANNER_BUFFER_POOL_SIZE];// Gcode model state for each buffer - passed from model, used by runtime
+	mpCurveMove_t curve[PLANNER_BUFFER_POOL_SIZE];// arc or spline geometry for each buffer, used by runtime
 	magic_t magic_end;
 } mpBufferPool_t;
 
@@ -199,10 +359,29 @@ typedef struct mpMoveMasterSingleton { // common variables for planning (move ma
 	float jerk;						// jerk values cached from previous block
 	float recip_jerk;
 	float cbrt_jerk;
+	float sqrt_jerk;
+
+	bool carry;						// a line too short to run is waiting to be carried into the next one
+	uint32_t carry_timer;			// SysTick time to stop waiting and run it on its own
+	GCodeState_t carry_gm;			// gcode state of the carried line
 
 	magic_t magic_end;
 } mpMoveMasterSingleton_t;
 
+#ifdef __FIXED_POINT_EXEC
+#define FX_PATH MOTORS					// the extra channel: length along the path
+#define FX_CHANNELS (MOTORS+1)
+
+typedef struct mpFixedChannel {			// one forward-differenced quantity, binary points in mr.fx_point[]
+	int64_t velocity;					// travel in the current segment
+	int64_t forward_diff_1;
+	int64_t forward_diff_2;
+	int64_t forward_diff_3;
+	int64_t forward_diff_4;
+	int64_t forward_diff_5;
+} mpFixedChannel_t;
+#endif
+
 typedef struct mpMoveRuntimeSingleton {	// persistent runtime variables
 //	uint8_t (*run_move)(struct mpMoveRuntimeSingleton *m); // currently running move - left in for reference
 	magic_t magic_start;                // magic number to test memory integrity
@@ -215,9 +394,24 @@ typedef struct mpMoveRuntimeSingleton {	// persistent runtime variables
 	float position[AXES];               // current move position
 	float waypoint[SECTIONS][AXES];     // head/body/tail endpoints for correction
 
+	moveType move_type;                 // MOVE_TYPE_ALINE, or _ARC or _SPLINE for a curved path
+	union {
+		mpArcMove_t arc;                // ...the curve's geometry
+		mpSplineMove_t spline;
+	};
+	float start[AXES];                  // ...where it started
+	float length;                       // ...its length
+	float distance;                     // ...and how far along it the last segment ended
+	float distance_error;               // ...less this, the rounding lost adding segments to it
+	float waypoint_distance[SECTIONS];  // distance at the waypoints
+	union {
+		mpArcRotation_t rotation;       // angle the last segment ended at
+		mpSplineWalk_t walk;            // ...or the spline parameter
+	};
+
 	float target_steps[MOTORS];         // current MR target (absolute target as steps)
 	float position_steps[MOTORS];       // current MR position (target from previous segment)
-	float commanded_steps[MOTORS];      // will align with next encoder sample (target from 2nd previous segment)
+	float commanded_steps[MOTORS];      // start of the segment the steppers are running (aligns with encoder_steps)
 	float encoder_steps[MOTORS];        // encoder position in steps - ideally the same as commanded_steps
 	float following_error[MOTORS];      // difference between encoder_steps and commanded steps
 
@@ -241,6 +435,21 @@ typedef struct mpMoveRuntimeSingleton {	// persistent runtime variables
 	float forward_diff_4;               // forward difference level 4
 	float forward_diff_5;               // forward difference level 5
 
+#ifdef __FIXED_POINT_EXEC				// integer copy of the above for the segments (see _fx_init_section())
+	mpFixedChannel_t fx[FX_CHANNELS];   // per-motor segment travel in steps, plus the path length (FX_PATH)
+	uint8_t fx_point[6];                // binary points of the velocity [0] and forward_diff_1..5 [1..5]
+	uint32_t fx_dda_ticks;              // DDA ticks per segment for this section
+	float fx_velocity_scale;            // converts FX_PATH velocity to length units per minute
+	int64_t fx_waypoint_steps[MOTORS];  // section end in steps (fxsteps_t, see stepper.h)
+	int64_t fx_target_steps[MOTORS];    // the float steps vectors above are only refreshed at section ends
+	int64_t fx_position_steps[MOTORS];
+	int64_t fx_commanded_steps[MOTORS];
+	int64_t fx_encoder_steps[MOTORS];
+	int64_t fx_following_error[MOTORS];
+	int64_t fx_distance;                // length run so far in the section (Q.32) - mr.position is the section start
+	float fx_length;                    // ...as a float, for position reports
+#endif
+
 	GCodeState_t gm;                    // gcode model state currently executing
 
 	magic_t magic_end;
@@ -293,6 +502,8 @@ mpBuf_t * mp_get_first_buffer(void);
 
 #define mp_get_prev_buffer(b) ((mpBuf_t *)(b->pv))
 #define mp_get_next_buffer(b) ((mpBuf_t *)(b->nx))
+#define mp_get_buffer_gm(b) ((GCodeState_t *)&mb.gm[(b) - mb.bf])
+#define mp_get_buffer_curve(b) ((mpCurveMove_t *)&mb.curve[(b) - mb.bf])
 
 stat_t mp_plan_buffer();                                // planner functions and helpers...
 bool mp_is_it_phat_city_time();
@@ -308,14 +519,39 @@ uint8_t mp_get_runtime_busy(void);
 bool mp_runtime_is_idle(void);
 
 stat_t mp_aline(GCodeState_t *gm_in);                   // line planning...
+void mp_commit_carry(void);
+stat_t mp_arc(GCodeState_t *gm_in, const mpArcMove_t *arc_move);
+stat_t mp_spline(GCodeState_t *gm_in, const mpSplineMove_t *spline);
 void mp_plan_block_list(mpBuf_t *bf);
 void mp_reset_replannable_list(void);
+float mp_get_override_vmax(const mpBuf_t *bf);
+void mp_feed_rate_override(void);
+
+// plan_arc.c functions
+void mp_get_arc_point(const mpArcMove_t *arc_move, const float start[], const float end[], const float fraction, float point[]);
+void mp_next_arc_point(const mpArcMove_t *arc_move, mpArcRotation_t *rot, const float start[], const float end[],
+					   const float fraction, const float step, float point[]);
+void mp_arc_rotation_init(mpArcRotation_t *rot, const float theta, const float radius);
+void mp_arc_set_step(mpArcRotation_t *rot, const float step);
+void mp_arc_rotate(mpArcRotation_t *rot, const float theta);
+void mp_arc_rotation_sync(mpArcRotation_t *rot, const float theta);
+void mp_set_arc_unit(const mpArcMove_t *arc_move, const float length, const float fraction, float unit[]);
+
+// plan_spline.c functions
+float mp_measure_spline(mpSplineMove_t *spline);
+void mp_spline_walk_init(mpSplineWalk_t *walk, const mpSplineMove_t *spline);
+void mp_next_spline_point(const mpSplineMove_t *spline, mpSplineWalk_t *walk, const float start[], const float end[],
+						  const float fraction, const float step, float point[]);
+void mp_split_spline(mpSplineMove_t *spline, const float u, const float fraction, const float start[]);
+void mp_set_spline_unit(const mpSplineMove_t *spline, const float length, const bool at_end, float unit[]);
 
 // plan_zoid.c functions
 void mp_calculate_trapezoid(mpBuf_t *bf);
 float mp_get_target_length(const float Vi, const float Vf, const mpBuf_t *bf);
 float mp_get_meet_velocity(const float v_0, const float v_2, const float L, const mpBuf_t *bf);
 float mp_get_target_velocity(const float Vi, const float L, const mpBuf_t *bf);
+float mp_get_meet_velocity_ref(const float v_0, const float v_2, const float L, const mpBuf_t *bf);
+float mp_get_target_velocity_ref(const float v_0, const float L, const mpBuf_t *bf);
 
 // plan_exec.c functions
 stat_t mp_exec_move(void);
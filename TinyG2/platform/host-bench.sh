@@ -0,0 +1,51 @@
+#!/bin/bash
+
+## Run the gcode/*.h programs through the host build and report planner timing.
+## Build first with "make PLATFORM=host", then call from the TinyG2 directory as:
+#  ./platform/host-bench.sh [-s slowdown] [-l seconds] [gcode/gcode_xxx.h ...]
+#
+# With no files the whole gcode/ corpus is run. That runs every program to the end
+# in virtual time, which takes a while for the slow ones; -l cuts each program off
+# after that many (virtual) seconds. The slowdown is how many times
+# slower the target is than this machine; it's applied to the replan times before
+# they are compared with MIN_PLANNED_USEC (see platform/host/Benchmark.h).
+#
+# The programs are C string literals. The preprocessor drops the commented-out
+# ones and joins the continuation lines, then each literal is unescaped as-is.
+
+ELF=bin/host/host.elf
+SLOWDOWN=1
+LIMIT=()
+
+while getopts "s:l:" opt; do
+	case $opt in
+		s) SLOWDOWN=$OPTARG ;;
+		l) LIMIT=(-l "$OPTARG") ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+FILES=("$@")
+if [ ${#FILES[@]} -eq 0 ]; then
+	FILES=(gcode/*.h)
+fi
+
+if [ ! -x "$ELF" ]; then
+	echo "$ELF not found - run \"make PLATFORM=host\" first" >&2
+	exit 2
+fi
+
+TMP=$(mktemp)
+trap 'rm -f "$TMP"' EXIT
+
+for f in "${FILES[@]}"; do
+	${CC:-cc} -E -P -DPROGMEM= -x c "$f" |
+		sed -n 's/^const char [A-Za-z0-9_]*\[\] = "\(.*\)";$/\1/p' |
+		while IFS= read -r program; do
+			printf '%b\n' "$program"
+		done > "$TMP"
+
+	echo "== $f"
+	"$ELF" -i "$TMP" -o /dev/null -b -s "$SLOWDOWN" "${LIMIT[@]}" 2>&1
+done
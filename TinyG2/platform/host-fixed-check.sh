@@ -0,0 +1,127 @@
+#!/bin/bash
+
+## Run the gcode/*.h programs through the float and the fixed-point (__FIXED_POINT_EXEC)
+## host builds and check that the motors end up where each program sent them.
+## Build both first:
+#
+#  make PLATFORM=host
+#  make PLATFORM=host USER_DEFINES=__FIXED_POINT_EXEC OBJ=build/host-fx BIN=bin/host-fx
+#
+# then call from the TinyG2 directory as:
+#  ./platform/host-fixed-check.sh [-t steps] [-l seconds] [gcode/gcode_xxx.h ...]
+#
+# With no files the whole gcode/ corpus is run, each program to its end - the whole of
+# gcode_tests.h takes several minutes. Programs are only checked at the end: part way
+# through the two builds needn't be at the same place, as the float build runs arcs as
+# curves (MOVE_TYPE_ARC) and the fixed-point build as chords, timed differently. A
+# program that hasn't ended after -l (virtual) seconds, default 5000, is counted as not
+# checked. gcode_debug_tests.h never ends: the '!' in its comments is taken as a feedhold.
+#
+# Each build is checked against the end of the last move ("host: target", the runtime
+# position in steps), not against the other build. A program passes if the builds'
+# targets agree to within TARGET_TOLERANCE steps - the same point, worked out in float
+# by two routes - and every motor is within -t steps (default 1) of the nearest step to
+# it in both.
+# A target that lands exactly on a step boundary can come out either side of it
+# depending on the DDA phase and the last bit of rounding, so 0 is too strict - and the
+# builds can end up 2 steps apart on one, each within a step of the target. The step
+# pulse counts are printed alongside - they include the back-and-forth steps of a motor
+# sitting on a boundary, which the builds needn't share.
+# The exit status is the number of programs that failed.
+#
+# The programs are extracted the same way as in host-bench.sh.
+
+ELF=bin/host/host.elf
+FX_ELF=bin/host-fx/host.elf
+TOLERANCE=1
+TARGET_TOLERANCE=0.05
+LIMIT=5000
+
+while getopts "t:l:" opt; do
+	case $opt in
+		t) TOLERANCE=$OPTARG ;;
+		l) LIMIT=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+FILES=("$@")
+if [ ${#FILES[@]} -eq 0 ]; then
+	FILES=(gcode/*.h)
+fi
+
+for elf in "$ELF" "$FX_ELF"; do
+	if [ ! -x "$elf" ]; then
+		echo "$elf not found - see the top of $0 for how to build it" >&2
+		exit 2
+	fi
+done
+
+TMP=$(mktemp)
+trap 'rm -f "$TMP"' EXIT
+
+# _summary run line    - a "host:" summary line of the run, without the m1: labels
+# _check a b tolerance [round] - "ok", or the first motor where a and b are further apart.
+#						   With round, b is taken to the nearest whole step first
+_summary() {
+	grep "^host: $2" <<< "$1" | cut -d' ' -f3- | sed 's/m[0-9]*://g'
+}
+
+# _cut_off run - true if the run was stopped at the -l limit rather than ending
+_cut_off() {
+	local seconds=$(grep '^host: .* s virtual time' <<< "$1" | cut -d' ' -f2)
+	awk -v s="${seconds:-0}" -v l="$LIMIT" 'BEGIN { exit !(s >= l) }'
+}
+
+_check() {
+	local a=($1)
+	local b=($2)
+	if [ ${#a[@]} -eq 0 ] || [ ${#a[@]} -ne ${#b[@]} ]; then
+		echo "no summary"
+		return
+	fi
+	for i in "${!a[@]}"; do
+		if awk -v a="${a[i]}" -v b="${b[i]}" -v tol="$3" -v r="$4" \
+			'BEGIN { if (r) b = (b < 0) ? int(b - 0.5) : int(b + 0.5); d = a - b; exit !((d > tol) || (d < -tol)) }'; then
+			echo "m$((i + 1)) is at ${a[i]}, not ${b[i]}"
+			return
+		fi
+	done
+	echo ok
+}
+
+FAILED=0
+UNCHECKED=0
+for f in "${FILES[@]}"; do
+	${CC:-cc} -E -P -DPROGMEM= -x c "$f" |
+		sed -n 's/^const char [A-Za-z0-9_]*\[\] = "\(.*\)";$/\1/p' |
+		while IFS= read -r program; do
+			printf '%b\n' "$program"
+		done > "$TMP"
+
+	FLOAT_RUN=$("$ELF" -i "$TMP" -o /dev/null -v -l "$LIMIT" 2>&1)
+	FX_RUN=$("$FX_ELF" -i "$TMP" -o /dev/null -v -l "$LIMIT" 2>&1)
+
+	echo "== $f"
+	if _cut_off "$FLOAT_RUN" || _cut_off "$FX_RUN"; then
+		echo "not checked - didn't end in $LIMIT s"
+		UNCHECKED=$((UNCHECKED + 1))
+		continue
+	fi
+	FLOAT_TARGET=$(_summary "$FLOAT_RUN" target)
+	FX_TARGET=$(_summary "$FX_RUN" target)
+	FLOAT_RESULT=$(_check "$(_summary "$FLOAT_RUN" position)" "$FLOAT_TARGET" "$TOLERANCE" round)
+	FX_RESULT=$(_check "$(_summary "$FX_RUN" position)" "$FX_TARGET" "$TOLERANCE" round)
+	TARGET_RESULT=$(_check "$FX_TARGET" "$FLOAT_TARGET" "$TARGET_TOLERANCE")
+
+	echo "float: $(grep '^host: steps' <<< "$FLOAT_RUN" | cut -d' ' -f2-) - $FLOAT_RESULT"
+	echo "fixed: $(grep '^host: steps' <<< "$FX_RUN" | cut -d' ' -f2-) - $FX_RESULT"
+	echo "target: $FLOAT_TARGET - fixed $TARGET_RESULT"
+	if [ "$FLOAT_RESULT" != ok ] || [ "$FX_RESULT" != ok ] || [ "$TARGET_RESULT" != ok ]; then
+		FAILED=$((FAILED + 1))
+	fi
+done
+
+echo "${#FILES[@]} files, $FAILED failed, $UNCHECKED not checked"
+exit $FAILED
@@ -0,0 +1,47 @@
+# ----------------------------------------------------------------------------
+# host.mk - build the firmware as a native simulation (PLATFORM=host)
+#
+# This file is part of the TinyG2 project.
+#
+# The Motate Host* backends stand in for the SAM peripherals (see
+# motate/utility/HostCommon.h), and platform/host provides the process-level
+# glue: option parsing, Reset, and UniqueId.
+# ----------------------------------------------------------------------------
+
+include platform/make_utilities.mk
+
+# Native compiler, no cross prefix, no tool download
+CROSS_COMPILE =
+
+HOST_SOURCE_DIRS += platform/host
+
+DEVICE_RULES = $(call CREATE_DEVICE_LIBRARY,HOST,host)
+
+# Flags
+DEVICE_INCLUDE_DIRS += ./platform/host
+
+DEVICE_LIBS          = m
+
+# Only the .elf (a native executable) -- there's nothing to flash.
+OUTPUT_TARGETS = $(OUTPUT_BIN).elf
+
+# No linker script, the native one is what we want.
+LINKER_SCRIPT =
+
+# ---------------------------------------------------------------------------------------
+# C Flags (NOT CPP flags)
+
+DEVICE_CFLAGS := -D__HOST__ -std=gnu99
+
+
+# ---------------------------------------------------------------------------------------
+# CPP Flags
+
+DEVICE_CPPFLAGS := -D__HOST__ -fno-rtti -std=c++11 -fno-exceptions
+
+# ---------------------------------------------------------------------------------------
+# Linker Flags
+
+DEVICE_LDFLAGS :=
+
+DEVICE_ASFLAGS  := -D__HOST__
@@ -0,0 +1,335 @@
+/*
+ * Benchmark.cpp - planner timing probes for the host simulation build (PLATFORM=host)
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
+
+#include "tinyg2.h"
+#include "config.h"
+#include "planner.h"
+#include "kinematics.h"
+#include "util.h"
+#include "Benchmark.h"
+
+static struct benchSingleton {
+	double slowdown;				// host-to-target speed ratio
+
+	uint32_t blocks;				// mp_aline() calls
+	uint64_t aline_ns;				// total time in mp_aline()
+	uint64_t aline_start;
+
+	uint32_t replans;				// mp_plan_block_list() calls
+	uint64_t plan_ns;				// total time in mp_plan_block_list()
+	uint64_t plan_start;
+	float plan_headroom;			// headroom of the replan in progress (usec)
+
+	uint32_t trapezoids;			// mp_calculate_trapezoid() calls
+	uint32_t plan_trapezoids;		// ...in the replan in progress
+	uint32_t max_plan_trapezoids;	// ...most in any one replan
+
+	uint32_t running_replans;		// replans that started with moves queued
+	float min_headroom;				// least time queued at the start of a replan (usec)
+	uint32_t over_deadline;			// replans that took longer than MIN_PLANNED_USEC
+	uint32_t starved;				// replans that took longer than their headroom
+
+	uint32_t *samples;				// every replan time (ns)
+	uint32_t sample_size;			// allocated length of samples
+
+	struct benchSolver {
+		uint32_t calls;
+		double fast_error;			// worst relative error of the fast solver
+		double ref_error;			// ...and of the _ref() solver
+	} target, meet;
+
+	uint32_t arc_points;			// mp_next_arc_point() calls
+	double arc_error;				// furthest any was from the exact point (mm)
+} bench = { 1.0 };
+
+static uint64_t _now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec);
+}
+
+void bench_set_slowdown(double factor)
+{
+	if (factor > 0) {
+		bench.slowdown = factor;
+	}
+}
+
+void bench_aline_begin()
+{
+	bench.aline_start = _now_ns();
+}
+
+void bench_aline_end()
+{
+	bench.aline_ns += _now_ns() - bench.aline_start;
+	bench.blocks++;
+}
+
+void bench_plan_begin(float headroom)
+{
+	bench.plan_headroom = headroom * MICROSECONDS_PER_MINUTE;
+	bench.plan_trapezoids = 0;
+	bench.plan_start = _now_ns();
+}
+
+void bench_plan_end()
+{
+	uint64_t elapsed = _now_ns() - bench.plan_start;
+
+	bench.plan_ns += elapsed;
+	if (bench.replans == bench.sample_size) {
+		bench.sample_size = (bench.sample_size == 0) ? 4096 : bench.sample_size * 2;
+		bench.samples = (uint32_t *)realloc(bench.samples, bench.sample_size * sizeof(uint32_t));
+		if (bench.samples == NULL) {
+			perror("bench");
+			exit(2);
+		}
+	}
+	bench.samples[bench.replans++] = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+
+	if (bench.plan_trapezoids > bench.max_plan_trapezoids) {
+		bench.max_plan_trapezoids = bench.plan_trapezoids;
+	}
+
+	float target_usec = (float)(elapsed * bench.slowdown / 1000.0);
+	if (target_usec > MIN_PLANNED_USEC) {
+		bench.over_deadline++;
+	}
+	if (bench.plan_headroom > 0) {				// planning from an idle runtime can't starve it
+		if ((bench.running_replans == 0) || (bench.plan_headroom < bench.min_headroom)) {
+			bench.min_headroom = bench.plan_headroom;
+		}
+		bench.running_replans++;
+		if (target_usec > bench.plan_headroom) {
+			bench.starved++;
+		}
+	}
+}
+
+void bench_trapezoid()
+{
+	bench.trapezoids++;
+	bench.plan_trapezoids++;
+}
+
+/*
+ * Exact roots of the linear snap length equation (see mp_get_target_length()), by
+ * bisection in double precision. Lengths only grow with v_1, so there's exactly one.
+ */
+static double _length(double v_0, double v_1, double jerk)
+{
+	return (1.201405707067378 * sqrt(jerk * fabs(v_1 - v_0)) * (v_0 + v_1) / jerk);
+}
+
+static double _meet_length(double v_0, double v_2, double v_1, double jerk)
+{
+	return (_length(v_0, v_1, jerk) + _length(v_2, v_1, jerk));
+}
+
+static double _target_root(double v_0, double L, double jerk)
+{
+	double lo = v_0, hi = v_0 + 1;
+	while (_length(v_0, hi, jerk) < L) { hi += (hi - v_0); }
+	for (uint8_t i=0; i<100; i++) {
+		double v_1 = (lo + hi) / 2;
+		if (_length(v_0, v_1, jerk) < L) { lo = v_1; } else { hi = v_1; }
+	}
+	return ((lo + hi) / 2);
+}
+
+static double _meet_root(double v_0, double v_2, double L, double jerk)
+{
+	double v_hi = (v_0 > v_2) ? v_0 : v_2;
+	double lo = v_hi, hi = v_hi + 1;
+	if (_meet_length(v_0, v_2, lo, jerk) >= L) { return (v_hi); }	// the two ends can't meet
+	while (_meet_length(v_0, v_2, hi, jerk) < L) { hi += (hi - v_hi); }
+	for (uint8_t i=0; i<100; i++) {
+		double v_1 = (lo + hi) / 2;
+		if (_meet_length(v_0, v_2, v_1, jerk) < L) { lo = v_1; } else { hi = v_1; }
+	}
+	return ((lo + hi) / 2);
+}
+
+// errors smaller than the float resolution of the answer aren't counted
+static void _solver_error(struct benchSingleton::benchSolver *solver, double scale, double exact, double fast, double ref)
+{
+	solver->calls++;
+	if (scale <= 0) {
+		return;
+	}
+	double rounding = exact * FLT_EPSILON;
+	double error = fmax(fabs(fast - exact) - rounding, 0) / scale;
+	if (error > solver->fast_error) { solver->fast_error = error; }
+	error = fmax(fabs(ref - exact) - rounding, 0) / scale;
+	if (error > solver->ref_error) { solver->ref_error = error; }
+}
+
+// Time spent checking the solvers is taken back out of the replan or mp_aline() it happened in.
+static void _solver_time(uint64_t start)
+{
+	uint64_t elapsed = _now_ns() - start;
+	bench.aline_start += elapsed;
+	bench.plan_start += elapsed;
+}
+
+// target velocity errors are relative to the velocity gained
+void bench_target_velocity(float v_0, float L, const mpBuf_t *bf, float fast)
+{
+	uint64_t start = _now_ns();
+	double exact = _target_root(v_0, L, bf->jerk);
+	_solver_error(&bench.target, exact - v_0, exact, fast, mp_get_target_velocity_ref(v_0, L, bf));
+	_solver_time(start);
+}
+
+// meet velocity errors are relative to the meet velocity
+void bench_meet_velocity(float v_0, float v_2, float L, const mpBuf_t *bf, float fast)
+{
+	uint64_t start = _now_ns();
+	double exact = _meet_root(v_0, v_2, L, bf->jerk);
+	_solver_error(&bench.meet, exact, exact, fast, mp_get_meet_velocity_ref(v_0, v_2, L, bf));
+	_solver_time(start);
+}
+
+// the exact point is on the arc at the same angle, in double precision
+void bench_arc_point(const mpArcMove_t *arc_move, const float start[], const float end[], float fraction, const float point[])
+{
+	double theta = (double)arc_move->theta + (double)arc_move->angular_travel * fraction;
+	double error = hypot(point[arc_move->plane_axis_0] - (arc_move->center_0 + sin(theta) * (double)arc_move->radius),
+						 point[arc_move->plane_axis_1] - (arc_move->center_1 + cos(theta) * (double)arc_move->radius));
+	bench.arc_points++;
+	if (error > bench.arc_error) { bench.arc_error = error; }
+}
+
+// host time per arc point, rotated and from sin() and cos()
+static void _arc_point_times(double *rotate_ns, double *trig_ns)
+{
+	const uint32_t points = 1000000;
+	volatile float sink;
+	mpArcRotation_t rot;
+
+	mp_arc_rotation_init(&rot, 0, 1);
+	mp_arc_set_step(&rot, 0.001);
+	uint64_t start = _now_ns();
+	for (uint32_t i=0; i<points; i++) {
+		mp_arc_rotate(&rot, i * (float)0.001);
+		sink = rot.sin_theta + rot.cos_theta;
+	}
+	*rotate_ns = (double)(_now_ns() - start) / points;
+
+	start = _now_ns();
+	for (uint32_t i=0; i<points; i++) {
+		mp_arc_rotation_sync(&rot, i * (float)0.001);
+		sink = rot.sin_theta + rot.cos_theta;
+	}
+	*trig_ns = (double)(_now_ns() - start) / points;
+	(void)sink;
+}
+
+// host time per ik_kinematics() call, over points round a circle in the kinematics' workspace
+static double _kinematics_time(const kinKinematics_t *k)
+{
+	const uint32_t calls = 200000;
+	const uint8_t points = 64;
+	float travel[points][AXES];
+	float joint[AXES];
+	float steps[MOTORS];
+	volatile float sink;
+
+	float center = (k == ik_get_kinematics(KINEMATICS_SCARA)) ? (kin.scara_inner + kin.scara_outer) / 2 : 0;
+	for (uint8_t p=0; p<points; p++) {
+		clear_vector(travel[p]);
+		travel[p][AXIS_X] = center + 20 * cos(p * 2*M_PI / points);
+		travel[p][AXIS_Y] = 20 * sin(p * 2*M_PI / points);
+	}
+	uint64_t start = _now_ns();
+	for (uint32_t i=0; i<calls; i++) {
+		k->inverse(travel[i % points], joint);
+		ik_joints_to_steps(joint, steps);
+		sink = steps[MOTOR_1];
+	}
+	(void)sink;
+	return ((double)(_now_ns() - start) / calls);
+}
+
+// each kinematics' published and measured cost against the per-segment budget
+static void _kinematics_report(FILE *out)
+{
+	double budget = MIN_SEGMENT_USEC * IK_SEGMENT_BUDGET;
+
+	fprintf(out, "bench: ik_kinematics() per segment, budget %.1f us (%.0f%% of MIN_SEGMENT_USEC), slowdown x%.1f:\n",
+			budget, IK_SEGMENT_BUDGET * 100, bench.slowdown);
+	for (uint8_t type=0; type<KINEMATICS_MAX_VALUE; type++) {
+		const kinKinematics_t *k = ik_get_kinematics(type);
+		double published = k->cycles * 1000000.0 / SystemCoreClock;
+		double host_ns = _kinematics_time(k);
+		double measured = host_ns * bench.slowdown / 1000.0;
+		fprintf(out, "bench:  %c%-10s published %5u cycles %7.1f us, host %7.1f ns -> %7.1f us  %s\n",
+				(type == kin.type) ? '*' : ' ', k->name, k->cycles, published, host_ns, measured,
+				((published > budget) || (measured > budget)) ? "OVER BUDGET" : "ok");
+	}
+}
+
+static int _compare_samples(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return ((x > y) - (x < y));
+}
+
+// nearest-rank percentile of the sorted samples, in usec
+static double _percentile(double p)
+{
+	uint32_t rank = (uint32_t)((p / 100.0) * bench.replans + 0.5);
+	if (rank < 1) { rank = 1; }
+	if (rank > bench.replans) { rank = bench.replans; }
+	return (bench.samples[rank - 1] / 1000.0);
+}
+
+void bench_report(FILE *out)
+{
+	fprintf(out, "bench: %" PRIu32 " blocks, %" PRIu32 " replans, %" PRIu32 " trapezoids (%.2f per block, max %" PRIu32 " in one replan)\n",
+			bench.blocks, bench.replans, bench.trapezoids,
+			(bench.blocks ? (double)bench.trapezoids / bench.blocks : 0.0), bench.max_plan_trapezoids);
+	if (bench.blocks) {
+		fprintf(out, "bench: per block: aline %.3f us, plan %.3f us\n",
+				bench.aline_ns / 1000.0 / bench.blocks, bench.plan_ns / 1000.0 / bench.blocks);
+	}
+	if (bench.target.calls + bench.meet.calls) {
+		fprintf(out, "bench: velocity solvers, worst relative error fast/ref: target %" PRIu32 " calls %.2g/%.2g, meet %" PRIu32 " calls %.2g/%.2g\n",
+				bench.target.calls, bench.target.fast_error, bench.target.ref_error,
+				bench.meet.calls, bench.meet.fast_error, bench.meet.ref_error);
+	}
+	if (bench.arc_points) {
+		double rotate_ns, trig_ns;
+		_arc_point_times(&rotate_ns, &trig_ns);
+		fprintf(out, "bench: %" PRIu32 " arc points, furthest %.2g mm off the arc (chordal tolerance %g mm), per point: rotated %.1f ns, sin/cos %.1f ns\n",
+				bench.arc_points, bench.arc_error, (double)cm.chordal_tolerance, rotate_ns, trig_ns);
+	}
+	_kinematics_report(out);
+	if (bench.replans == 0) {
+		return;
+	}
+	qsort(bench.samples, bench.replans, sizeof(uint32_t), _compare_samples);
+	fprintf(out, "bench: mp_plan_block_list us: mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+			bench.plan_ns / 1000.0 / bench.replans,
+			_percentile(50), _percentile(90), _percentile(99), _percentile(99.9), _percentile(100));
+	fprintf(out, "bench: slowdown x%.1f: %" PRIu32 " replans over MIN_PLANNED_USEC (%.0f us), %" PRIu32 " of %" PRIu32 " outlasted their headroom (min %.0f us)\n",
+			bench.slowdown, bench.over_deadline, (double)MIN_PLANNED_USEC,
+			bench.starved, bench.running_replans, (double)bench.min_headroom);
+}
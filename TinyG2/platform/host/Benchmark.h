@@ -0,0 +1,57 @@
+/*
+ * Benchmark.h - planner timing probes for the host simulation build (PLATFORM=host)
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * The planner calls these through the BENCH() macro in planner.h, which compiles away
+ * on the boards. They measure real (host CPU) time, not virtual time - the simulation
+ * charges nothing for the planner, so this is the only place its cost shows up.
+ *
+ * What's collected over a run:
+ *	  - blocks		mp_aline() calls that queued a move, and the time spent in them
+ *	  - replans		mp_plan_block_list() calls, each one timed individually
+ *	  - trapezoids	mp_calculate_trapezoid() calls, in total and per replan
+ *	  - headroom	time queued ahead of the runtime when each replan started
+ *	  - solvers		the fast and _ref() velocity solvers' answers (plan_zoid.cpp), each
+ *					compared with a double precision root of the same length equation.
+ *					The checks are timed out of the replan and mp_aline() times.
+ *	  - arc points	points the exec rotated round an arc (mp_next_arc_point()), and the
+ *					furthest any was from the double precision point at the same angle.
+ *					The report also times the rotation against sin() and cos() per point.
+ *
+ * bench_report() prints totals, per-block cost, and the percentile distribution of the
+ * replan times. Each replan time is multiplied by the slowdown factor (host speed vs.
+ * target speed, see host-bench.sh) and compared with MIN_PLANNED_USEC and with the
+ * headroom it had. A replan that outlasts its headroom would have starved the runtime.
+ *
+ * The counts are deterministic for a given input. The times are not, so compare
+ * percentiles from several runs rather than single numbers.
+ */
+
+#ifndef BENCHMARK_H_ONCE
+#define BENCHMARK_H_ONCE
+
+#include <stdio.h>
+
+struct mpBuffer;							// mpBuf_t - this is included from planner.h before it's defined
+struct mpArcMove;							// mpArcMove_t, likewise
+
+void bench_set_slowdown(double factor);		// host-to-target speed ratio applied to replan times
+
+void bench_aline_begin(void);
+void bench_aline_end(void);
+void bench_plan_begin(float headroom);		// headroom is the queued time, in minutes
+void bench_plan_end(void);
+void bench_trapezoid(void);
+void bench_target_velocity(float v_0, float L, const struct mpBuffer *bf, float fast);
+void bench_meet_velocity(float v_0, float v_2, float L, const struct mpBuffer *bf, float fast);
+void bench_arc_point(const struct mpArcMove *arc_move, const float start[], const float end[], float fraction, const float point[]);
+
+void bench_report(FILE *out);
+
+#endif // BENCHMARK_H_ONCE
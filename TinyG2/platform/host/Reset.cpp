@@ -0,0 +1,46 @@
+/*
+ * Reset.cpp - reset and bootloader entry for the host simulation
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Reset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// There's nothing to reset into -- finish the run instead.
+void banzai(int samba) {
+	fflush(stdout);
+	fprintf(stderr, "host: %s requested, exiting\n", samba ? "bootloader" : "reset");
+	exit(0);
+}
+
+static int volatile ticks = -1;
+
+void initiateReset(int _ticks) {
+	ticks = _ticks;
+}
+
+void cancelReset() {
+	ticks = -1;
+}
+
+void tickReset() {
+	if (ticks == -1)
+		return;
+	ticks--;
+	if (ticks == 0)
+		banzai(1);
+}
+
+#ifdef __cplusplus
+}
+#endif
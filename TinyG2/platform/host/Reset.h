@@ -0,0 +1,30 @@
+/*
+ * Reset.h - reset and bootloader entry for the host simulation
+ * This file is part of the TinyG project
+ *
+ * Same interface as platform/atmel_sam/Reset.h. On the host a "reset" ends the process.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESET_H
+#define RESET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void banzai(int samba);
+
+void initiateReset(int ms);
+void tickReset();
+void cancelReset();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Simulation.cpp - run control for the host simulation build (PLATFORM=host)
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "MotatePins.h"
+#include "MotateTimers.h"
+#include "MotateUSB.h"
+#include "Simulation.h"
+#include "Benchmark.h"
+#include "tinyg2.h"
+#include "config.h"
+#include "hardware.h"
+#include "planner.h"
+#include "kinematics.h"
+#include "encoder.h"
+#include "gpio.h"
+#include "stepper.h"
+#include "util.h"
+
+using namespace Motate;
+
+#define HOST_SWITCHES 4				// -p may be given this many times
+
+static struct hostSimulation {
+	host_ticks_t quantum;			// ticks charged per main loop pass
+	host_ticks_t limit;				// 0 = no limit
+	uint64_t passes;				// main loop passes so far
+	bool verbose;
+	bool benchmark;
+	FILE *trace;
+	FILE *console;					// the real stderr, for our own messages
+	uint8_t switches;				// -p switches in use
+	struct hostSwitch {
+		uint8_t input;				// input driven by a motor position
+		uint8_t motor;				// that motor, 0-based
+		int32_t steps;				// the position it trips at
+		int8_t active;				// last level driven, -1 before the first
+	} sw[HOST_SWITCHES];
+} sim;
+
+static FILE *_open(const char *name, const char *mode)
+{
+	FILE *f = fopen(name, mode);
+	if (f == NULL) {
+		perror(name);
+		exit(2);
+	}
+	return f;
+}
+
+template<int8_t pinNum>
+static uint8_t _bit()
+{
+	uint8_t bit = 0;
+	while ((Pin<pinNum>::mask >> bit) > 1) {
+		bit++;
+	}
+	return bit;
+}
+
+// A motor's step/direction pins, counted as a driver would (see hostCountSteps())
+template<int8_t stepPin, int8_t dirPin>
+static void _count_motor()
+{
+	hostCountSteps(Pin<stepPin>::portLetter, _bit<stepPin>(), Pin<dirPin>::portLetter, _bit<dirPin>());
+}
+
+template<int8_t stepPin>
+static int32_t _motor_steps()
+{
+	return hostGetStepCount(Pin<stepPin>::portLetter, _bit<stepPin>());
+}
+
+static const struct hostMotorPins {
+	void (*count)(void);
+	int32_t (*steps)(void);
+} _motor_pins[] = {
+	{ _count_motor<kSocket1_StepPinNumber, kSocket1_DirPinNumber>, _motor_steps<kSocket1_StepPinNumber> },
+	{ _count_motor<kSocket2_StepPinNumber, kSocket2_DirPinNumber>, _motor_steps<kSocket2_StepPinNumber> },
+	{ _count_motor<kSocket3_StepPinNumber, kSocket3_DirPinNumber>, _motor_steps<kSocket3_StepPinNumber> },
+	{ _count_motor<kSocket4_StepPinNumber, kSocket4_DirPinNumber>, _motor_steps<kSocket4_StepPinNumber> },
+	{ _count_motor<kSocket5_StepPinNumber, kSocket5_DirPinNumber>, _motor_steps<kSocket5_StepPinNumber> },
+	{ _count_motor<kSocket6_StepPinNumber, kSocket6_DirPinNumber>, _motor_steps<kSocket6_StepPinNumber> }
+};
+
+void host_init(int argc, char *argv[])
+{
+	FILE *input = stdin;
+	uint32_t quantum_us = 20;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "i:o:q:l:t:vbs:p:")) != -1) {
+		switch (opt) {
+			case 'i': { input = _open(optarg, "r"); break; }
+			case 'o': {								// stdio bypasses the USB layer here, so move stdout itself
+				if (freopen(optarg, "w", stdout) == NULL) {
+					perror(optarg);
+					exit(2);
+				}
+				break;
+			}
+			case 'q': { quantum_us = strtoul(optarg, NULL, 10); break; }
+			case 'l': { sim.limit = (host_ticks_t)(strtod(optarg, NULL) * SystemCoreClock); break; }
+			case 't': { sim.trace = _open(optarg, "w"); break; }
+			case 'v': { sim.verbose = true; break; }
+			case 'b': { sim.benchmark = true; break; }
+			case 's': { bench_set_slowdown(strtod(optarg, NULL)); break; }
+			case 'p': {
+				int input_num, motor;
+				long steps;
+				if ((sscanf(optarg, "%d,%d,%ld", &input_num, &motor, &steps) != 3) ||
+					(input_num < 1) || (input_num > DI_CHANNELS) || (motor < 1) || (motor > MOTORS) ||
+					(sim.switches == HOST_SWITCHES)) {
+					fprintf(stderr, "%s: -p wants input,motor,steps (up to %d times)\n", argv[0], HOST_SWITCHES);
+					exit(2);
+				}
+				sim.sw[sim.switches].input = input_num;
+				sim.sw[sim.switches].motor = motor - 1;
+				sim.sw[sim.switches].steps = steps;
+				sim.sw[sim.switches].active = -1;
+				sim.switches++;
+				break;
+			}
+			default: {
+				fprintf(stderr, "usage: %s [-i file] [-o file] [-q usec] [-l sec] [-t file] [-v] [-b] [-s factor] [-p input,motor,steps]\n", argv[0]);
+				exit(2);
+			}
+		}
+	}
+	if (quantum_us == 0)
+		quantum_us = 1;
+
+	sim.quantum = hostMicrosecondsToTicks(quantum_us);
+	hostSetUSBStreams(input, stdout);
+	hostSetPinTraceFile(sim.trace);
+	uint8_t counted = 0;							// motors with step counters, bit per motor
+	for (uint8_t i=0; i<sim.switches; i++) {
+		if (!(counted & (1<<sim.sw[i].motor))) {
+			_motor_pins[sim.sw[i].motor].count();
+			counted |= (1<<sim.sw[i].motor);
+		}
+	}
+
+	// The firmware writes its responses to both stdout and stderr, which on the board
+	// both go out the USB port. Merge them, in order, into the output stream.
+	sim.console = stderr;
+	stderr = stdout;
+}
+
+template<int8_t pinNum>
+static void _set_input(const bool value)
+{
+	hostSetInputValue(Pin<pinNum>::portLetter, Pin<pinNum>::mask, value);
+}
+
+static void (*const _input_setters[])(const bool) = {
+	_set_input<kInput1_PinNumber>,  _set_input<kInput2_PinNumber>,  _set_input<kInput3_PinNumber>,
+	_set_input<kInput4_PinNumber>,  _set_input<kInput5_PinNumber>,  _set_input<kInput6_PinNumber>,
+	_set_input<kInput7_PinNumber>,  _set_input<kInput8_PinNumber>,  _set_input<kInput9_PinNumber>,
+	_set_input<kInput10_PinNumber>, _set_input<kInput11_PinNumber>, _set_input<kInput12_PinNumber>
+};
+
+/*
+ * _motor_position() - a motor's position counted off its step and direction pins (see -p)
+ * _drive_switches() - the -p switches: each active while its motor is at or past the trip position
+ *
+ *	"Past" is away from zero, the way the trip position is signed. The position is counted
+ *	off the step and direction pins from the start of the run, so it stays put when homing
+ *	or G28.3 moves the firmware's zero. The direction polarity and the pin level for active
+ *	(the input's NO/NC mode) are read each time so a config change is honored.
+ */
+static int32_t _motor_position(const uint8_t motor)
+{
+	int32_t position = _motor_pins[motor].steps();
+	return (st_cfg.mot[motor].polarity ? -position : position);
+}
+
+static void _drive_switches()
+{
+	for (uint8_t i=0; i<sim.switches; i++) {
+		hostSimulation::hostSwitch &sw = sim.sw[i];
+		int32_t position = _motor_position(sw.motor);
+		int8_t active = (sw.steps < 0) ? (position <= sw.steps) : (position >= sw.steps);
+		if (active == sw.active) {
+			continue;
+		}
+		sw.active = active;
+		bool active_level = (io.in[sw.input-1].mode == INPUT_ACTIVE_HIGH);
+		_input_setters[sw.input-1](active ? active_level : !active_level);
+	}
+}
+
+bool host_advance(void)
+{
+	hostAdvanceTime(sim.quantum);
+	sim.passes++;
+	_drive_switches();
+	return ((sim.limit == 0) || (hostGetTime() < sim.limit));
+}
+
+template<int8_t pinNum>
+static uint32_t _steps()
+{
+	return hostGetEdgeCount(Pin<pinNum>::portLetter, _bit<pinNum>()) / 2;
+}
+
+void host_report(void)
+{
+	fflush(stdout);
+	if (sim.trace != NULL) {
+		fclose(sim.trace);
+	}
+	if (sim.benchmark) {
+		bench_report(sim.console);
+	}
+	if (!sim.verbose)
+		return;
+
+	fprintf(sim.console, "host: %.6f s virtual time, %" PRIu64 " main loop passes\n",
+			(double)hostTicksToMicroseconds(hostGetTime()) / 1000000.0, sim.passes);
+	fprintf(sim.console, "host: steps m1:%lu m2:%lu m3:%lu m4:%lu m5:%lu m6:%lu\n",
+			(unsigned long)_steps<kSocket1_StepPinNumber>(),
+			(unsigned long)_steps<kSocket2_StepPinNumber>(),
+			(unsigned long)_steps<kSocket3_StepPinNumber>(),
+			(unsigned long)_steps<kSocket4_StepPinNumber>(),
+			(unsigned long)_steps<kSocket5_StepPinNumber>(),
+			(unsigned long)_steps<kSocket6_StepPinNumber>());
+	for (uint8_t i=0; i<sim.switches; i++) {
+		fprintf(sim.console, "host: switch in%d m%d:%ld (pins) active:%d\n", sim.sw[i].input, sim.sw[i].motor+1,
+				(long)_motor_position(sim.sw[i].motor), sim.sw[i].active);
+	}
+	fprintf(sim.console, "host: interrupts dda:%" PRIu64 " dwell:%" PRIu64 "\n",
+			_hostIRQs[kHostIRQ_TC0 + dda_timer_num].count,
+			_hostIRQs[kHostIRQ_TC0 + dwell_timer_num].count);
+
+	// where the motors ended up - the encoders count every step, signed
+	fprintf(sim.console, "host: position");
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		fprintf(sim.console, " m%d:%ld", motor+1, (long)en.en[motor].encoder_steps + en.en[motor].steps_run);
+	}
+	fprintf(sim.console, "\n");
+
+	// where the runtime says they should be - the end of the last move, in steps
+	float target[MOTORS] = {0};
+	ik_kinematics(mr.position, target);
+	fprintf(sim.console, "host: target");
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		fprintf(sim.console, " m%d:%.3f", motor+1, (double)target[motor]);
+	}
+	fprintf(sim.console, "\n");
+
+	// ...and where that puts the axes, through the forward kinematics
+	float steps[MOTORS];
+	float travel[AXES];
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		steps[motor] = (float)(en.en[motor].encoder_steps + en.en[motor].steps_run);
+	}
+	copy_vector(travel, mr.position);
+	ik_forward_kinematics(steps, travel);
+	fprintf(sim.console, "host: axes");
+	for (uint8_t axis=0; axis<AXES; axis++) {
+		fprintf(sim.console, " %c:%.4f", "xyzabc"[axis], (double)travel[axis]);
+	}
+	fprintf(sim.console, "\n");
+}
@@ -0,0 +1,41 @@
+/*
+ * Simulation.h - run control for the host simulation build (PLATFORM=host)
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * The host build runs the whole firmware as a process on the build machine, with
+ * the Motate hardware replaced by a deterministic simulation (see motate/utility/HostCommon.h).
+ * G-code (or JSON) comes in on stdin and responses go to stdout, as if over the USB port.
+ *
+ *	usage: TinyG2 [-i file] [-o file] [-q usec] [-l sec] [-t file] [-v] [-b] [-s factor] [-p input,motor,steps]
+ *
+ *	  -i file	read from file instead of stdin
+ *	  -o file	write responses to file instead of stdout
+ *	  -q usec	virtual time charged for each pass through the main loop (default 20)
+ *	  -l sec	stop after this much virtual time (default: run until input ends and motion stops)
+ *	  -t file	trace every output pin transition as "<tick> <port><bit> <level>"
+ *	  -v		print a run summary to stderr when done: virtual time, step pulses and final
+ *				position (in steps) of each motor
+ *	  -b		print the planner benchmark to stderr when done (see Benchmark.h)
+ *	  -s factor	how much slower the target is than this machine, for the -b deadline checks (default 1)
+ *	  -p input,motor,steps (may be given up to 4 times)
+ *				drive a switch on an input (1-12): active while the motor (1-6) is at or past
+ *				the step position (counted off its step and direction pins from the start), e.g.
+ *				a probe plate under Z, or a homing switch. Checked once per main loop pass.
+ */
+
+#ifndef SIMULATION_H_ONCE
+#define SIMULATION_H_ONCE
+
+#include <stdint.h>
+
+void host_init(int argc, char *argv[]);	// parse the options and connect the streams
+bool host_advance(void);				// charge one main loop pass; false when the time limit is reached
+void host_report(void);					// print the run summary (if asked for)
+
+#endif // SIMULATION_H_ONCE
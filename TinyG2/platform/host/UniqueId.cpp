@@ -0,0 +1,41 @@
+/*
+ * UniqueId.cpp - processor unique id for the host simulation
+ * This file is part of the TinyG project
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UniqueId.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // A fixed id so that runs are reproducible
+    static struct uuid stored_uuid = { 0x484f5354, 0x53494d00, 0, 0 };     // "HOST" "SIM"
+    static uint16_t uuid_string16[UNIQUE_ID_STRING_LEN] = {0};
+
+    void cacheUniqueId() {}
+
+    struct uuid* readUniqueId()
+    {
+        return &stored_uuid;
+    }
+
+    const uint16_t* readUniqueIdString()
+    {
+        if(uuid_string16[0] == 0) {
+            for(int i = 0; i < UNIQUE_ID_STRING_LEN; ++i) {
+                unsigned long nibble = (((i >= 8) ? stored_uuid.d1 : stored_uuid.d0) >> ((i % 8) * 4)) & 0xF;
+                if(nibble < 0xA) uuid_string16[i] = nibble + '0';
+                else uuid_string16[i] = (nibble - 0xA) + 'a';
+            }
+        }
+        return uuid_string16;
+    }
+
+#ifdef __cplusplus
+}
+#endif
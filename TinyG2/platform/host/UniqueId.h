@@ -0,0 +1,34 @@
+/*
+ * UniqueId.h - processor unique id for the host simulation
+ * This file is part of the TinyG project
+ *
+ * Same interface as platform/atmel_sam/UniqueId.h.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TinyG2__UniqueId__
+#define __TinyG2__UniqueId__
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    struct uuid { unsigned long d0, d1, d2, d3; };
+
+    void cacheUniqueId();
+    struct uuid* readUniqueId();
+    const uint16_t* readUniqueIdString();
+    const int16_t UNIQUE_ID_STRING_LEN = 12;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* defined(__TinyG2__UniqueId__) */
@@ -698,9 +698,11 @@ uint8_t job_report_callback()
 	if (cs.comm_mode == TEXT_MODE) {
 		// no-op, job_ids are client app state
 	} else if (js.json_syntax == JSON_SYNTAX_RELAXED) {
-		fprintf(stderr, "{job:[%lu,%lu,%lu,%lu]}\n", cfg.job_id[0], cfg.job_id[1], cfg.job_id[2], cfg.job_id[3] );
+		fprintf(stderr, "{job:[%lu,%lu,%lu,%lu]}\n", (unsigned long)cfg.job_id[0], (unsigned long)cfg.job_id[1],
+				(unsigned long)cfg.job_id[2], (unsigned long)cfg.job_id[3]);
 	} else {
-		fprintf(stderr, "{\"job\":[%lu,%lu,%lu,%lu]}\n", cfg.job_id[0], cfg.job_id[1], cfg.job_id[2], cfg.job_id[3] );
+		fprintf(stderr, "{\"job\":[%lu,%lu,%lu,%lu]}\n", (unsigned long)cfg.job_id[0], (unsigned long)cfg.job_id[1],
+				(unsigned long)cfg.job_id[2], (unsigned long)cfg.job_id[3]);
 		//job_clear_report();
 	}
 	return (STAT_OK);
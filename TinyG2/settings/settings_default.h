@@ -44,11 +44,21 @@
 // Machine configuration settings (See motors and axes for globals related to those objects)
 
 #define JUNCTION_ACCELERATION       100000                  // centripetal acceleration around corners
+#define JUNCTION_MODEL              0                       // 0=centripetal, 1=per axis (see planner.h)
+#define KINEMATICS                  KINEMATICS_CARTESIAN    // one of: KINEMATICS_CARTESIAN, _COREXY, _DELTA, _SCARA
+#define DELTA_RADIUS                105                     // delta tower to center (in mm)
+#define DELTA_ARM_LENGTH            215                     // delta diagonal arm length (in mm)
+#define SCARA_INNER_ARM             150                     // SCARA shoulder to elbow (in mm)
+#define SCARA_OUTER_ARM             150                     // SCARA elbow to tool (in mm)
 #define CHORDAL_TOLERANCE           0.01                    // chordal accuracy for arc drawing (in mm)
+#define COALESCE_TOLERANCE          0                       // merge collinear lines within this distance (in mm). 0=off
+#define COALESCE_ANGLE              1                       // ...and turning less than this (in degrees)
+//#define PLANNER_BUFFER_POOL_SIZE    28                      // planner look-ahead in moves (see planner.h)
 
 #define SOFT_LIMIT_ENABLE           0						// 0=off, 1=on
 #define HARD_LIMIT_ENABLE           1						// 0=off, 1=on
 #define SAFETY_INTERLOCK_ENABLE     1						// 0=off, 1=on
+#define HOMING_GROUP                0						// axes homed at the same time, bit per axis: 1=X,2=Y,4=Z,8=A. 0=one at a time
 
 #define SPINDLE_ENABLE_POLARITY     1                       // 0=active low, 1=active high
 #define SPINDLE_DIR_POLARITY        0                       // 0=clockwise is low, 1=clockwise is high
@@ -48,6 +48,7 @@
 #define SOFT_LIMIT_ENABLE           0                       // 0=off, 1=on
 #define HARD_LIMIT_ENABLE           1                       // 0=off, 1=on
 #define SAFETY_INTERLOCK_ENABLE     1                       // 0=off, 1=on
+#define HOMING_GROUP                0                       // 3 homes X and Y at the same time (see cycle_homing.cpp)
 
 #define SPINDLE_ENABLE_POLARITY     1                       // 0=active low, 1=active high
 #define SPINDLE_DIR_POLARITY        0                       // 0=clockwise is low, 1=clockwise is high
@@ -118,6 +119,8 @@
 #define M3_POLARITY              0
 #define M3_POWER_MODE            MOTOR_POWER_MODE
 #define M3_POWER_LEVEL           0.45
+#define M3_HOMING_INPUT          0                 // 3hi        0=home on yhi with motor 2. Set to a second Y switch's input
+                                                   //            (and Y in $hgrp) to square the gantry when homing
 
 #define M4_MOTOR_MAP             AXIS_Z
 #define M4_STEP_ANGLE            1.8
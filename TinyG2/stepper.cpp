@@ -34,6 +34,7 @@
 #include "stepper.h"
 #include "encoder.h"
 #include "planner.h"
+#include "kinematics.h"
 #include "hardware.h"
 #include "text_parser.h"
 #include "util.h"
@@ -46,7 +47,9 @@ static stRunSingleton_t st_run;
 
 /**** Static functions ****/
 
+static void _exec_move(void);
 static void _load_move(void);
+static void _prep_commit(moveType move_type);
 #ifdef __ARM
 static void _set_motor_power_level(const uint8_t motor, const float power_level);
 #endif
@@ -54,6 +57,24 @@ static void _set_motor_power_level(const uint8_t motor, const float power_level)
 // handy macro
 #define _f_to_period(f) (uint16_t)((float)F_CPU / (float)f)
 
+// prep ring helpers - the exec owns st_pre.head, the loader owns st_pre.tail (see PREP_BUFFER_DEPTH)
+#define _prep_next(i) (((i) + 1 == PREP_BUFFER_SLOTS) ? 0 : (i) + 1)
+#define _prep_is_empty() (st_pre.head == st_pre.tail)
+#define _prep_is_full() (_prep_next(st_pre.head) == st_pre.tail)
+#define _prep_last() (st_pre.seg[(st_pre.head == 0) ? PREP_BUFFER_SLOTS-1 : st_pre.head-1].move_type)
+#define _prep_is_waiting() ((!_prep_is_empty()) && (_prep_last() != MOVE_TYPE_ALINE) && (_prep_last() != MOVE_TYPE_DWELL))
+#define _prep_has_room() ((!_prep_is_full()) && (!_prep_is_waiting()))
+#define _prep_barrier() __asm__ __volatile__ ("" ::: "memory")	// slot contents must land before the index moves
+
+// rescale a motor's DDA phase to the new segment time (see st_prep_line())
+#if defined(__DDA_64BIT)
+#define _correct_accumulator(m) st_run.mot[m].substep_accumulator = st_run.mot[m].substep_accumulator * (int64_t)seg->dda_ticks / (int64_t)seg->mot[m].accumulator_correction
+#elif defined(__FIXED_POINT_EXEC)
+#define _correct_accumulator(m) st_run.mot[m].substep_accumulator = (int32_t)(((int64_t)st_run.mot[m].substep_accumulator * seg->mot[m].accumulator_correction) >> ACCUMULATOR_CORRECTION_BITS)
+#else
+#define _correct_accumulator(m) st_run.mot[m].substep_accumulator *= seg->mot[m].accumulator_correction
+#endif
+
 /**** Setup motate ****/
 
 #ifdef __ARM
@@ -212,6 +233,102 @@ Stepper<MOTOR_6,
 		kSocket6_Microstep_2PinNumber,
 		kSocket6_VrefPinNumber> motor_6;
 
+/*
+ * Motors by number
+ *
+ *	MotorOf<motor> gives the Stepper object and step pin for a motor number at compile time,
+ *	so the DDA ISR and the loader can be written once and instantiated over MOTORS (see
+ *	DDAStep and DDALoad). A motor whose step pin is null drops out of both. A board with
+ *	more motors adds its sockets here.
+ */
+template<uint8_t motor> struct MotorOf;				// no default - every motor < MOTORS needs one
+template<> struct MotorOf<MOTOR_1> {
+	typedef Pin<kSocket1_StepPinNumber> step_pin;
+	static inline decltype(motor_1) &stepper() { return motor_1; }
+};
+template<> struct MotorOf<MOTOR_2> {
+	typedef Pin<kSocket2_StepPinNumber> step_pin;
+	static inline decltype(motor_2) &stepper() { return motor_2; }
+};
+template<> struct MotorOf<MOTOR_3> {
+	typedef Pin<kSocket3_StepPinNumber> step_pin;
+	static inline decltype(motor_3) &stepper() { return motor_3; }
+};
+template<> struct MotorOf<MOTOR_4> {
+	typedef Pin<kSocket4_StepPinNumber> step_pin;
+	static inline decltype(motor_4) &stepper() { return motor_4; }
+};
+template<> struct MotorOf<MOTOR_5> {
+	typedef Pin<kSocket5_StepPinNumber> step_pin;
+	static inline decltype(motor_5) &stepper() { return motor_5; }
+};
+template<> struct MotorOf<MOTOR_6> {
+	typedef Pin<kSocket6_StepPinNumber> step_pin;
+	static inline decltype(motor_6) &stepper() { return motor_6; }
+};
+
+/*
+ * Step pins by port
+ *
+ *	The DDA ISR collects the step bits for each port and writes them with a single
+ *	set (SODR) and a single clear (CODR) per port, instead of one write per motor.
+ *	The port masks are worked out at compile time from the board's pin assignments.
+ *	Unused sockets are null pins with a zero mask, and ports that carry no step pins
+ *	have a zero mask and drop out of the compiled code.
+ */
+#define STEP_PORTS 4									// ports 'A' - 'D'
+#define STEP_PORT_INDEX(letter) (((letter) - 'A') & (STEP_PORTS-1))
+
+template<uint8_t portLetter, uint8_t motors = MOTORS>
+struct StepPortMask {									// OR of all step pin masks on a port
+	static const uint32_t mask = StepPortMask<portLetter, motors-1>::mask |
+		((MotorOf<motors-1>::step_pin::portLetter == portLetter) ? MotorOf<motors-1>::step_pin::mask : 0);
+};
+template<uint8_t portLetter>
+struct StepPortMask<portLetter, 0> {
+	static const uint32_t mask = 0;
+};
+
+template<uint8_t motors = MOTORS>
+struct DDAStep {										// accumulate step bits for motors 0 to motors-1
+	static inline void accumulate(uint32_t step_bits[]) __attribute__((always_inline)) {
+		DDAStep<motors-1>::accumulate(step_bits);
+		typedef typename MotorOf<motors-1>::step_pin step_pin;
+		if ((step_pin::mask != 0) &&
+			((st_run.mot[motors-1].substep_accumulator += st_run.mot[motors-1].substep_increment) > 0)) {
+			step_bits[STEP_PORT_INDEX(step_pin::portLetter)] |= step_pin::mask;
+			st_run.mot[motors-1].substep_accumulator -= st_run.dda_ticks_X_substeps;
+			INCREMENT_ENCODER(motors-1);
+		}
+	}
+};
+template<>
+struct DDAStep<0> {
+	static inline void accumulate(uint32_t step_bits[]) __attribute__((always_inline)) {}
+};
+
+template<uint8_t portLetter>
+static inline void _set_step_port(const uint32_t step_bits[]) __attribute__((always_inline));
+template<uint8_t portLetter>
+static inline void _set_step_port(const uint32_t step_bits[])
+{
+	if (StepPortMask<portLetter>::mask != 0) {
+		Port32<portLetter> port;
+		port.set(step_bits[STEP_PORT_INDEX(portLetter)]);
+	}
+}
+
+template<uint8_t portLetter>
+static inline void _clear_step_port(void) __attribute__((always_inline));
+template<uint8_t portLetter>
+static inline void _clear_step_port(void)
+{
+	if (StepPortMask<portLetter>::mask != 0) {
+		Port32<portLetter> port;
+		port.clear(StepPortMask<portLetter>::mask);
+	}
+}
+
 #endif // __ARM
 
 /************************************************************************************
@@ -243,6 +360,7 @@ void stepper_init()
 	memset(&st_run, 0, sizeof(st_run));			// clear all values, pointers and status
 	memset(&st_pre, 0, sizeof(st_pre));			// clear all values, pointers and status
 	stepper_init_assertions();
+	ik_set_motor_map();							// all motors get zero steps until config_init()
 
 #ifdef __AVR
 	// Configure virtual ports
@@ -284,6 +402,8 @@ void stepper_init()
 	// If you need more pulse width you need to drop the DDA clock rate
 	dda_timer.setInterrupts(kInterruptOnOverflow | kInterruptOnMatchA | kInterruptPriorityHighest);
 	dda_timer.setDutyCycleA(1.0 - 0.75);		// This is a 75% duty cycle on the ON step part
+	st_run.dda_top = dda_timer.getTopValue();	// keep the pulse width when the clock is divided
+	st_run.dda_pulse = st_run.dda_top - (uint32_t)(st_run.dda_top * (1.0 - 0.75));
 
 	// setup DWELL timer
 	dwell_timer.setInterrupts(kInterruptOnOverflow | kInterruptPriorityHighest);
@@ -293,7 +413,6 @@ void stepper_init()
 
 	// setup software interrupt exec timer & initial condition
 	exec_timer.setInterrupts(kInterruptOnSoftwareTrigger | kInterruptPriorityLowest);
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;
 
 	// setup motor power levels and apply power level to stepper drivers
 	for (uint8_t motor=0; motor<MOTORS; motor++) {
@@ -316,11 +435,13 @@ void stepper_reset()
     dda_timer.stop();                                   // stop all movement
     dwell_timer.stop();
     st_run.dda_ticks_downcount = 0;                     // signal the runtime is not busy
-    st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;    // set to EXEC or it won't restart
+    st_pre.head = 0;                                    // empty the prep ring or it won't restart
+    st_pre.tail = 0;
+    st_pre.underruns = 0;                               // diagnostic only - no action effect
+    st_run.locked_motors = 0;
 
 	for (uint8_t motor=0; motor<MOTORS; motor++) {
 		st_pre.mot[motor].prev_direction = STEP_INITIAL_DIRECTION;
-        st_pre.mot[motor].direction = STEP_INITIAL_DIRECTION;
 		st_run.mot[motor].substep_accumulator = 0;      // will become max negative during per-motor setup;
 		st_pre.mot[motor].corrected_steps = 0;          // diagnostic only - no action effect
 	}
@@ -440,6 +561,46 @@ static void _deenergize_motor(const uint8_t motor)
 #endif
 }
 
+/*
+ * st_lock_motors()   - stop motors dead, in the middle of a move (bit per motor)
+ * st_unlock_motors() - let them step again from the next segment
+ *
+ *	Group homing calls st_lock_motors() from the input interrupt when a motor's homing switch
+ *	changes, so that motor stops at the switch while the rest of the move runs on. A locked
+ *	motor gets no steps - in the segment now running or any loaded after - and its encoder
+ *	stops with it, so the planner's position for its axis is stale until the caller sets it
+ *	from the encoders. The increments are written with interrupts off because a 64 bit DDA
+ *	(__DDA_64BIT) can't store one in a single write.
+ *
+ *	Unlock only with the runtime stopped. A locked motor misses the accumulator corrections
+ *	for the segments it sat out, so its accumulator is reset as stepper_reset() does it -
+ *	left alone it can come back far positive and fire a burst of steps.
+ */
+
+void st_lock_motors(const uint8_t motors)
+{
+	__disable_irq();
+	st_run.locked_motors |= motors;
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		if (motors & (1<<motor)) {
+			st_run.mot[motor].substep_increment = 0;
+		}
+	}
+	__enable_irq();
+}
+
+void st_unlock_motors()
+{
+	__disable_irq();
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		if (st_run.locked_motors & (1<<motor)) {
+			st_run.mot[motor].substep_accumulator = 0;
+		}
+	}
+	st_run.locked_motors = 0;
+	__enable_irq();
+}
+
 static void _energize_motor(const uint8_t motor, float timeout_seconds)
 {
 	if (st_cfg.mot[motor].power_mode == MOTOR_DISABLED) {
@@ -518,7 +679,7 @@ void st_deenergize_motors()
 stat_t st_motor_power_callback() 	// called by controller
 {
     bool have_actually_stopped = false;
-    if ((!st_runtime_isbusy()) && (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER)) {	// if there are no moves to load...
+    if ((!st_runtime_isbusy()) && _prep_is_empty()) {	// if there are no moves to load...
         have_actually_stopped = true;
     }
 
@@ -611,8 +772,10 @@ ISR(TIMER_DDA_ISR_vect)
  *	This way the length of the stepper pulse can be controlled by setting the match value.
  *  Note that this makes the pulse timing the inverted duty cycle.
  *
- *	Note that the motor_N.step.isNull() tests are compile-time tests, not run-time tests.
- *	If motor_N is not defined that if{} clause (i.e. that motor) drops out of the complied code.
+ *	Step bits are gathered per port and written once per port (see DDAStep and StepPortMask).
+ *	The null pin and zero mask tests are compile-time tests, not run-time tests. If a motor's
+ *	step pin is not defined that motor drops out of the compiled code, as does any port with
+ *	no step pins on it.
  */
 namespace Motate {			// Must define timer interrupts inside the Motate namespace
 MOTATE_TIMER_INTERRUPT(dda_timer_num)
@@ -620,45 +783,18 @@ MOTATE_TIMER_INTERRUPT(dda_timer_num)
 	uint32_t interrupt_cause = dda_timer.getInterruptCause();	// also clears interrupt condition
 //    dda_debug_pin2=1;
 	if (interrupt_cause == kInterruptOnMatchA) {
-
-		if (!motor_1.step.isNull() && (st_run.mot[MOTOR_1].substep_accumulator += st_run.mot[MOTOR_1].substep_increment) > 0) {
-			motor_1.step.set();		// turn step bit on
-			st_run.mot[MOTOR_1].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_1);
-		}
-		if (!motor_2.step.isNull() && (st_run.mot[MOTOR_2].substep_accumulator += st_run.mot[MOTOR_2].substep_increment) > 0) {
-			motor_2.step.set();
-			st_run.mot[MOTOR_2].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_2);
-		}
-		if (!motor_3.step.isNull() && (st_run.mot[MOTOR_3].substep_accumulator += st_run.mot[MOTOR_3].substep_increment) > 0) {
-			motor_3.step.set();
-			st_run.mot[MOTOR_3].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_3);
-		}
-		if (!motor_4.step.isNull() && (st_run.mot[MOTOR_4].substep_accumulator += st_run.mot[MOTOR_4].substep_increment) > 0) {
-			motor_4.step.set();
-			st_run.mot[MOTOR_4].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_4);
-		}
-		if (!motor_5.step.isNull() && (st_run.mot[MOTOR_5].substep_accumulator += st_run.mot[MOTOR_5].substep_increment) > 0) {
-			motor_5.step.set();
-			st_run.mot[MOTOR_5].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_5);
-		}
-		if (!motor_6.step.isNull() && (st_run.mot[MOTOR_6].substep_accumulator += st_run.mot[MOTOR_6].substep_increment) > 0) {
-			motor_6.step.set();
-			st_run.mot[MOTOR_6].substep_accumulator -= st_run.dda_ticks_X_substeps;
-			INCREMENT_ENCODER(MOTOR_6);
-		}
+		uint32_t step_bits[STEP_PORTS] = { 0, 0, 0, 0 };
+		DDAStep<>::accumulate(step_bits);				// run the DDA for every motor
+		_set_step_port<'A'>(step_bits);					// turn step bits on - one write per port
+		_set_step_port<'B'>(step_bits);
+		_set_step_port<'C'>(step_bits);
+		_set_step_port<'D'>(step_bits);
 
 	} else if (interrupt_cause == kInterruptOnOverflow) {
-		motor_1.step.clear();							// turn step bits off
-		motor_2.step.clear();
-		motor_3.step.clear();
-		motor_4.step.clear();
-		motor_5.step.clear();
-		motor_6.step.clear();
+		_clear_step_port<'A'>();						// turn step bits off
+		_clear_step_port<'B'>();
+		_clear_step_port<'C'>();
+		_clear_step_port<'D'>();
 
 		if (--st_run.dda_ticks_downcount != 0) return;
 
@@ -712,7 +848,7 @@ MOTATE_TIMER_INTERRUPT(dwell_timer_num)
 #ifdef __AVR
 void st_request_exec_move()
 {
-	if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {// bother interrupting
+	if (_prep_has_room()) {								// bother interrupting
 //		st_pre.exec_isbusy |= EXEC_BUSY_FLAG;
 		TIMER_EXEC.PER = EXEC_TIMER_PERIOD;
 		TIMER_EXEC.CTRLA = EXEC_TIMER_ENABLE;				// trigger a LO interrupt
@@ -721,14 +857,7 @@ void st_request_exec_move()
 
 ISR(TIMER_EXEC_ISR_vect) {								// exec move SW interrupt
 	TIMER_EXEC.CTRLA = EXEC_TIMER_DISABLE;				// disable SW interrupt timer
-
-	// exec_move
-	if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {
-		if (mp_exec_move() != STAT_NOOP) {
-			st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
-			st_request_load_move();
-		}
-	}
+	_exec_move();
 //	st_pre.exec_isbusy &= ~EXEC_BUSY_FLAG;
 }
 #endif // __AVR
@@ -736,7 +865,7 @@ ISR(TIMER_EXEC_ISR_vect) {								// exec move SW interrupt
 #ifdef __ARM
 void st_request_exec_move()
 {
-	if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {// bother interrupting
+	if (_prep_has_room()) {								// bother interrupting
 //		st_pre.exec_isbusy |= EXEC_BUSY_FLAG;
 		exec_timer.setInterruptPending();
 	}
@@ -746,18 +875,38 @@ namespace Motate {	// Define timer inside Motate namespace
 	MOTATE_TIMER_INTERRUPT(exec_timer_num)				// exec move SW interrupt
 	{
 		exec_timer.getInterruptCause();					// clears the interrupt condition
-		if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {
-			if (mp_exec_move() != STAT_NOOP) {
-				st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
-				st_request_load_move();
-			}
-		}
+		_exec_move();
 //		st_pre.exec_isbusy &= ~EXEC_BUSY_FLAG;
 	}
 } // namespace Motate
 
 #endif // __ARM
 
+/*
+ * _exec_move() - fill the prep ring from the planner. Runs in the exec SW interrupt
+ *
+ *	Each mp_exec_move() call stages at most one slot. A call that does something but
+ *	stages nothing (e.g. waiting for the steppers to stop in a feedhold) is passed to the
+ *	loader as a null, so the exec gets called back when the running segment ends - the
+ *	same round trip it made when there was only one prep buffer. Nothing more is staged
+ *	behind a null or a command until the loader has run it, as the next call can't make
+ *	progress before then (a command's planner buffer isn't released until it runs).
+ */
+
+static void _exec_move()
+{
+	while (_prep_has_room()) {
+		uint8_t slot = st_pre.head;
+		if (mp_exec_move() == STAT_NOOP) {
+			break;
+		}
+		if (st_pre.head == slot) {						// nothing staged
+			_prep_commit(MOVE_TYPE_NULL);
+		}
+	}
+	st_request_load_move();
+}
+
 /****************************************************************************************
  * Loader sequencing code
  * st_request_load_move() - fires a software interrupt (timer) to request to load a move
@@ -774,7 +923,7 @@ void st_request_load_move()
 	if (st_runtime_isbusy()) {
 		return;													// don't request a load if the runtime is busy
 	}
-	if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_LOADER) {	// bother interrupting
+	if (!_prep_is_empty()) {									// bother interrupting
 //		st_pre.exec_isbusy |= LOAD_BUSY_FLAG;
 		TIMER_LOAD.PER = LOAD_TIMER_PERIOD;
 		TIMER_LOAD.CTRLA = LOAD_TIMER_ENABLE;					// trigger a HI interrupt
@@ -794,7 +943,7 @@ void st_request_load_move()
 	if (st_runtime_isbusy()) {                                  // don't request a load if the runtime is busy
 		return;
 	}
-	if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_LOADER) {	// bother interrupting
+	if (!_prep_is_empty()) {									// bother interrupting
 //		st_pre.exec_isbusy |= LOAD_BUSY_FLAG;
 		load_timer.setInterruptPending();
 	}
@@ -810,6 +959,77 @@ namespace Motate {	// Define timer inside Motate namespace
 } // namespace Motate
 #endif // __ARM
 
+/*
+ * _load_motor() - load one motor's part of a segment
+ * DDALoad<>	 - _load_motor() for every motor, as one straight-line body
+ *
+ *	These sections are somewhat optimized for execution speed. The whole load operation
+ *	is supposed to take < 10 uSec (Xmega). Be careful if you mess with this. The motor
+ *	number is a template argument so every index is a constant, and a motor with a null
+ *	step pin drops out entirely.
+ */
+#ifdef __ARM
+template<uint8_t motor>
+static inline void _load_motor(stPrepSegment_t *seg) __attribute__((always_inline));
+template<uint8_t motor>
+static inline void _load_motor(stPrepSegment_t *seg)
+{
+	if (MotorOf<motor>::step_pin::mask == 0) {
+		return;
+	}
+	// the following if() statement sets the runtime substep increment value or zeroes it
+	// (a locked motor gets zero - see st_lock_motors())
+	if ((st_run.mot[motor].substep_increment =
+		 ((st_run.locked_motors & (1<<motor)) ? 0 : seg->mot[motor].substep_increment)) != 0) {
+
+		// NB: If motor has 0 steps the following is all skipped. This ensures that state comparisons
+		//	   always operate on the last segment actually run by this motor, regardless of how many
+		//	   segments it may have been inactive in between.
+
+		// Apply accumulator correction if the time base has changed since previous segment
+		if (seg->mot[motor].accumulator_correction_flag == true) {
+			seg->mot[motor].accumulator_correction_flag = false;
+			_correct_accumulator(motor);
+		}
+
+		// Detect direction change and if so:
+		//	- Set the direction bit in hardware.
+		//	- Compensate for direction change by flipping substep accumulator value about its midpoint.
+
+		if (seg->mot[motor].direction != st_pre.mot[motor].prev_direction) {
+			st_pre.mot[motor].prev_direction = seg->mot[motor].direction;
+			st_run.mot[motor].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[motor].substep_accumulator);
+			MotorOf<motor>::stepper().setDirection(seg->mot[motor].direction);
+		}
+
+		// Enable the stepper and start motor power management
+		MotorOf<motor>::stepper().enable();				// enable the motor (clear the ~Enable line)
+		st_run.mot[motor].power_state = MOTOR_RUNNING;
+		SET_ENCODER_STEP_SIGN(motor, seg->mot[motor].step_sign);
+
+	} else {  // Motor has 0 steps; might need to energize motor for power mode processing
+		if (st_cfg.mot[motor].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
+			MotorOf<motor>::stepper().enable();			// energize motor
+			st_run.mot[motor].power_state = MOTOR_POWER_TIMEOUT_START;
+		}
+	}
+	// accumulate counted steps to the step position and zero out counted steps for the segment currently being loaded
+	ACCUMULATE_ENCODER(motor);
+}
+
+template<uint8_t motors = MOTORS>
+struct DDALoad {										// load motors 0 to motors-1, in order
+	static inline void load(stPrepSegment_t *seg) __attribute__((always_inline)) {
+		DDALoad<motors-1>::load(seg);
+		_load_motor<motors-1>(seg);
+	}
+};
+template<>
+struct DDALoad<0> {
+	static inline void load(stPrepSegment_t *seg) __attribute__((always_inline)) {}
+};
+#endif // __ARM
+
 /****************************************************************************************
  * _load_move() - Dequeue move and load into stepper struct
  *
@@ -831,7 +1051,10 @@ static void _load_move()
 	if (st_runtime_isbusy()) {
 		return;													// exit if the runtime is busy
 	}
-	if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_LOADER) {	// if there are no moves to load...
+	if (_prep_is_empty()) {										// if there are no moves to load...
+		if (cm.motion_state == MOTION_RUN) {
+			st_pre.underruns++;									// ...and there should have been
+		}
 		for (uint8_t motor = MOTOR_1; motor < MOTORS; motor++) {
 			st_run.mot[motor].power_state = MOTOR_POWER_TIMEOUT_START;	// ...start motor power timeouts
 		}
@@ -839,152 +1062,32 @@ static void _load_move()
 	}
 
     dda_debug_pin2=1;
+	stPrepSegment_t *seg = &st_pre.seg[st_pre.tail];
 
 	// handle aline loads first (most common case)  NB: there are no more lines, only alines
-	if (st_pre.move_type == MOVE_TYPE_ALINE) {
+	if (seg->move_type == MOVE_TYPE_ALINE) {
 
 		//**** setup the new segment ****
 
-		st_run.dda_ticks_downcount = st_pre.dda_ticks;
-		st_run.dda_ticks_X_substeps = st_pre.dda_ticks_X_substeps;
-
-		//**** MOTOR_1 LOAD ****
-
-		// These sections are somewhat optimized for execution speed. The whole load operation
-		// is supposed to take < 10 uSec (Xmega). Be careful if you mess with this.
-
-		// the following if() statement sets the runtime substep increment value or zeroes it
-		if ((st_run.mot[MOTOR_1].substep_increment = st_pre.mot[MOTOR_1].substep_increment) != 0) {
-
-			// NB: If motor has 0 steps the following is all skipped. This ensures that state comparisons
-			//	   always operate on the last segment actually run by this motor, regardless of how many
-			//	   segments it may have been inactive in between.
-
-			// Apply accumulator correction if the time base has changed since previous segment
-			if (st_pre.mot[MOTOR_1].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_1].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_1].substep_accumulator *= st_pre.mot[MOTOR_1].accumulator_correction;
-			}
-
-			// Detect direction change and if so:
-			//	- Set the direction bit in hardware.
-			//	- Compensate for direction change by flipping substep accumulator value about its midpoint.
+		st_run.dda_ticks_downcount = seg->dda_ticks;
+		st_run.dda_ticks_X_substeps = seg->dda_ticks_X_substeps;
 
-			if (st_pre.mot[MOTOR_1].direction != st_pre.mot[MOTOR_1].prev_direction) {
-				st_pre.mot[MOTOR_1].prev_direction = st_pre.mot[MOTOR_1].direction;
-				st_run.mot[MOTOR_1].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_1].substep_accumulator);
-                motor_1.setDirection(st_pre.mot[MOTOR_1].direction);
-			}
-
-			// Enable the stepper and start motor power management
-			motor_1.enable();								// enable the motor (clear the ~Enable line)
-			st_run.mot[MOTOR_1].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_1, st_pre.mot[MOTOR_1].step_sign);
-
-		} else {  // Motor has 0 steps; might need to energize motor for power mode processing
-			if (st_cfg.mot[MOTOR_1].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-				motor_1.enable();									// energize motor
-				st_run.mot[MOTOR_1].power_state = MOTOR_POWER_TIMEOUT_START;
-			}
-		}
-		// accumulate counted steps to the step position and zero out counted steps for the segment currently being loaded
-		ACCUMULATE_ENCODER(MOTOR_1);
-
-#if (MOTORS >= 2)
-		if ((st_run.mot[MOTOR_2].substep_increment = st_pre.mot[MOTOR_2].substep_increment) != 0) {
-			if (st_pre.mot[MOTOR_2].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_2].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_2].substep_accumulator *= st_pre.mot[MOTOR_2].accumulator_correction;
-			}
-			if (st_pre.mot[MOTOR_2].direction != st_pre.mot[MOTOR_2].prev_direction) {
-				st_pre.mot[MOTOR_2].prev_direction = st_pre.mot[MOTOR_2].direction;
-				st_run.mot[MOTOR_2].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_2].substep_accumulator);
-                motor_2.setDirection(st_pre.mot[MOTOR_2].direction);
-
-			}
-			motor_2.enable(); st_run.mot[MOTOR_2].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_2, st_pre.mot[MOTOR_2].step_sign);
-		} else if (st_cfg.mot[MOTOR_2].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-			motor_2.enable(); st_run.mot[MOTOR_2].power_state = MOTOR_POWER_TIMEOUT_START;
-		}
-		ACCUMULATE_ENCODER(MOTOR_2);
-#endif
-#if (MOTORS >= 3)
-		if ((st_run.mot[MOTOR_3].substep_increment = st_pre.mot[MOTOR_3].substep_increment) != 0) {
-			if (st_pre.mot[MOTOR_3].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_3].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_3].substep_accumulator *= st_pre.mot[MOTOR_3].accumulator_correction;
-			}
-			if (st_pre.mot[MOTOR_3].direction != st_pre.mot[MOTOR_3].prev_direction) {
-				st_pre.mot[MOTOR_3].prev_direction = st_pre.mot[MOTOR_3].direction;
-				st_run.mot[MOTOR_3].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_3].substep_accumulator);
-                motor_3.setDirection(st_pre.mot[MOTOR_3].direction);
-
-			}
-			motor_3.enable(); st_run.mot[MOTOR_3].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_3, st_pre.mot[MOTOR_3].step_sign);
-		} else if (st_cfg.mot[MOTOR_3].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-			motor_3.enable(); st_run.mot[MOTOR_3].power_state = MOTOR_POWER_TIMEOUT_START;
+		// Change the DDA clock rate if the segment needs it. The DDA timer is always stopped
+		// here - the ISR stops it at the end of every segment - so the new period starts clean.
+		if (seg->dda_shift != st_run.dda_shift) {
+			st_run.dda_shift = seg->dda_shift;
+			dda_timer.setTop(st_run.dda_top << st_run.dda_shift);
+			dda_timer.setExactDutyCycleA((st_run.dda_top << st_run.dda_shift) - st_run.dda_pulse);
 		}
-		ACCUMULATE_ENCODER(MOTOR_3);
-#endif
-#if (MOTORS >= 4)
-		if ((st_run.mot[MOTOR_4].substep_increment = st_pre.mot[MOTOR_4].substep_increment) != 0) {
-			if (st_pre.mot[MOTOR_4].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_4].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_4].substep_accumulator *= st_pre.mot[MOTOR_4].accumulator_correction;
-			}
-			if (st_pre.mot[MOTOR_4].direction != st_pre.mot[MOTOR_4].prev_direction) {
-				st_pre.mot[MOTOR_4].prev_direction = st_pre.mot[MOTOR_4].direction;
-				st_run.mot[MOTOR_4].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_4].substep_accumulator);
-                motor_4.setDirection(st_pre.mot[MOTOR_4].direction);
 
-			}
-			motor_4.enable(); st_run.mot[MOTOR_4].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_4, st_pre.mot[MOTOR_4].step_sign);
-		} else if (st_cfg.mot[MOTOR_4].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-			motor_4.enable(); st_run.mot[MOTOR_4].power_state = MOTOR_POWER_TIMEOUT_START;
-		}
-		ACCUMULATE_ENCODER(MOTOR_4);
-#endif
-#if (MOTORS >= 5)
-		if ((st_run.mot[MOTOR_5].substep_increment = st_pre.mot[MOTOR_5].substep_increment) != 0) {
-			if (st_pre.mot[MOTOR_5].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_5].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_5].substep_accumulator *= st_pre.mot[MOTOR_5].accumulator_correction;
-			}
-			if (st_pre.mot[MOTOR_5].direction != st_pre.mot[MOTOR_5].prev_direction) {
-				st_pre.mot[MOTOR_5].prev_direction = st_pre.mot[MOTOR_5].direction;
-				st_run.mot[MOTOR_5].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_5].substep_accumulator);
-                motor_5.setDirection(st_pre.mot[MOTOR_5].direction);
+		//**** MOTOR LOADS ****
 
-			}
-			motor_5.enable(); st_run.mot[MOTOR_5].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_5, st_pre.mot[MOTOR_5].step_sign);
-		} else if (st_cfg.mot[MOTOR_5].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-			motor_5.enable(); st_run.mot[MOTOR_5].power_state = MOTOR_POWER_TIMEOUT_START;
-		}
-		ACCUMULATE_ENCODER(MOTOR_5);
-#endif
-#if (MOTORS >= 6)
-		if ((st_run.mot[MOTOR_6].substep_increment = st_pre.mot[MOTOR_6].substep_increment) != 0) {
-			if (st_pre.mot[MOTOR_6].accumulator_correction_flag == true) {
-				st_pre.mot[MOTOR_6].accumulator_correction_flag = false;
-				st_run.mot[MOTOR_6].substep_accumulator *= st_pre.mot[MOTOR_6].accumulator_correction;
-			}
-			if (st_pre.mot[MOTOR_6].direction != st_pre.mot[MOTOR_6].prev_direction) {
-				st_pre.mot[MOTOR_6].prev_direction = st_pre.mot[MOTOR_6].direction;
-				st_run.mot[MOTOR_6].substep_accumulator = -(st_run.dda_ticks_X_substeps + st_run.mot[MOTOR_6].substep_accumulator);
-                motor_6.setDirection(st_pre.mot[MOTOR_6].direction);
+		DDALoad<>::load(seg);								// straight-line load of every motor
 
-			}
-			motor_6.enable(); st_run.mot[MOTOR_6].power_state = MOTOR_RUNNING;
-			SET_ENCODER_STEP_SIGN(MOTOR_6, st_pre.mot[MOTOR_6].step_sign);
-		} else if (st_cfg.mot[MOTOR_6].power_mode == MOTOR_POWERED_ONLY_WHEN_MOVING) {
-			motor_6.enable(); st_run.mot[MOTOR_6].power_state = MOTOR_POWER_TIMEOUT_START;
+		// the encoder counts now reach the start of this segment - keep the reference to match
+		for (uint8_t motor=0; motor<MOTORS; motor++) {
+			st_pre.mot[motor].commanded_steps = seg->mot[motor].position_steps;
 		}
-		ACCUMULATE_ENCODER(MOTOR_6);
-#endif
 
 		//**** do this last ****
 
@@ -992,20 +1095,20 @@ static void _load_move()
 		dda_timer.start();									// start the DDA timer if not already running
 
 	// handle dwells
-	} else if (st_pre.move_type == MOVE_TYPE_DWELL) {
-		st_run.dda_ticks_downcount = st_pre.dda_ticks;
+	} else if (seg->move_type == MOVE_TYPE_DWELL) {
+		st_run.dda_ticks_downcount = seg->dda_ticks;
 // OMC  st_pre.exec_isbusy |= DDA_DWELL_BUSY_FLAG;
 		dwell_timer.start();
 
 	// handle synchronous commands
-	} else if (st_pre.move_type == MOVE_TYPE_COMMAND) {
-		mp_runtime_command(st_pre.bf);
+	} else if (seg->move_type == MOVE_TYPE_COMMAND) {
+		mp_runtime_command(seg->bf);
 
 	} // else null - WARNING - We cannot printf from here!! Causes crashes.
 
 	// all other cases drop to here (e.g. Null moves after Mcodes skip to here)
-	st_pre.move_type = MOVE_TYPE_NULL;
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;	// we are done with the prep buffer - flip the flag back
+	_prep_barrier();
+	st_pre.tail = _prep_next(st_pre.tail);				// we are done with the slot - hand it back to the exec
 	st_request_exec_move();								// exec and prep next move
     dda_debug_pin2=0;
 }
@@ -1024,20 +1127,130 @@ static void _load_move()
  *		floats that typically have fractional values (fractional steps). The sign
  *		indicates direction. Motors that are not in the move should be 0 steps on input.
  *
+ *	  - position_steps[] is where each motor is at the start of the segment, in steps. The loader
+ *		hands it to st_sample_encoders() when the segment starts running.
+ *
  *	  - following_error[] is a vector of measured errors to the step count. Used for correction.
  *
  *	  - segment_time - how many minutes the segment should run. If timing is not
  *		100% accurate this will affect the move velocity, but not the distance traveled.
  *
+ *	With __FIXED_POINT_EXEC the steps are fxsteps_t and the segment time is passed as DDA
+ *	ticks, which the exec works out once per section. Nothing in that version is float.
+ *
  * NOTE:  Many of the expressions are sensitive to casting and execution order to avoid long-term
  *		  accuracy errors due to floating point round off. One earlier failed attempt was:
  *		    dda_ticks_X_substeps = (int32_t)((microseconds/1000000) * f_dda * dda_substeps);
  */
 
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time)
+/*
+ * _dda_shift() - pick the DDA clock divider for a segment
+ *
+ *	Returns the largest shift (up to DDA_MAX_SHIFT) that leaves at least DDA_MIN_OVERSAMPLE
+ *	DDA ticks per step of the fastest motor. dda_ticks are at FREQUENCY_DDA and max_steps is
+ *	the whole steps of the fastest motor - the +1 covers the fraction and any step correction.
+ */
+
+static uint8_t _dda_shift(uint32_t dda_ticks, uint32_t max_steps)
+{
+	uint32_t min_ticks = DDA_MIN_OVERSAMPLE * (max_steps + 1);
+	uint8_t shift = 0;
+	while ((shift < DDA_MAX_SHIFT) && ((dda_ticks >> (shift+1)) >= min_ticks)) {
+		shift++;
+	}
+	return (shift);
+}
+
+#ifdef __FIXED_POINT_EXEC
+/*
+ * _fx_substeps() - absolute position in steps to DDA substeps, rounded
+ *
+ *	The increment is the difference of two of these rather than the travel times the
+ *	multiplier, so the roundings telescope - the increments of a run of segments add up to
+ *	exactly the substeps between its ends, however many segments it was cut into.
+ */
+
+static int64_t _fx_substeps(fxsteps_t steps)
+{
+	return ((steps >> FXSTEPS_BITS) * DDA_SUBSTEPS_FX +
+			(((steps & (FXSTEPS_ONE - 1)) * DDA_SUBSTEPS_FX + (FXSTEPS_ONE >> 1)) >> FXSTEPS_BITS));
+}
+
+stat_t st_prep_line(fxsteps_t travel_steps[], fxsteps_t position_steps[], fxsteps_t following_error[], uint32_t dda_ticks)
 {
 	// trap assertion failures and other conditions that would prevent queuing the line
-	if (st_pre.buffer_state != PREP_BUFFER_OWNED_BY_EXEC) {     // never supposed to happen
+	if (_prep_is_full()) {                                      // never supposed to happen
+        return (cm_panic(STAT_INTERNAL_ERROR, "prep sync"));
+	} else if (dda_ticks == 0) {
+        return (STAT_MINIMUM_TIME_MOVE);
+	}
+	stPrepSegment_t *seg = &st_pre.seg[st_pre.head];
+	fxsteps_t max_steps = 0;
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		max_steps = max(max_steps, (travel_steps[motor] < 0) ? -travel_steps[motor] : travel_steps[motor]);
+	}
+	seg->dda_shift = _dda_shift(dda_ticks, (uint32_t)(max_steps >> FXSTEPS_BITS));
+	dda_ticks = (dda_ticks + ((1 << seg->dda_shift) >> 1)) >> seg->dda_shift;	// ticks at the divided clock, rounded
+	seg->dda_period = _f_to_period(FREQUENCY_DDA);                  // FYI: this is a constant
+	seg->dda_ticks = dda_ticks;
+	seg->dda_ticks_X_substeps = (dda_substeps_t)dda_ticks * DDA_SUBSTEPS_FX;
+
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		seg->mot[motor].position_steps = position_steps[motor];
+
+		if (travel_steps[motor] == 0) { seg->mot[motor].substep_increment = 0; continue;}
+
+		if (travel_steps[motor] > 0) {
+			seg->mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
+			seg->mot[motor].step_sign = 1;
+		} else {
+			seg->mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
+			seg->mot[motor].step_sign = -1;
+		}
+
+		// The accumulator correction is the ratio of the tick counts, as in the float version.
+
+		seg->mot[motor].accumulator_correction_flag = false;
+		if (dda_ticks != st_pre.mot[motor].prev_dda_ticks) {
+			if (st_pre.mot[motor].prev_dda_ticks != 0) {				// special case to skip first move
+				seg->mot[motor].accumulator_correction_flag = true;
+#ifdef __DDA_64BIT
+				seg->mot[motor].accumulator_correction = st_pre.mot[motor].prev_dda_ticks;
+#else
+				seg->mot[motor].accumulator_correction = ((uint64_t)dda_ticks << ACCUMULATOR_CORRECTION_BITS) / st_pre.mot[motor].prev_dda_ticks;
+#endif
+			}
+			st_pre.mot[motor].prev_dda_ticks = dda_ticks;
+		}
+
+#ifdef __STEP_CORRECTION
+		fxsteps_t error = following_error[motor];
+		if ((--st_pre.mot[motor].correction_holdoff < 0) &&
+			((error > fx_from_steps(STEP_CORRECTION_THRESHOLD)) || (error < -fx_from_steps(STEP_CORRECTION_THRESHOLD)))) {
+
+			st_pre.mot[motor].correction_holdoff = STEP_CORRECTION_HOLDOFF;
+			fxsteps_t correction_steps = (error >> 16) * (int32_t)(STEP_CORRECTION_FACTOR * 65536);
+			fxsteps_t correction_max = min((travel_steps[motor] < 0) ? -travel_steps[motor] : travel_steps[motor],
+										   fx_from_steps(STEP_CORRECTION_MAX));
+			if (correction_steps > correction_max) { correction_steps = correction_max;}
+			if (correction_steps < -correction_max) { correction_steps = -correction_max;}
+			st_pre.mot[motor].corrected_steps += fx_to_steps(correction_steps);
+			travel_steps[motor] -= correction_steps;
+		}
+#endif
+		int64_t substeps = _fx_substeps(position_steps[motor] + travel_steps[motor]) - _fx_substeps(position_steps[motor]);
+		seg->mot[motor].substep_increment = (dda_substeps_t)((substeps < 0) ? -substeps : substeps);
+	}
+	_prep_commit(MOVE_TYPE_ALINE);						// signal that the slot is ready
+	return (STAT_OK);
+}
+
+#else // __FIXED_POINT_EXEC
+
+stat_t st_prep_line(float travel_steps[], float position_steps[], float following_error[], float segment_time)
+{
+	// trap assertion failures and other conditions that would prevent queuing the line
+	if (_prep_is_full()) {                                      // never supposed to happen
         return (cm_panic(STAT_INTERNAL_ERROR, "prep sync"));
 	} else if (isinf(segment_time)) {                           // never supposed to happen
         return (cm_panic(STAT_PREP_LINE_MOVE_TIME_IS_INFINITE, "prep isinf"));
@@ -1049,40 +1262,55 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
 	// setup segment parameters
 	// - dda_ticks is the integer number of DDA clock ticks needed to play out the segment
 	// - ticks_X_substeps is the maximum depth of the DDA accumulator (as a negative number)
+	// - dda_shift divides the DDA clock for slow segments (see _dda_shift())
 
-	st_pre.dda_period = _f_to_period(FREQUENCY_DDA);                // FYI: this is a constant
-	st_pre.dda_ticks = (int32_t)(segment_time * 60 * FREQUENCY_DDA);// NB: converts minutes to seconds
-	st_pre.dda_ticks_X_substeps = st_pre.dda_ticks * DDA_SUBSTEPS;
+	stPrepSegment_t *seg = &st_pre.seg[st_pre.head];
+	uint32_t dda_ticks = (uint32_t)(segment_time * 60 * FREQUENCY_DDA);	// NB: converts minutes to seconds
+	float max_steps = 0;
+	for (uint8_t motor=0; motor<MOTORS; motor++) {
+		max_steps = max(max_steps, fabs(travel_steps[motor]));
+	}
+	seg->dda_shift = _dda_shift(dda_ticks, (uint32_t)max_steps);
+	seg->dda_period = _f_to_period(FREQUENCY_DDA);                  // FYI: this is a constant
+	seg->dda_ticks = (dda_ticks + ((1 << seg->dda_shift) >> 1)) >> seg->dda_shift;
+	seg->dda_ticks_X_substeps = seg->dda_ticks * DDA_SUBSTEPS;
 
 	// setup motor parameters
 
 	float correction_steps;
 	for (uint8_t motor=0; motor<MOTORS; motor++) {	// remind us that this is motors, not axes
+		seg->mot[motor].position_steps = position_steps[motor];
 
 		// Skip this motor if there are no new steps. Leave all other values intact.
-		if (fp_ZERO(travel_steps[motor])) { st_pre.mot[motor].substep_increment = 0; continue;}
+		if (fp_ZERO(travel_steps[motor])) { seg->mot[motor].substep_increment = 0; continue;}
 
 		// Setup the direction, compensating for polarity.
 		// Set the step_sign which is used by the stepper ISR to accumulate step position
 
 		if (travel_steps[motor] >= 0) {					// positive direction
-			st_pre.mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
-			st_pre.mot[motor].step_sign = 1;
+			seg->mot[motor].direction = DIRECTION_CW ^ st_cfg.mot[motor].polarity;
+			seg->mot[motor].step_sign = 1;
 		} else {
-			st_pre.mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
-			st_pre.mot[motor].step_sign = -1;
+			seg->mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
+			seg->mot[motor].step_sign = -1;
 		}
 
-		// Detect segment time changes and setup the accumulator correction factor and flag.
-		// Putting this here computes the correct factor even if the motor was dormant for some
-		// number of previous moves. Correction is computed based on the last segment time actually used.
-
-		if (fabs(segment_time - st_pre.mot[motor].prev_segment_time) > 0.0000001) { // highly tuned FP != compare
-			if (fp_NOT_ZERO(st_pre.mot[motor].prev_segment_time)) {					// special case to skip first move
-				st_pre.mot[motor].accumulator_correction_flag = true;
-				st_pre.mot[motor].accumulator_correction = segment_time / st_pre.mot[motor].prev_segment_time;
+		// Detect changes in the segment's DDA ticks - segment time or DDA clock - and setup the
+		// accumulator correction factor and flag. Putting this here computes the correct factor even
+		// if the motor was dormant for some number of previous moves. Correction is computed based
+		// on the last tick count actually used, as that's the depth the accumulator was run at.
+
+		seg->mot[motor].accumulator_correction_flag = false;
+		if (seg->dda_ticks != st_pre.mot[motor].prev_dda_ticks) {
+			if (st_pre.mot[motor].prev_dda_ticks != 0) {				// special case to skip first move
+				seg->mot[motor].accumulator_correction_flag = true;
+#ifdef __DDA_64BIT
+				seg->mot[motor].accumulator_correction = st_pre.mot[motor].prev_dda_ticks;
+#else
+				seg->mot[motor].accumulator_correction = (float)seg->dda_ticks / (float)st_pre.mot[motor].prev_dda_ticks;
+#endif
 			}
-			st_pre.mot[motor].prev_segment_time = segment_time;
+			st_pre.mot[motor].prev_dda_ticks = seg->dda_ticks;
 		}
 
 #ifdef __STEP_CORRECTION
@@ -1108,21 +1336,61 @@ stat_t st_prep_line(float travel_steps[], float following_error[], float segment
 		// Rounding is performed to eliminate a negative bias in the uint32 conversion
 		// that results in long-term negative drift. (fabs/round order doesn't matter)
 
-		st_pre.mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS));
+		seg->mot[motor].substep_increment = round(fabs(travel_steps[motor] * DDA_SUBSTEPS));
 	}
-	st_pre.move_type = MOVE_TYPE_ALINE;
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;	// signal that prep buffer is ready
+	_prep_commit(MOVE_TYPE_ALINE);						// signal that the slot is ready
 	return (STAT_OK);
 }
+#endif // __FIXED_POINT_EXEC
+
+/*
+ * st_sample_encoders() - read the encoders and the position they should have reached
+ *
+ *	Encoder counts are accumulated when each segment is loaded, so they stand at the start
+ *	of the segment the steppers are running. That's several segments behind the exec when
+ *	the prep ring is full, and how many varies, so the loader keeps the commanded position
+ *	to go with them. Re-read if a load lands in the middle, so the pair always match.
+ */
+
+#ifdef __FIXED_POINT_EXEC
+void st_sample_encoders(fxsteps_t commanded_steps[], fxsteps_t encoder_steps[])
+#else
+void st_sample_encoders(float commanded_steps[], float encoder_steps[])
+#endif
+{
+	uint8_t tail;
+	do {
+		tail = st_pre.tail;
+		for (uint8_t motor=0; motor<MOTORS; motor++) {
+			commanded_steps[motor] = st_pre.mot[motor].commanded_steps;
+#ifdef __FIXED_POINT_EXEC
+			encoder_steps[motor] = (fxsteps_t)en.en[motor].encoder_steps << FXSTEPS_BITS;
+#else
+			encoder_steps[motor] = en_read_encoder(motor);
+#endif
+		}
+	} while (tail != st_pre.tail);
+}
+
+/*
+ * _prep_commit() - hand the slot at the head of the prep ring to the loader
+ */
+
+static void _prep_commit(moveType move_type)
+{
+	st_pre.seg[st_pre.head].move_type = move_type;
+	_prep_barrier();
+	st_pre.head = _prep_next(st_pre.head);
+}
 
 /*
  * st_prep_null() - Keeps the loader happy. Otherwise performs no action
+ *
+ *	Nothing is staged - the exec passes a null to the loader itself if it needs a callback.
  */
 
 void st_prep_null()
 {
-	st_pre.move_type = MOVE_TYPE_NULL;
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_EXEC;	// signal that prep buffer is empty
 }
 
 /*
@@ -1131,9 +1399,8 @@ void st_prep_null()
 
 void st_prep_command(void *bf)
 {
-	st_pre.move_type = MOVE_TYPE_COMMAND;
-	st_pre.bf = (mpBuf_t *)bf;
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;	// signal that prep buffer is ready
+	st_pre.seg[st_pre.head].bf = (mpBuf_t *)bf;
+	_prep_commit(MOVE_TYPE_COMMAND);					// signal that the slot is ready
 }
 
 /*
@@ -1142,10 +1409,10 @@ void st_prep_command(void *bf)
 
 void st_prep_dwell(float microseconds)
 {
-	st_pre.move_type = MOVE_TYPE_DWELL;
-	st_pre.dda_period = _f_to_period(FREQUENCY_DWELL);
-	st_pre.dda_ticks = (uint32_t)((microseconds/1000000) * FREQUENCY_DWELL);
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;	// signal that prep buffer is ready
+	stPrepSegment_t *seg = &st_pre.seg[st_pre.head];
+	seg->dda_period = _f_to_period(FREQUENCY_DWELL);
+	seg->dda_ticks = (uint32_t)((microseconds/1000000) * FREQUENCY_DWELL);
+	_prep_commit(MOVE_TYPE_DWELL);						// signal that the slot is ready
 }
 
 /*
@@ -1156,7 +1423,6 @@ void st_prep_dwell(float microseconds)
 void st_request_out_of_band_dwell(float microseconds)
 {
 	st_prep_dwell(microseconds);
-	st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER;	// signal that prep buffer is ready
 	st_request_load_move();
 }
 
@@ -1225,9 +1491,11 @@ static void _set_motor_steps_per_unit(nvObj_t *nv)
 	uint8_t m = _get_motor(nv->index);
 	st_cfg.mot[m].units_per_step = (st_cfg.mot[m].travel_rev * st_cfg.mot[m].step_angle) / (360 * st_cfg.mot[m].microsteps);
 	st_cfg.mot[m].steps_per_unit = 1/st_cfg.mot[m].units_per_step;
+	ik_set_motor_map();
 }
 
 /* PER-MOTOR FUNCTIONS
+ * st_set_ma() - set motor to axis map
  * st_set_sa() - set motor step angle
  * st_set_tr() - set travel per motor revolution
  * st_set_mi() - set motor microsteps
@@ -1235,6 +1503,13 @@ static void _set_motor_steps_per_unit(nvObj_t *nv)
  * st_set_pl() - set motor power level
  */
 
+stat_t st_set_ma(nvObj_t *nv)			// motor to axis map
+{
+	set_ui8(nv);
+	ik_set_motor_map();
+	return(STAT_OK);
+}
+
 stat_t st_set_sa(nvObj_t *nv)			// motor step angle
 {
 	set_flt(nv);
@@ -1357,6 +1632,7 @@ static const char fmt_0tr[] PROGMEM = "[%s%s] m%s travel per revolution%10.4f%s\
 static const char fmt_0po[] PROGMEM = "[%s%s] m%s polarity%18d [0=normal,1=reverse]\n";
 static const char fmt_0pm[] PROGMEM = "[%s%s] m%s power management%10d [0=disabled,1=always on,2=in cycle,3=when moving]\n";
 static const char fmt_0pl[] PROGMEM = "[%s%s] m%s motor power level%13.3f [0.000=minimum, 1.000=maximum]\n";
+static const char fmt_0hi[] PROGMEM = "[%s%s] m%s homing input%17d [input 1-N or 0 to use the axis input]\n";
 #ifdef __AVR
     static const char fmt_0mi[] PROGMEM = "[%s%s] m%s microsteps%16d [1,2,4,8]\n";
 #else
@@ -1389,5 +1665,6 @@ void st_print_mi(nvObj_t *nv) { _print_motor_int(nv, fmt_0mi);}
 void st_print_po(nvObj_t *nv) { _print_motor_int(nv, fmt_0po);}
 void st_print_pm(nvObj_t *nv) { _print_motor_int(nv, fmt_0pm);}
 void st_print_pl(nvObj_t *nv) { _print_motor_flt(nv, fmt_0pl);}
+void st_print_hi(nvObj_t *nv) { _print_motor_int(nv, fmt_0hi);}
 
 #endif // __TEXT_MODE
@@ -59,6 +59,9 @@
  *		going into pulse generation. On the ARM this is less of an issue, and we run a
  *		100 Khz (or higher) pulse rate.
  *
+ *		The ARM does divide the clock down for slow segments - those that would still get
+ *		DDA_MIN_OVERSAMPLE ticks per step at the lower rate (see Adaptive DDA clock, below).
+ *
  *    - Pulse timing is also helped by minimizing the time spent loading the next move
  *		segment. The time budget for the load is less than the time remaining before the
  *		next DDA clock tick. This means that the load must take < 10 uSec or the time
@@ -211,7 +214,10 @@
  *		be needed to run the move - in this example st_prep_line().
  *
  *	 7	st_prep_line() generates the timer and DDA values and stages these into
- *		the prep structure (sp) - ready for loading into the stepper runtime struct
+ *		the next free slot of the prep ring (st_pre) - ready for loading into the
+ *		stepper runtime struct. The exec keeps calling mp_exec_move() until the ring
+ *		is full, the planner runs dry, or it stages a command (which has to run
+ *		before the exec can look at the next planner buffer).
  *
  *	 8	stepper.st_prep_line() returns back to planner.mp_exec_move(), which
  *		frees the planning buffer (bf) back to the planner buffer pool if the
@@ -223,9 +229,10 @@
  *		to receive the next Gcode block. This handoff prevents possible data
  *		conflicts between the interrupt and main loop.
  *
- *	10	The final step in the sequence is _load_move() requesting the next
- *		segment to be executed and prepared by calling st_request_exec()
- *		- control goes back to step 4.
+ *	10	The final step in the sequence is _load_move() taking the oldest slot from
+ *		the ring and requesting the next segment to be executed and prepared by
+ *		calling st_request_exec() - control goes back to step 4. If the ring is
+ *		empty when a segment ends during a cycle that's counted as an underrun.
  *
  *	Note: For this to work you have to be really careful about what structures
  *	are modified at what level, and use volatiles where necessary.
@@ -250,10 +257,23 @@
  *********************************/
 //See hardware.h for platform specific stepper definitions
 
-typedef enum {
-	PREP_BUFFER_OWNED_BY_LOADER = 0,	// staging buffer is ready for load
-	PREP_BUFFER_OWNED_BY_EXEC			// staging buffer is being loaded
-} prepBufferState;
+/* PREP_BUFFER_DEPTH
+ *	The number of segments (or dwells, or commands) the exec can prepare ahead of the loader.
+ *	The prep buffer is a ring of PREP_BUFFER_DEPTH+1 slots; one is always left empty so the
+ *	exec and the loader can each own an index and neither has to lock the other out.
+ *	A depth of 1 is the old single staging buffer. Deeper buffers ride out exec ISRs that
+ *	are held off (by the planner or by comms) for longer than one segment, at the cost of
+ *	that many more segments of latency before a feedhold or override starts to take effect.
+ *	The settings file may override the default.
+ */
+#ifndef PREP_BUFFER_DEPTH
+#define PREP_BUFFER_DEPTH 3
+#endif
+#define PREP_BUFFER_SLOTS (PREP_BUFFER_DEPTH + 1)
+
+#if (PREP_BUFFER_DEPTH < 1) || (PREP_BUFFER_SLOTS > 255)
+#error "PREP_BUFFER_DEPTH must be between 1 and 254"
+#endif
 
 // Currently there is no distinction between IDLE and OFF (DEENERGIZED)
 // In the future IDLE will be powered at a low, torque-maintaining current
@@ -298,18 +318,71 @@ typedef enum {
  *
  *		MAX_LONG == 2^31, maximum signed long (depth of accumulator. NB: accumulator values are negative)
  *		FREQUENCY_DDA == DDA clock rate in Hz.
- *		NOM_SEGMENT_TIME == upper bound of segment time in minutes
+ *		MAX_SEGMENT_TIME == upper bound of segment time in minutes
  *		0.90 == a safety factor used to reduce the result from theoretical maximum
  *
  *	The number is about 8.5 million for the Xmega running a 50 KHz DDA with 5 millisecond segments
  *	The ARM is about 1/4 that (or less) as the DDA clock rate is 4x higher. Decreasing the nominal
  *	segment time increases the number precision.
+ *
+ *	With __DDA_64BIT (tinyg2.h) the accumulators, increments and depth are 64 bits, so the
+ *	precision no longer trades against segment length or DDA clock rate: DDA_SUBSTEPS is a
+ *	fixed 2^DDA_SUBSTEP_BITS, and even a 1 second segment at 1 MHz uses a fraction of the range.
+ *	A power of 2 also makes steps * DDA_SUBSTEPS exact in float. It costs an add-with-carry per
+ *	motor per DDA tick. The loader rescales the accumulator by the exact ratio of the tick
+ *	counts (a 64 bit multiply and divide) rather than by a float or fixed-point factor.
+ */
+#ifdef __DDA_64BIT
+typedef int64_t dda_accumulator_t;
+typedef uint64_t dda_substeps_t;
+#define DDA_SUBSTEP_BITS 24
+#define DDA_SUBSTEPS ((dda_substeps_t)1 << DDA_SUBSTEP_BITS)
+#else
+typedef int32_t dda_accumulator_t;
+typedef uint32_t dda_substeps_t;
+#define DDA_SUBSTEPS ((MAX_LONG * 0.90) / (FREQUENCY_DDA * (MAX_SEGMENT_TIME * 60)))
+#endif
+
+/* Adaptive DDA clock
+ *	A slow segment needs far fewer DDA ticks than FREQUENCY_DDA gives it, and most of those
+ *	interrupts do nothing. st_prep_line() divides the DDA clock for each segment by the largest
+ *	power of two (up to 2^DDA_MAX_SHIFT) that still leaves the fastest motor in the segment
+ *	DDA_MIN_OVERSAMPLE ticks per step, and _load_move() reprograms the timer when it changes.
+ *	The step pulse width stays the same at every rate. A smaller clock only shrinks the
+ *	accumulator depth, so DDA_SUBSTEPS still fits. Set DDA_MAX_SHIFT to 0 for a fixed clock.
+ */
+#ifndef DDA_MAX_SHIFT
+#define DDA_MAX_SHIFT		4						// 200 KHz down to 12.5 KHz
+#endif
+#ifndef DDA_MIN_OVERSAMPLE
+#define DDA_MIN_OVERSAMPLE	8						// least DDA ticks per step of the fastest motor
+#endif
+
+/* Fixed-point segment pipeline (__FIXED_POINT_EXEC in tinyg2.h)
+ *	The SAM3X has no FPU, so every float operation in the exec and prep is a library call.
+ *	With __FIXED_POINT_EXEC the per-segment work is integer: motor positions, travel and
+ *	following error are fxsteps_t - signed Q31.32 steps in an int64 - the forward differences
+ *	are integers (see _fx_init_section() in plan_exec.cpp), and the substep increments come
+ *	from an integer DDA_SUBSTEPS_FX. Floats are still used once per section.
+ *
+ *	Positions go to substeps in two parts (whole and fractional steps) so the products fit
+ *	in 64 bits for any position an fxsteps_t can hold.
  */
-#define DDA_SUBSTEPS ((MAX_LONG * 0.90) / (FREQUENCY_DDA * (NOM_SEGMENT_TIME * 60)))
+#ifdef __FIXED_POINT_EXEC
+typedef int64_t fxsteps_t;
+
+#define FXSTEPS_BITS 32								// binary point of fxsteps_t
+#define FXSTEPS_ONE ((fxsteps_t)1 << FXSTEPS_BITS)
+#define fx_from_steps(s) ((fxsteps_t)((s) * (float)FXSTEPS_ONE))
+#define fx_to_steps(q) ((float)(q) * ((float)1 / FXSTEPS_ONE))
+
+#define DDA_SUBSTEPS_FX ((uint32_t)DDA_SUBSTEPS)
+#define ACCUMULATOR_CORRECTION_BITS 24				// binary point of the fixed-point accumulator_correction
+#endif
 
 /* Step correction settings
  *	Step correction settings determine how the encoder error is fed back to correct position errors.
- *	Since the following_error is running 2 segments behind the current segment you have to be careful
+ *	Since the following_error is running PREP_BUFFER_DEPTH+1 segments behind the current segment you have to be careful
  *	not to overcompensate. The threshold determines if a correction should be applied, and the factor
  *	is how much. The holdoff is how many segments to wait before applying another correction. If threshold
  *	is too small and/or amount too large and/or holdoff is too small you may get a runaway correction
@@ -338,6 +411,30 @@ typedef enum {
  *	This allows the compiler to optimize the stepper inner-loops better.
  */
 
+/* Motor homing inputs
+ *	A motor with its own homing input ($1hi...) stops on that input during group homing,
+ *	instead of on its axis' input - so the two motors of a gantry axis square themselves
+ *	against their own switches (see cycle_homing.cpp). 0 follows the axis.
+ */
+#ifndef M1_HOMING_INPUT
+#define M1_HOMING_INPUT		0
+#endif
+#ifndef M2_HOMING_INPUT
+#define M2_HOMING_INPUT		0
+#endif
+#ifndef M3_HOMING_INPUT
+#define M3_HOMING_INPUT		0
+#endif
+#ifndef M4_HOMING_INPUT
+#define M4_HOMING_INPUT		0
+#endif
+#ifndef M5_HOMING_INPUT
+#define M5_HOMING_INPUT		0
+#endif
+#ifndef M6_HOMING_INPUT
+#define M6_HOMING_INPUT		0
+#endif
+
 // Motor config structure
 
 typedef struct cfgMotor {               // per-motor configs
@@ -351,6 +448,7 @@ typedef struct cfgMotor {               // per-motor configs
     float travel_rev;                   // mm or deg of travel per motor revolution
     float steps_per_unit;               // microsteps per mm (or degree) of travel
     float units_per_step;               // mm or degrees of travel per microstep
+    uint8_t homing_input;               // input that stops this motor in group homing, 0 = its axis' input
 
     // private
     float power_level_scaled;           // scaled to internal range - must be between 0 and 1
@@ -364,8 +462,8 @@ typedef struct stConfig {               // stepper configs
 // Motor runtime structure. Used exclusively by step generation ISR (HI)
 
 typedef struct stRunMotor {             // one per controlled motor
-    uint32_t substep_increment;         // total steps in axis times substeps factor
-    int32_t substep_accumulator;        // DDA phase angle accumulator
+    dda_substeps_t substep_increment;   // total steps in axis times substeps factor
+    dda_accumulator_t substep_accumulator;// DDA phase angle accumulator
     stPowerState power_state;           // state machine for managing motor power
     uint32_t power_systick;             // sys_tick for next motor power state transition
     float power_level_dynamic;          // power level for this segment of idle (ARM only)
@@ -374,7 +472,11 @@ typedef struct stRunMotor {             // one per controlled motor
 typedef struct stRunSingleton {         // Stepper static values and axis parameters
     magic_t magic_start;               // magic number to test memory integrity
     uint32_t dda_ticks_downcount;       // tick down-counter (unscaled)
-    uint32_t dda_ticks_X_substeps;      // ticks multiplied by scaling factor
+    dda_substeps_t dda_ticks_X_substeps;// ticks multiplied by scaling factor
+    uint8_t dda_shift;                  // DDA clock divider now in the timer (power of 2)
+    uint32_t dda_top;                   // DDA timer period at FREQUENCY_DDA (timer counts)
+    uint32_t dda_pulse;                 // step pulse width (timer counts)
+    volatile uint8_t locked_motors;     // motors held still by st_lock_motors(), bit per motor
     stRunMotor_t mot[MOTORS];           // runtime motor structures
     magic_t magic_end;
 } stRunSingleton_t;
@@ -383,40 +485,66 @@ typedef struct stRunSingleton {         // Stepper static values and axis parame
 // Must be careful about volatiles in this one
 
 typedef struct stPrepMotor {
-    uint32_t substep_increment;             // total steps in axis times substep factor
-
     // direction and direction change
-    uint8_t direction;                      // travel direction corrected for polarity (CW==0. CCW==1)
-    uint8_t prev_direction;                 // travel direction from previous segment run for this motor
-    int8_t step_sign;                       // set to +1 or -1 for encoders
+    uint8_t direction;                      // travel direction of the last segment prepped for this motor
+    uint8_t prev_direction;                 // travel direction from previous segment run for this motor (loader only)
 
     // following error correction
+#ifdef __FIXED_POINT_EXEC
+    fxsteps_t commanded_steps;              // position the segment now running started from (loader only)
+#else
+    float commanded_steps;                  // position the segment now running started from (loader only)
+#endif
     int32_t correction_holdoff;             // count down segments between corrections
     float corrected_steps;                  // accumulated correction steps for the cycle (for diagnostic display only)
 
     // accumulator phase correction
-    float prev_segment_time;                // segment time from previous segment run for this motor
+    uint32_t prev_dda_ticks;                // segment ticks from previous segment prepped for this motor
+} stPrepMotor_t;
+
+// One prepared segment, dwell or command. Written by the exec, then read and released by the loader
+
+typedef struct stPrepSegmentMotor {
+    dda_substeps_t substep_increment;       // total steps in axis times substep factor
+#ifdef __FIXED_POINT_EXEC
+    fxsteps_t position_steps;               // position the segment starts from, in steps
+#else
+    float position_steps;                   // position the segment starts from, in steps
+#endif
+    uint8_t direction;                      // travel direction corrected for polarity (CW==0. CCW==1)
+    int8_t step_sign;                       // set to +1 or -1 for encoders
+#if defined(__DDA_64BIT)
+    uint32_t accumulator_correction;        // DDA ticks the accumulator was last run at (it's rescaled exactly)
+#elif defined(__FIXED_POINT_EXEC)
+    uint32_t accumulator_correction;        // factor for adjusting accumulator between segments (Q.24)
+#else
     float accumulator_correction;           // factor for adjusting accumulator between segments
+#endif
     uint8_t accumulator_correction_flag;    // signals accumulator needs correction
-} stPrepMotor_t;
+} stPrepSegmentMotor_t;
 
-typedef struct stPrepSingleton {
-    magic_t magic_start;                   // magic number to test memory integrity
-    volatile prepBufferState buffer_state;  // prep buffer state - owned by exec or loader
-    struct mpBuffer *bf;                    // static pointer to relevant buffer
-//	uint8_t move_type;                      // move type (should be moveType from planner.h)
+typedef struct stPrepSegment {
     moveType move_type;                     // move type (requires planner.h)
-
+    struct mpBuffer *bf;                    // static pointer to relevant buffer (commands)
     uint16_t dda_period;                    // DDA or dwell clock period setting
+    uint8_t dda_shift;                      // DDA clock is FREQUENCY_DDA >> dda_shift
     uint32_t dda_ticks;                     // DDA or dwell ticks for the move
-    uint32_t dda_ticks_X_substeps;          // DDA ticks scaled by substep factor
+    dda_substeps_t dda_ticks_X_substeps;    // DDA ticks scaled by substep factor
+    stPrepSegmentMotor_t mot[MOTORS];       // per-motor values for this segment
+} stPrepSegment_t;
+
+typedef struct stPrepSingleton {
+    magic_t magic_start;                   // magic number to test memory integrity
+    volatile uint8_t head;                  // next slot the exec will fill - only the exec writes this
+    volatile uint8_t tail;                  // next slot the loader will run - only the loader writes this
+    uint32_t underruns;                     // segments that ended with nothing prepped behind them during a cycle
+    stPrepSegment_t seg[PREP_BUFFER_SLOTS]; // the prep ring
     stPrepMotor_t mot[MOTORS];              // prep time motor structs
-//	volatile bool exec_isbusy;              // are the stepper interrupts firing?
     magic_t magic_end;
 } stPrepSingleton_t;
 
 extern stConfig_t st_cfg;                   // config struct is exposed. The rest are private
-extern stPrepSingleton_t st_pre;            // only used by config_app diagnostics
+extern stPrepSingleton_t st_pre;            // only used by config_app diagnostics and planner resets
 
 /**** FUNCTION PROTOTYPES ****/
 
@@ -429,6 +557,9 @@ bool st_runtime_isbusy(void);
 //bool st_exec_isbusy(void);
 stat_t st_clc(nvObj_t *nv);
 
+void st_lock_motors(const uint8_t motors);
+void st_unlock_motors(void);
+
 void st_energize_motors(float timeout_seconds);
 void st_deenergize_motors(void);
 void st_set_motor_power(const uint8_t motor);
@@ -440,8 +571,15 @@ void st_prep_null(void);
 void st_prep_command(void *bf);		// use a void pointer since we don't know about mpBuf_t yet)
 void st_prep_dwell(float microseconds);
 void st_request_out_of_band_dwell(float microseconds);
-stat_t st_prep_line(float travel_steps[], float following_error[], float segment_time);
+#ifdef __FIXED_POINT_EXEC
+stat_t st_prep_line(fxsteps_t travel_steps[], fxsteps_t position_steps[], fxsteps_t following_error[], uint32_t dda_ticks);
+void st_sample_encoders(fxsteps_t commanded_steps[], fxsteps_t encoder_steps[]);
+#else
+stat_t st_prep_line(float travel_steps[], float position_steps[], float following_error[], float segment_time);
+void st_sample_encoders(float commanded_steps[], float encoder_steps[]);
+#endif
 
+stat_t st_set_ma(nvObj_t *nv);
 stat_t st_set_sa(nvObj_t *nv);
 stat_t st_set_tr(nvObj_t *nv);
 stat_t st_set_mi(nvObj_t *nv);
@@ -460,6 +598,7 @@ stat_t st_set_me(nvObj_t *nv);
 	void st_print_po(nvObj_t *nv);
 	void st_print_pm(nvObj_t *nv);
 	void st_print_pl(nvObj_t *nv);
+	void st_print_hi(nvObj_t *nv);
 	void st_print_mt(nvObj_t *nv);
 	void st_print_me(nvObj_t *nv);
 	void st_print_md(nvObj_t *nv);
@@ -473,6 +612,7 @@ stat_t st_set_me(nvObj_t *nv);
 	#define st_print_po tx_print_stub
 	#define st_print_pm tx_print_stub
 	#define st_print_pl tx_print_stub
+	#define st_print_hi tx_print_stub
 	#define st_print_mt tx_print_stub
 	#define st_print_me tx_print_stub
 	#define st_print_md tx_print_stub
@@ -0,0 +1,21 @@
+/* 
+ * test_015_arc_start.h 
+ *
+ *	Tests an arc that starts off its circle. The first G3 target isn't on its circle, so
+ *	the arc ends off the target and the G2 after it starts off its own circle. The G2
+ *	should be run into along a line and end at x10 y10 - a jump onto the circle leaves it
+ *	well off (about x19.5 y19.5).
+ *
+ * Notes:
+ *	  -	The character array should be derived from the filename (by convention)
+ *	  - Comments are not allowed in the char array, but gcode comments are OK e.g. (g0 test)
+ */
+const char test_arc_start[] PROGMEM = "\
+(MSG**** Arc Start Test [v1] ****)\n\
+g00g17g21g90\n\
+g92x0y0\n\
+g1f100x10y10\n\
+g3f100x0y0i5j5 (target off the circle)\n\
+g4p1\n\
+g2f200x10y10i5j5 (starts off the circle - should end at x10 y10)\n\
+m30";
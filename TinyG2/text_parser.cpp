@@ -199,7 +199,7 @@ void text_print_inline_pairs(nvObj_t *nv)
 			case TYPE_INT:      { fprintf_P(stderr,PSTR("%s:%1.0f"), nv->token, nv->value); break;}
 			case TYPE_STRING:   { fprintf_P(stderr,PSTR("%s:%s"), nv->token, *nv->stringp); break;}
 			case TYPE_BOOL:     { fprintf_P(stderr,PSTR("%s:%1.0f"), nv->token, nv->value); break;} // print as 0 or 1, do t & f later
-			case TYPE_DATA:     { fprintf_P(stderr,PSTR("%s:%lu"), nv->token, *v); break;}
+			case TYPE_DATA:     { fprintf_P(stderr,PSTR("%s:%lu"), nv->token, (unsigned long)*v); break;}
 //			case TYPE_ARRAY:    { <not implemented> ; break;}
 		}
 		if ((nv = nv->nx) == NULL) return;
@@ -218,7 +218,7 @@ void text_print_inline_values(nvObj_t *nv)
 								  fprintf_P(stderr,PSTR("%s"), global_string_buf) ; break;
 								}
 			case TYPE_INT:     { fprintf_P(stderr,PSTR("%1.0f"), nv->value); break;}
-			case TYPE_DATA:     { fprintf_P(stderr,PSTR("%lu"), *v); break;}
+			case TYPE_DATA:     { fprintf_P(stderr,PSTR("%lu"), (unsigned long)*v); break;}
 			case TYPE_STRING:   { fprintf_P(stderr,PSTR("%s"), *nv->stringp); break;}
 			case TYPE_EMPTY:    { fprintf_P(stderr,PSTR("\n")); return; }
 		}
@@ -56,6 +56,8 @@
 /****** DEVELOPMENT SETTINGS ******/
 
 #define __STEP_CORRECTION
+//#define __FIXED_POINT_EXEC        // integer exec and stepper prep for FPU-less parts (see stepper.h)
+//#define __DDA_64BIT               // 64 bit DDA accumulators with a fixed substep precision (see stepper.h)
 #define __DIAGNOSTICS               // enables various debug functions
 #define __DIAGNOSTIC_PARAMETERS     // enables system diagnostic parameters (_xx) in config_app
 #define __CANNED_STARTUP            // run any canned startup moves
@@ -439,8 +441,8 @@ char *get_status_message(stat_t status);
 #define STAT_T_WORD_IS_MISSING 178
 #define STAT_T_WORD_IS_INVALID 179
 
-#define	STAT_ERROR_180 180									// reserved for Gcode errors
-#define	STAT_ERROR_181 181
+#define	STAT_SPLINE_SPECIFICATION_ERROR 180				// G5 or G5.1 control point offsets missing or invalid
+#define	STAT_ERROR_181 181									// reserved for Gcode errors
 #define	STAT_ERROR_182 182
 #define	STAT_ERROR_183 183
 #define	STAT_ERROR_184 184
@@ -515,7 +517,7 @@ char *get_status_message(stat_t status);
 #define	STAT_HOMING_ERROR_NEGATIVE_LATCH_BACKOFF 245
 #define	STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED 246
 #define	STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING 247
-#define	STAT_ERROR_248 248
+#define	STAT_HOMING_ERROR_SWITCH_NOT_FOUND 248
 #define	STAT_ERROR_249 249
 
 #define	STAT_PROBE_CYCLE_FAILED 250						// probing cycle did not complete